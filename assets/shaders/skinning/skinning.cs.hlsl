@@ -0,0 +1,30 @@
+// SHADER DEF skinning
+// ENTRYPOINT main
+// TYPE cs
+// SHADER END DEF
+
+#include "shared/skinning_shared_types.h"
+#include "rhi/bindless.hlsli"
+
+DECLARE_PUSH_CONSTANTS(Skinning_Push_Constants, pc);
+
+[shader("compute")]
+[numthreads(64, 1, 1)]
+void main(uint id : SV_DispatchThreadID)
+{
+    if (id >= pc.vertex_count)
+        return;
+
+    float4 position = float4(rhi::uni::buf_load_arr<float3>(pc.src_position_buffer, pc.first_vertex + id), 1.0);
+    GPU_Vertex_Skin_Attributes skin = rhi::uni::buf_load_arr<GPU_Vertex_Skin_Attributes>(pc.skin_attribute_buffer, pc.first_skin_attribute + id);
+
+    float3 skinned_position = float3(0.0, 0.0, 0.0);
+    [unroll]
+    for (uint i = 0; i < 4; ++i)
+    {
+        float4x4 joint = rhi::uni::buf_load_arr<float4x4>(pc.joint_palette_buffer, pc.palette_offset + skin.joints[i]);
+        skinned_position += skin.weights[i] * mul(joint, position).xyz;
+    }
+
+    rhi::uni::buf_store_arr(pc.dst_position_buffer, pc.first_vertex + id, skinned_position);
+}
@@ -0,0 +1,20 @@
+// SHADER DEF upload_scatter
+// ENTRYPOINT main
+// TYPE cs
+// SHADER END DEF
+
+#include "shared/upload_shared_types.h"
+#include "rhi/bindless.hlsli"
+
+DECLARE_PUSH_CONSTANTS(Upload_Scatter_Push_Constants, pc);
+
+[shader("compute")]
+[numthreads(64, 1, 1)]
+void main(uint id : SV_DispatchThreadID)
+{
+    if (id >= pc.write_count)
+        return;
+
+    uint2 write = rhi::uni::buf_load_arr<uint2>(pc.src_buffer, pc.first_write + id);
+    rhi::uni::buf_store_arr(pc.dst_buffer, write.x, write.y);
+}
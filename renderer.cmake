@@ -30,3 +30,32 @@ function(renderer_symlink_assets)
     renderer_symlink_binary(/assets/pipelines /assets/pipelines/)
     renderer_symlink_binary(/assets/fonts /assets/fonts/)
 endfunction()
+
+# Adds a command line tool built from the renderer sources and a `<NAME>_run` target that runs it with ARGS.
+# The sources are added with target_sources next to the tool's main file.
+function(renderer_add_tool NAME)
+    cmake_parse_arguments(PARSE_ARGV 1 TOOL "" "" "LIBRARIES;INCLUDE_DIRECTORIES;ARGS;DEPENDS")
+    add_executable(${NAME})
+    target_link_libraries(
+        ${NAME} PUBLIC
+        ${TOOL_LIBRARIES}
+    )
+    target_include_directories(
+        ${NAME} PUBLIC
+        ${TOOL_INCLUDE_DIRECTORIES}
+    )
+    set_target_properties(
+        ${NAME} PROPERTIES
+        CXX_STANDARD 23
+    )
+    target_compile_definitions(
+        ${NAME} PUBLIC
+        SPDLOG_COMPILED_LIB
+    )
+    add_custom_target(
+        ${NAME}_run
+        COMMAND $<TARGET_FILE:${NAME}> ${TOOL_ARGS}
+        DEPENDS ${NAME} ${TOOL_DEPENDS}
+        USES_TERMINAL
+    )
+endfunction()
@@ -0,0 +1,219 @@
+#include "asset_baker/bake_report.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <ctime>
+#endif
+
+namespace asset_baker
+{
+constexpr static auto NS_PER_MS = 1e6;
+
+const char* to_string(Bake_Stage stage)
+{
+    switch (stage)
+    {
+    case Bake_Stage::Parse:
+        return "parse";
+    case Bake_Stage::Decode:
+        return "decode";
+    case Bake_Stage::Geometry:
+        return "geometry";
+    case Bake_Stage::Tangents:
+        return "tangents";
+    case Bake_Stage::Resize:
+        return "resize";
+    case Bake_Stage::Encode:
+        return "encode";
+    case Bake_Stage::Write:
+        return "write";
+    default:
+        return "unknown";
+    }
+}
+
+uint64_t get_thread_cpu_time_ns()
+{
+#ifdef _WIN32
+    FILETIME creation_time = {}, exit_time = {}, kernel_time = {}, user_time = {};
+    if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+    {
+        return 0;
+    }
+    const auto to_u64 = [](const FILETIME& time)
+    {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    // FILETIME is in 100ns intervals.
+    return (to_u64(kernel_time) + to_u64(user_time)) * 100ull;
+#else
+    timespec time = {};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ull + static_cast<uint64_t>(time.tv_nsec);
+#endif
+}
+
+void Bake_Stage_Timings::add(Bake_Stage stage, uint64_t wall_ns, uint64_t cpu_ns)
+{
+    m_wall_ns[static_cast<std::size_t>(stage)].fetch_add(wall_ns, std::memory_order_relaxed);
+    m_cpu_ns[static_cast<std::size_t>(stage)].fetch_add(cpu_ns, std::memory_order_relaxed);
+}
+
+uint64_t Bake_Stage_Timings::get_wall_ns(Bake_Stage stage) const
+{
+    return m_wall_ns[static_cast<std::size_t>(stage)].load(std::memory_order_relaxed);
+}
+
+uint64_t Bake_Stage_Timings::get_cpu_ns(Bake_Stage stage) const
+{
+    return m_cpu_ns[static_cast<std::size_t>(stage)].load(std::memory_order_relaxed);
+}
+
+Scoped_Stage_Timer::Scoped_Stage_Timer(Bake_Stage_Timings* timings, Bake_Stage stage)
+    : m_timings(timings)
+    , m_stage(stage)
+    , m_wall_start(timings ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+    , m_cpu_start(timings ? get_thread_cpu_time_ns() : 0)
+{}
+
+Scoped_Stage_Timer::~Scoped_Stage_Timer()
+{
+    if (!m_timings)
+    {
+        return;
+    }
+    const auto wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_wall_start).count();
+    const auto cpu_end = get_thread_cpu_time_ns();
+    m_timings->add(m_stage, static_cast<uint64_t>(wall_ns), cpu_end >= m_cpu_start ? cpu_end - m_cpu_start : 0);
+}
+
+Bake_Report_Asset& Bake_Report::add_asset(const std::string& name, const std::string& type)
+{
+    std::scoped_lock lock(m_mutex);
+    auto& asset = m_assets.emplace_back();
+    asset.name = name;
+    asset.type = type;
+    return asset;
+}
+
+std::size_t Bake_Report::get_total_input_bytes() const
+{
+    std::scoped_lock lock(m_mutex);
+    std::size_t result = 0;
+    for (const auto& asset : m_assets)
+    {
+        result += asset.input_bytes.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+std::size_t Bake_Report::get_total_output_bytes() const
+{
+    std::scoped_lock lock(m_mutex);
+    std::size_t result = 0;
+    for (const auto& asset : m_assets)
+    {
+        result += asset.output_bytes.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void Bake_Report::log_summary(double total_wall_seconds) const
+{
+    std::scoped_lock lock(m_mutex);
+    for (auto i = 0u; i < static_cast<uint32_t>(Bake_Stage::Count); ++i)
+    {
+        const auto stage = static_cast<Bake_Stage>(i);
+        uint64_t wall_ns = 0;
+        uint64_t cpu_ns = 0;
+        for (const auto& asset : m_assets)
+        {
+            wall_ns += asset.timings.get_wall_ns(stage);
+            cpu_ns += asset.timings.get_cpu_ns(stage);
+        }
+        spdlog::info("Stage '{}': {:.1f} ms task time, {:.1f} ms CPU time.",
+            to_string(stage), static_cast<double>(wall_ns) / NS_PER_MS, static_cast<double>(cpu_ns) / NS_PER_MS);
+    }
+    std::size_t input_bytes = 0;
+    for (const auto& asset : m_assets)
+    {
+        input_bytes += asset.input_bytes.load(std::memory_order_relaxed);
+    }
+    spdlog::info("Total: {:.3f} s, {:.2f} MiB/s input throughput.",
+        total_wall_seconds,
+        total_wall_seconds > 0. ? static_cast<double>(input_bytes) / (1024. * 1024.) / total_wall_seconds : 0.);
+}
+
+bool Bake_Report::write_json(const std::filesystem::path& path, double total_wall_seconds,
+    std::size_t peak_process_memory, std::size_t peak_texture_memory) const
+{
+    std::scoped_lock lock(m_mutex);
+
+    nlohmann::json assets = nlohmann::json::array();
+    std::size_t total_input_bytes = 0;
+    std::size_t total_output_bytes = 0;
+    for (const auto& asset : m_assets)
+    {
+        const auto input_bytes = asset.input_bytes.load(std::memory_order_relaxed);
+        const auto output_bytes = asset.output_bytes.load(std::memory_order_relaxed);
+        total_input_bytes += input_bytes;
+        total_output_bytes += output_bytes;
+
+        nlohmann::json stages = nlohmann::json::object();
+        for (auto i = 0u; i < static_cast<uint32_t>(Bake_Stage::Count); ++i)
+        {
+            const auto stage = static_cast<Bake_Stage>(i);
+            const auto wall_ns = asset.timings.get_wall_ns(stage);
+            const auto cpu_ns = asset.timings.get_cpu_ns(stage);
+            if (wall_ns == 0 && cpu_ns == 0)
+            {
+                continue;
+            }
+            stages[to_string(stage)] = {
+                { "wall_ms", static_cast<double>(wall_ns) / NS_PER_MS },
+                { "cpu_ms", static_cast<double>(cpu_ns) / NS_PER_MS }
+            };
+        }
+
+        assets.push_back({
+            { "name", asset.name },
+            { "type", asset.type },
+            { "wall_ms", static_cast<double>(asset.wall_ns.load(std::memory_order_relaxed)) / NS_PER_MS },
+            { "input_bytes", input_bytes },
+            { "output_bytes", output_bytes },
+            { "compression_ratio", output_bytes > 0 ? static_cast<double>(input_bytes) / static_cast<double>(output_bytes) : 0. },
+            { "stages", stages }
+        });
+    }
+
+    const nlohmann::json report = {
+        { "version", 1 },
+        { "total_wall_seconds", total_wall_seconds },
+        { "input_bytes", total_input_bytes },
+        { "output_bytes", total_output_bytes },
+        { "compression_ratio", total_output_bytes > 0 ? static_cast<double>(total_input_bytes) / static_cast<double>(total_output_bytes) : 0. },
+        { "input_throughput_mib_per_second", total_wall_seconds > 0. ? static_cast<double>(total_input_bytes) / (1024. * 1024.) / total_wall_seconds : 0. },
+        { "peak_process_memory_bytes", peak_process_memory },
+        { "peak_texture_memory_bytes", peak_texture_memory },
+        { "assets", assets }
+    };
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file)
+    {
+        spdlog::error("Failed to open report file '{}'.", path.string());
+        return false;
+    }
+    file << report.dump(4);
+    return true;
+}
+}
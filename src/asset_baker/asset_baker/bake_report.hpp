@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+namespace asset_baker
+{
+enum class Bake_Stage : uint32_t
+{
+    Parse,
+    Decode,
+    Geometry,
+    Tangents,
+    Resize,
+    Encode,
+    Write,
+    Count
+};
+
+const char* to_string(Bake_Stage stage);
+
+// CPU time consumed by the calling thread in nanoseconds, 0 if unavailable.
+uint64_t get_thread_cpu_time_ns();
+
+// Accumulated wall and CPU time per stage. Stages may be timed from several tasks at once,
+// the wall time of a stage is then the sum over all tasks.
+class Bake_Stage_Timings
+{
+public:
+    void add(Bake_Stage stage, uint64_t wall_ns, uint64_t cpu_ns);
+
+    [[nodiscard]] uint64_t get_wall_ns(Bake_Stage stage) const;
+    [[nodiscard]] uint64_t get_cpu_ns(Bake_Stage stage) const;
+
+private:
+    constexpr static auto STAGE_COUNT = static_cast<std::size_t>(Bake_Stage::Count);
+
+    std::array<std::atomic<uint64_t>, STAGE_COUNT> m_wall_ns = {};
+    std::array<std::atomic<uint64_t>, STAGE_COUNT> m_cpu_ns = {};
+};
+
+// Times its own scope. Passing nullptr disables the timer.
+class Scoped_Stage_Timer
+{
+public:
+    Scoped_Stage_Timer(Bake_Stage_Timings* timings, Bake_Stage stage);
+    ~Scoped_Stage_Timer();
+
+    Scoped_Stage_Timer(const Scoped_Stage_Timer&) = delete;
+    Scoped_Stage_Timer& operator=(const Scoped_Stage_Timer&) = delete;
+    Scoped_Stage_Timer(Scoped_Stage_Timer&&) = delete;
+    Scoped_Stage_Timer& operator=(Scoped_Stage_Timer&&) = delete;
+
+private:
+    Bake_Stage_Timings* m_timings;
+    Bake_Stage m_stage;
+    std::chrono::steady_clock::time_point m_wall_start;
+    uint64_t m_cpu_start;
+};
+
+struct Bake_Report_Asset
+{
+    std::string name;
+    std::string type;
+    std::atomic<std::size_t> input_bytes = 0;
+    std::atomic<std::size_t> output_bytes = 0;
+    std::atomic<uint64_t> wall_ns = 0; // Elapsed time from start to finish of the asset
+    Bake_Stage_Timings timings;
+};
+
+class Bake_Report
+{
+public:
+    Bake_Report() = default;
+
+    Bake_Report(const Bake_Report&) = delete;
+    Bake_Report& operator=(const Bake_Report&) = delete;
+    Bake_Report(Bake_Report&&) = delete;
+    Bake_Report& operator=(Bake_Report&&) = delete;
+
+    // Thread safe, the returned reference stays valid for the lifetime of the report.
+    Bake_Report_Asset& add_asset(const std::string& name, const std::string& type);
+
+    [[nodiscard]] std::size_t get_total_input_bytes() const;
+    [[nodiscard]] std::size_t get_total_output_bytes() const;
+
+    void log_summary(double total_wall_seconds) const;
+    [[nodiscard]] bool write_json(const std::filesystem::path& path, double total_wall_seconds,
+        std::size_t peak_process_memory, std::size_t peak_texture_memory) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::deque<Bake_Report_Asset> m_assets;
+};
+}
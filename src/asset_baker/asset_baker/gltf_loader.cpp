@@ -5,13 +5,21 @@
 #include <fastgltf/tools.hpp>
 #include <shared/serialized_asset_formats.hpp>
 #include <ankerl/unordered_dense.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <optional>
 #include <ranges>
 #include <stb_image.h>
 #include <stb_image_resize2.h>
 #include <vector>
 #include <xxhash.h>
 #include <glm/gtc/quaternion.hpp>
+#include <glm/ext/matrix_transform.hpp>
 #include <meshoptimizer.h>
+#include <TaskScheduler.h>
 
 #include "asset_baker/gltf_accessor.hpp"
 #include "asset_baker/bc7enc_rdo.hpp"
@@ -61,6 +69,23 @@ auto gltf_to_renderer(const glm::quat& gltf_rotation)
     return rotation;
 }
 
+template<>
+auto gltf_to_renderer(const glm::mat4& mat4)
+{
+    const auto permutation = gltf_to_renderer_permutation_matrix();
+    return permutation * mat4 * glm::transpose(permutation);
+}
+
+template<>
+auto gltf_to_renderer(const GLTF_Joint_Pose& pose)
+{
+    return GLTF_Joint_Pose {
+        .translation = gltf_to_renderer(pose.translation),
+        .rotation = gltf_to_renderer(pose.rotation),
+        .scale = { pose.scale.x, pose.scale.z, pose.scale.y }
+    };
+}
+
 template <typename T>
 std::string base_16_string(const T& input)
 {
@@ -91,7 +116,7 @@ glm::u8vec4 pack_4x8u(float a, float b, float c, float d)
     };
 }
 
-void process_submesh_geometry(GLTF_Submesh& submesh)
+void process_submesh_geometry(GLTF_Submesh& submesh, Bake_Stage_Timings* timings)
 {
     struct Vertex
     {
@@ -124,6 +149,7 @@ void process_submesh_geometry(GLTF_Submesh& submesh)
     std::vector<glm::vec4> generated_tangents;
     if (should_generate_tangents)
     {
+        Scoped_Stage_Timer timer(timings, Bake_Stage::Tangents);
         generated_tangents.resize(index_count);
         meshopt_generateTangents(
             &generated_tangents[0].x,
@@ -134,6 +160,8 @@ void process_submesh_geometry(GLTF_Submesh& submesh)
             meshopt_TangentCompatible);
     }
 
+    Scoped_Stage_Timer timer(timings, Bake_Stage::Geometry);
+
     // Remap data to unindexed for meshopt
     std::vector<Vertex> vertices(index_count);
     for (auto i = 0; i < index_count; ++i)
@@ -203,8 +231,345 @@ void process_submesh_geometry(GLTF_Submesh& submesh)
     }
 }
 
-std::expected<GLTF_Model, GLTF_Error> process_gltf_from_file(const std::filesystem::path& path)
+void process_primitive(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, GLTF_Submesh& mesh,
+    Bake_Stage_Timings* timings)
+{
+    mesh.material_index = primitive.materialIndex.value_or(NO_INDEX);
+
+    {
+        Scoped_Stage_Timer timer(timings, Bake_Stage::Geometry);
+        get_indices(asset, primitive, mesh.indices);
+        get_positions(asset, primitive, mesh.positions);
+        get_colors(asset, primitive, mesh.colors);
+        get_normals(asset, primitive, mesh.normals);
+        get_tangents(asset, primitive, mesh.tangents);
+        get_tex_coords(asset, primitive, mesh.tex_coords);
+        get_joints(asset, primitive, mesh.joints);
+        get_weights(asset, primitive, mesh.weights);
+    }
+
+    // Tangent generation is timed separately from the rest of the geometry processing.
+    process_submesh_geometry(mesh, timings);
+
+    Scoped_Stage_Timer timer(timings, Bake_Stage::Geometry);
+    for (auto& position : mesh.positions)
+    {
+        position = gltf_to_renderer(position);
+    }
+    for (auto& normal : mesh.normals)
+    {
+        normal = glm::normalize(gltf_to_renderer(normal));
+    }
+    for (auto& tangent : mesh.tangents)
+    {
+        tangent = glm::vec4(glm::normalize(gltf_to_renderer(glm::vec3(tangent))), tangent.w);
+    }
+}
+
+GLTF_Joint_Pose get_node_pose(const fastgltf::Node& node)
+{
+    const auto& trs = std::get<fastgltf::TRS>(node.transform);
+    return {
+        .translation = glm::vec3(trs.translation[0], trs.translation[1], trs.translation[2]),
+        .rotation = glm::quat(trs.rotation[3], trs.rotation[0], trs.rotation[1], trs.rotation[2]),
+        .scale = glm::vec3(trs.scale[0], trs.scale[1], trs.scale[2])
+    };
+}
+
+glm::mat4 pose_to_mat(const GLTF_Joint_Pose& pose)
+{
+    return glm::translate(glm::identity<glm::mat4>(), pose.translation)
+        * glm::mat4_cast(pose.rotation)
+        * glm::scale(glm::identity<glm::mat4>(), pose.scale);
+}
+
+struct GLTF_Animation_Sampler_Data
+{
+    fastgltf::AnimationInterpolation interpolation;
+    std::vector<float> times;
+    std::vector<glm::vec4> values; // Rotations are stored as x, y, z, w
+};
+
+GLTF_Animation_Sampler_Data load_animation_sampler(const fastgltf::Asset& asset, const fastgltf::AnimationSampler& sampler)
+{
+    GLTF_Animation_Sampler_Data result = {
+        .interpolation = sampler.interpolation
+    };
+
+    const auto& input_accessor = asset.accessors.at(sampler.inputAccessor);
+    result.times.resize(input_accessor.count);
+    fastgltf::copyFromAccessor<float>(asset, input_accessor, result.times.data());
+
+    const auto& output_accessor = asset.accessors.at(sampler.outputAccessor);
+    result.values.resize(output_accessor.count);
+    if (output_accessor.type == fastgltf::AccessorType::Vec4)
+    {
+        fastgltf::copyFromAccessor<fastgltf::math::fvec4>(asset, output_accessor, result.values.data());
+    }
+    else if (output_accessor.type == fastgltf::AccessorType::Vec3)
+    {
+        std::vector<glm::vec3> values(output_accessor.count);
+        fastgltf::copyFromAccessor<fastgltf::math::fvec3>(asset, output_accessor, values.data());
+        for (auto i = 0; i < values.size(); ++i)
+        {
+            result.values[i] = glm::vec4(values[i], 0.f);
+        }
+    }
+    else
+    {
+        result.times.clear();
+        result.values.clear();
+    }
+
+    // Cubic spline samplers store in-tangent, value and out-tangent per key.
+    const auto values_per_key = result.interpolation == fastgltf::AnimationInterpolation::CubicSpline ? 3ull : 1ull;
+    if (result.values.size() < result.times.size() * values_per_key)
+    {
+        result.times.clear();
+        result.values.clear();
+    }
+
+    return result;
+}
+
+glm::vec4 sample_animation_sampler(const GLTF_Animation_Sampler_Data& sampler, float time, bool is_rotation)
 {
+    const auto is_cubic = sampler.interpolation == fastgltf::AnimationInterpolation::CubicSpline;
+    const auto value_at = [&](std::size_t key)
+    {
+        return sampler.values[is_cubic ? key * 3 + 1 : key];
+    };
+
+    if (time <= sampler.times.front())
+        return value_at(0);
+    if (time >= sampler.times.back())
+        return value_at(sampler.times.size() - 1);
+
+    const auto next = static_cast<std::size_t>(
+        std::upper_bound(sampler.times.begin(), sampler.times.end(), time) - sampler.times.begin());
+    const auto prev = next - 1;
+    const auto dt = sampler.times[next] - sampler.times[prev];
+    const auto u = dt > 0.f ? (time - sampler.times[prev]) / dt : 0.f;
+
+    switch (sampler.interpolation)
+    {
+    case fastgltf::AnimationInterpolation::Step:
+        return value_at(prev);
+    case fastgltf::AnimationInterpolation::CubicSpline:
+    {
+        const auto u2 = u * u;
+        const auto u3 = u2 * u;
+        const auto p0 = value_at(prev);
+        const auto m0 = dt * sampler.values[prev * 3 + 2];
+        const auto p1 = value_at(next);
+        const auto m1 = dt * sampler.values[next * 3 + 0];
+        const auto value = (2.f * u3 - 3.f * u2 + 1.f) * p0
+            + (u3 - 2.f * u2 + u) * m0
+            + (-2.f * u3 + 3.f * u2) * p1
+            + (u3 - u2) * m1;
+        return is_rotation ? glm::normalize(value) : value;
+    }
+    case fastgltf::AnimationInterpolation::Linear:
+    default:
+    {
+        const auto a = value_at(prev);
+        const auto b = value_at(next);
+        if (is_rotation)
+        {
+            const auto q = glm::slerp(glm::quat(a.w, a.x, a.y, a.z), glm::quat(b.w, b.x, b.y, b.z), u);
+            return glm::vec4(q.x, q.y, q.z, q.w);
+        }
+        return glm::mix(a, b, u);
+    }
+    }
+}
+
+void process_skeletons(const std::filesystem::path& path, const fastgltf::Asset& asset,
+    const std::vector<std::size_t>& node_parents, GLTF_Model& result,
+    std::vector<ankerl::unordered_dense::map<std::size_t, std::size_t>>& joint_lookups)
+{
+    const auto node_global_transform = [&](std::size_t node_idx)
+    {
+        auto transform = glm::identity<glm::mat4>();
+        while (node_idx != NO_INDEX)
+        {
+            transform = pose_to_mat(get_node_pose(asset.nodes[node_idx])) * transform;
+            node_idx = node_parents[node_idx];
+        }
+        return transform;
+    };
+
+    result.skeletons.reserve(asset.skins.size());
+    joint_lookups.resize(asset.skins.size());
+    for (auto skin_idx = 0; skin_idx < asset.skins.size(); ++skin_idx)
+    {
+        const auto& skin = asset.skins[skin_idx];
+        auto& skeleton = result.skeletons.emplace_back();
+        skeleton.name = skin.name.empty()
+            ? path.stem().string() + ":skin" + std::to_string(skin_idx)
+            : path.stem().string() + ":" + std::string(skin.name);
+        spdlog::debug("Processing skeleton '{}' with {} joints.", skeleton.name, skin.joints.size());
+
+        std::vector<glm::mat4> inverse_bind_matrices(skin.joints.size(), glm::identity<glm::mat4>());
+        if (skin.inverseBindMatrices.has_value())
+        {
+            const auto& accessor = asset.accessors.at(skin.inverseBindMatrices.value());
+            if (accessor.count >= skin.joints.size())
+            {
+                fastgltf::copyFromAccessor<fastgltf::math::fmat4x4>(asset, accessor, inverse_bind_matrices.data());
+            }
+        }
+
+        auto& joint_lookup = joint_lookups[skin_idx];
+        for (auto joint_idx = 0; joint_idx < skin.joints.size(); ++joint_idx)
+        {
+            joint_lookup[skin.joints[joint_idx]] = joint_idx;
+        }
+
+        skeleton.root_transform = glm::identity<glm::mat4>();
+        auto has_root = false;
+        skeleton.joints.reserve(skin.joints.size());
+        for (auto joint_idx = 0; joint_idx < skin.joints.size(); ++joint_idx)
+        {
+            const auto node_idx = skin.joints[joint_idx];
+            const auto parent_node_idx = node_parents[node_idx];
+            const auto parent_joint = joint_lookup.find(parent_node_idx);
+            const auto parent_index = parent_joint != joint_lookup.end() ? parent_joint->second : NO_INDEX;
+
+            // Transforms of nodes above the joint hierarchy are collapsed into one root transform.
+            if (parent_index == NO_INDEX && !has_root)
+            {
+                skeleton.root_transform = gltf_to_renderer(node_global_transform(parent_node_idx));
+                has_root = true;
+            }
+
+            skeleton.joints.emplace_back( GLTF_Joint {
+                .parent_index = parent_index,
+                .inverse_bind_matrix = gltf_to_renderer(inverse_bind_matrices[joint_idx]),
+                .rest_pose = gltf_to_renderer(get_node_pose(asset.nodes[node_idx]))
+            });
+        }
+    }
+}
+
+void process_animations(const std::filesystem::path& path, const fastgltf::Asset& asset,
+    const std::vector<ankerl::unordered_dense::map<std::size_t, std::size_t>>& joint_lookups, GLTF_Model& result)
+{
+    for (auto animation_idx = 0; animation_idx < asset.animations.size(); ++animation_idx)
+    {
+        const auto& animation = asset.animations[animation_idx];
+        const auto animation_name = animation.name.empty()
+            ? path.stem().string() + ":animation" + std::to_string(animation_idx)
+            : path.stem().string() + ":" + std::string(animation.name);
+
+        std::vector<GLTF_Animation_Sampler_Data> samplers;
+        samplers.reserve(animation.samplers.size());
+        for (const auto& sampler : animation.samplers)
+        {
+            samplers.emplace_back(load_animation_sampler(asset, sampler));
+        }
+
+        for (auto skeleton_idx = 0; skeleton_idx < result.skeletons.size(); ++skeleton_idx)
+        {
+            const auto& skeleton = result.skeletons[skeleton_idx];
+            const auto& joint_lookup = joint_lookups[skeleton_idx];
+
+            struct Joint_Channel
+            {
+                std::size_t joint_index;
+                fastgltf::AnimationPath path;
+                const GLTF_Animation_Sampler_Data* sampler;
+            };
+            std::vector<Joint_Channel> channels;
+            float duration = 0.f;
+            for (const auto& channel : animation.channels)
+            {
+                const auto node_idx = channel.nodeIndex.value_or(NO_INDEX);
+                const auto joint = joint_lookup.find(node_idx);
+                if (joint == joint_lookup.end() || channel.path == fastgltf::AnimationPath::Weights)
+                    continue;
+                const auto& sampler = samplers.at(channel.samplerIndex);
+                if (sampler.times.empty())
+                    continue;
+                channels.emplace_back(joint->second, channel.path, &sampler);
+                duration = std::max(duration, sampler.times.back());
+            }
+            if (channels.empty())
+                continue;
+
+            const auto sample_count = static_cast<uint32_t>(std::ceil(duration * serialization::ANIMATION_SAMPLE_RATE)) + 1;
+            spdlog::debug("Resampling animation '{}' for skeleton '{}': {:.3f}s, {} samples.",
+                animation_name, skeleton.name, duration, sample_count);
+
+            // Sampling happens in glTF space, the result is converted afterwards.
+            auto& clip = result.animation_clips.emplace_back();
+            clip.name = animation_name;
+            clip.skeleton_index = skeleton_idx;
+            clip.duration = duration;
+            clip.sample_count = sample_count;
+            clip.samples.resize(skeleton.joints.size() * sample_count);
+            for (auto joint_idx = 0; joint_idx < skeleton.joints.size(); ++joint_idx)
+            {
+                const auto rest_pose = get_node_pose(asset.nodes[asset.skins[skeleton_idx].joints[joint_idx]]);
+                std::fill_n(clip.samples.begin() + joint_idx * sample_count, sample_count, rest_pose);
+            }
+
+            for (const auto& channel : channels)
+            {
+                for (uint32_t sample = 0; sample < sample_count; ++sample)
+                {
+                    const auto time = std::min(static_cast<float>(sample) / serialization::ANIMATION_SAMPLE_RATE, duration);
+                    auto& pose = clip.samples[channel.joint_index * sample_count + sample];
+                    switch (channel.path)
+                    {
+                    case fastgltf::AnimationPath::Translation:
+                        pose.translation = sample_animation_sampler(*channel.sampler, time, false);
+                        break;
+                    case fastgltf::AnimationPath::Rotation:
+                    {
+                        const auto value = sample_animation_sampler(*channel.sampler, time, true);
+                        pose.rotation = glm::normalize(glm::quat(value.w, value.x, value.y, value.z));
+                        break;
+                    }
+                    case fastgltf::AnimationPath::Scale:
+                        pose.scale = sample_animation_sampler(*channel.sampler, time, false);
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+
+            for (auto& pose : clip.samples)
+            {
+                pose = gltf_to_renderer(pose);
+            }
+        }
+    }
+}
+
+// The binary chunk of a .glb file stores its first buffer. The header holds the magic, the version and the
+// length of the file, followed by the length of the JSON chunk. Anything after the JSON chunk is the binary chunk.
+bool has_glb_binary_chunk(const std::filesystem::path& path)
+{
+    constexpr static uint32_t GLB_MAGIC = 0x46546c67; // "glTF"
+    constexpr static uint32_t GLB_HEADER_SIZE = 12;
+    constexpr static uint32_t GLB_CHUNK_HEADER_SIZE = 8;
+
+    std::array<uint32_t, 4> header = {};
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(header.data()), sizeof(header)))
+    {
+        return false;
+    }
+    return header[0] == GLB_MAGIC && header[2] > GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + header[3];
+}
+
+std::expected<GLTF_Model, GLTF_Error> process_gltf_from_file(const std::filesystem::path& path,
+    enki::TaskScheduler& task_scheduler, Bake_Stage_Timings* timings)
+{
+    std::optional<Scoped_Stage_Timer> parse_timer(std::in_place, timings, Bake_Stage::Parse);
+
     using fastgltf::Extensions;
     constexpr auto extensions = Extensions::KHR_materials_emissive_strength;
     auto parser = fastgltf::Parser(extensions);
@@ -234,7 +599,24 @@ std::expected<GLTF_Model, GLTF_Error> process_gltf_from_file(const std::filesyst
         }
     }
 
+    parse_timer.reset();
+
     GLTF_Model result = {};
+    // Buffers stored in the file are part of its size already. Images stored in buffers are counted by their
+    // textures instead.
+    result.source_size = std::filesystem::file_size(path);
+    const auto embedded_buffer_count = has_glb_binary_chunk(path) ? 1 : 0;
+    for (const auto& buffer : asset->buffers | std::views::drop(embedded_buffer_count))
+    {
+        result.source_size += buffer.byteLength;
+    }
+    for (const auto& image : asset->images)
+    {
+        if (const auto* buffer_view_ref = std::get_if<fastgltf::sources::BufferView>(&image.data))
+        {
+            result.source_size -= asset->bufferViews.at(buffer_view_ref->bufferViewIndex).byteLength;
+        }
+    }
 
     result.materials.reserve(asset->materials.size());
     for (const auto& material : asset->materials)
@@ -347,57 +729,57 @@ std::expected<GLTF_Model, GLTF_Error> process_gltf_from_file(const std::filesyst
         });
     }
 
-    result.submeshes.reserve(asset->meshes.size());
+    // Primitives are validated and assigned their submesh slot up front, so the geometry of every
+    // primitive can be processed independently while keeping the submesh order deterministic.
+    std::vector<const fastgltf::Primitive*> primitives;
     ankerl::unordered_dense::map<fastgltf::Mesh*, std::pair<std::size_t, std::size_t>> submesh_ranges;
     for (auto& gltf_mesh : asset->meshes)
     {
-        if (!gltf_mesh.name.empty())
-            spdlog::debug("Processing mesh '{}'.", gltf_mesh.name);
-        else
-            spdlog::debug("Processing unnamed mesh.");
-
-        auto submesh_range_start = result.submeshes.size();
+        auto submesh_range_start = primitives.size();
 
-        for (auto& primitive : gltf_mesh.primitives)
+        for (const auto& primitive : gltf_mesh.primitives)
         {
-            auto& mesh = result.submeshes.emplace_back();
-
             if (primitive.type != fastgltf::PrimitiveType::Triangles)
             {
                 spdlog::error("GLTF file '{}' has unsupported primitive type.", path.string());
                 return std::unexpected(GLTF_Error::Non_Supported_Primitive);
             }
+            primitives.push_back(&primitive);
+        }
 
-            mesh.material_index = primitive.materialIndex.value_or(NO_INDEX);
-
-            get_indices(asset.get(), primitive, mesh.indices);
-            get_positions(asset.get(), primitive, mesh.positions);
-            get_colors(asset.get(), primitive, mesh.colors);
-            get_normals(asset.get(), primitive, mesh.normals);
-            get_tangents(asset.get(), primitive, mesh.tangents);
-            get_tex_coords(asset.get(), primitive, mesh.tex_coords);
-            get_joints(asset.get(), primitive, mesh.joints);
-            get_weights(asset.get(), primitive, mesh.weights);
+        submesh_ranges[&gltf_mesh] = std::make_pair(submesh_range_start, primitives.size());
+    }
 
-            process_submesh_geometry(mesh);
+    spdlog::debug("Processing {} primitives of {} meshes.", primitives.size(), asset->meshes.size());
 
-            for (auto& position : mesh.positions)
-            {
-                position = gltf_to_renderer(position);
-            }
-            for (auto& normal : mesh.normals)
-            {
-                normal = glm::normalize(gltf_to_renderer(normal));
-            }
-            for (auto& tangent : mesh.tangents)
+    result.submeshes.resize(primitives.size());
+    enki::TaskSet geometry_task(
+        static_cast<uint32_t>(primitives.size()),
+        [&](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            for (auto i = range.start; i < range.end; ++i)
             {
-                tangent = glm::vec4(glm::normalize(gltf_to_renderer(glm::vec3(tangent))), tangent.w);
+                process_primitive(asset.get(), *primitives[i], result.submeshes[i], timings);
             }
-        }
+        });
+    if (!primitives.empty())
+    {
+        task_scheduler.AddTaskSetToPipe(&geometry_task);
+        task_scheduler.WaitforTask(&geometry_task);
+    }
 
-        submesh_ranges[&gltf_mesh] = std::make_pair(submesh_range_start, result.submeshes.size());
+    std::vector<std::size_t> node_parents(asset->nodes.size(), NO_INDEX);
+    for (auto node_idx = 0; node_idx < asset->nodes.size(); ++node_idx)
+    {
+        for (const auto child_idx : asset->nodes[node_idx].children)
+        {
+            node_parents[child_idx] = node_idx;
+        }
     }
 
+    std::vector<ankerl::unordered_dense::map<std::size_t, std::size_t>> joint_lookups;
+    process_skeletons(path, asset.get(), node_parents, result, joint_lookups);
+
     spdlog::debug("Iterating scenes.");
     for (const auto& scene : asset->scenes)
     {
@@ -428,14 +810,27 @@ std::expected<GLTF_Model, GLTF_Error> process_gltf_from_file(const std::filesyst
 
             glm::quat rotation = gltf_to_renderer(glm::quat(trs.rotation[3], trs.rotation[0], trs.rotation[1], trs.rotation[2]));
             glm::vec3 translation = gltf_to_renderer(glm::vec3(trs.translation[0], trs.translation[1], trs.translation[2]));
+            glm::vec3 scale = { trs.scale[0], trs.scale[2], trs.scale[1] };
+            auto instance_parent_index = parent_index;
+
+            // Skinned meshes are placed by their joints alone, the node transform is ignored.
+            const auto skin_idx = node.skinIndex.value_or(NO_INDEX);
+            if (mesh_idx != NO_INDEX && skin_idx != NO_INDEX && skin_idx < result.skeletons.size())
+            {
+                result.skeletons[skin_idx].instances.push_back(result.instances.size());
+                rotation = glm::identity<glm::quat>();
+                translation = glm::vec3(0.f);
+                scale = glm::vec3(1.f);
+                instance_parent_index = NO_INDEX;
+            }
 
             result.instances.emplace_back( GLTF_Mesh_Instance {
                 .submesh_range_start = submesh_range_start,
                 .submesh_range_end = submesh_range_end,
-                .parent_index = parent_index,
+                .parent_index = instance_parent_index,
                 .translation = { translation.x, translation.y, translation.z },
                 .rotation = { rotation.w, rotation.x, rotation.y, rotation.z },
-                .scale = { trs.scale[0], trs.scale[2], trs.scale[1] },
+                .scale = { scale.x, scale.y, scale.z },
             } );
 
             spdlog::trace("Iterating children of node {}", node_idx);
@@ -450,16 +845,51 @@ std::expected<GLTF_Model, GLTF_Error> process_gltf_from_file(const std::filesyst
         }
     }
 
+    process_animations(path, asset.get(), joint_lookups, result);
+
     return result;
 }
 
-std::vector<char> process_and_serialize_gltf_texture(const GLTF_Texture_Load_Request& request)
+std::size_t estimate_gltf_texture_working_set(const GLTF_Texture_Load_Request& request)
 {
     int32_t x = 0, y = 0, comp = 0;
-    auto* original_data = stbi_load_from_memory(
+    if (!stbi_info_from_memory(
         reinterpret_cast<const uint8_t*>(request.data.data()),
         static_cast<int>(request.data.size()),
-        &x, &y, &comp, STBI_rgb_alpha);
+        &x, &y, &comp))
+    {
+        return request.data.size();
+    }
+
+    const auto pixel_count = static_cast<uint64_t>(x) * y;
+    const uint64_t input_channels = request.squash_gb_to_rg ? 2u : 4u;
+
+    // Decoded RGBA image and the first mip level copied out of it are alive at the same time.
+    auto result = pixel_count * 4 + pixel_count * input_channels;
+    // Expanding two channel images back to RGBA for the encoder.
+    if (request.squash_gb_to_rg)
+    {
+        result += pixel_count * 4;
+    }
+    // The block compressed formats store 1 byte per pixel, plus the mip chain. The encoded mips
+    // are copied into the serialized result, so they are held twice.
+    const auto encoded_size = pixel_count * 4 / 3;
+    result += encoded_size * 2;
+    return request.data.size() + result;
+}
+
+std::vector<char> process_and_serialize_gltf_texture(const GLTF_Texture_Load_Request& request,
+    Bake_Stage_Timings* timings)
+{
+    int32_t x = 0, y = 0, comp = 0;
+    uint8_t* original_data = nullptr;
+    {
+        Scoped_Stage_Timer timer(timings, Bake_Stage::Decode);
+        original_data = stbi_load_from_memory(
+            reinterpret_cast<const uint8_t*>(request.data.data()),
+            static_cast<int>(request.data.size()),
+            &x, &y, &comp, STBI_rgb_alpha);
+    }
     if (!original_data)
     {
         spdlog::error("Failed to load texture.");
@@ -515,6 +945,7 @@ std::vector<char> process_and_serialize_gltf_texture(const GLTF_Texture_Load_Req
         }
         else
         {
+            Scoped_Stage_Timer timer(timings, Bake_Stage::Resize);
             pixels.resize(static_cast<uint64_t>(size_x) * size_y * input_channels);
             if (request.squash_gb_to_rg)
             {
@@ -545,9 +976,12 @@ std::vector<char> process_and_serialize_gltf_texture(const GLTF_Texture_Load_Req
             rgba_for_encode = rgba_expanded.data();
         }
 
-        auto compressed = bc7enc_rdo::encode_mip(rgba_for_encode, size_x, size_y, image_data.format);
-        image_data_size += static_cast<uint32_t>(compressed.size());
-        mip_image_data.push_back(std::move(compressed));
+        {
+            Scoped_Stage_Timer timer(timings, Bake_Stage::Encode);
+            auto compressed = bc7enc_rdo::encode_mip(rgba_for_encode, size_x, size_y, image_data.format);
+            image_data_size += static_cast<uint32_t>(compressed.size());
+            mip_image_data.push_back(std::move(compressed));
+        }
 
         prev_pixels = std::move(pixels);
     }
@@ -838,4 +1272,176 @@ std::vector<char> serialize_gltf_model(const std::string& name, GLTF_Model& gltf
 
     return result;
 }
+
+uint16_t quantize_unorm16(float value, float min, float extent)
+{
+    if (extent <= 0.f)
+        return 0;
+    return static_cast<uint16_t>(std::clamp((value - min) / extent, 0.f, 1.f) * 65535.f + .5f);
+}
+
+int16_t quantize_snorm16(float value)
+{
+    return static_cast<int16_t>(std::round(std::clamp(value, -1.f, 1.f) * 32767.f));
+}
+
+std::vector<char> serialize_gltf_animations(const std::string& name, const GLTF_Model& gltf_model)
+{
+    if (gltf_model.skeletons.empty())
+    {
+        return {};
+    }
+
+    spdlog::debug("Serializing animations of GLTF model '{}'.", name);
+
+    serialization::Animation_Header_00 serialized_animations = {
+        .header = {
+            .magic = serialization::Animation_Header::MAGIC,
+            .version = 1,
+        }
+    };
+    name.copy(serialized_animations.name, std::min(name.length(), serialization::NAME_MAX_SIZE));
+
+    std::vector<serialization::Skeleton_00> skeletons;
+    std::vector<serialization::Joint_00> joints;
+    std::vector<serialization::Skin_Binding_00> skin_bindings;
+    for (const auto& skeleton : gltf_model.skeletons)
+    {
+        auto& serialized_skeleton = skeletons.emplace_back( serialization::Skeleton_00 {
+            .joint_range_start = static_cast<uint32_t>(joints.size()),
+            .joint_range_end = static_cast<uint32_t>(joints.size() + skeleton.joints.size()),
+            .skin_binding_range_start = static_cast<uint32_t>(skin_bindings.size()),
+            .skin_binding_range_end = static_cast<uint32_t>(skin_bindings.size() + skeleton.instances.size()),
+        });
+        skeleton.name.copy(serialized_skeleton.name, std::min(skeleton.name.length(), serialization::NAME_MAX_SIZE));
+        memcpy(serialized_skeleton.root_transform, &skeleton.root_transform[0][0], sizeof(glm::mat4));
+
+        for (const auto& joint : skeleton.joints)
+        {
+            auto& serialized_joint = joints.emplace_back( serialization::Joint_00 {
+                .parent_index = joint.parent_index != NO_INDEX
+                    ? static_cast<uint32_t>(joint.parent_index)
+                    : serialization::JOINT_PARENT_INDEX_NO_PARENT,
+                .rest_translation = {
+                    joint.rest_pose.translation.x, joint.rest_pose.translation.y,
+                    joint.rest_pose.translation.z
+                },
+                .rest_rotation = {
+                    joint.rest_pose.rotation.w, joint.rest_pose.rotation.x,
+                    joint.rest_pose.rotation.y, joint.rest_pose.rotation.z
+                },
+                .rest_scale = {
+                    joint.rest_pose.scale.x, joint.rest_pose.scale.y,
+                    joint.rest_pose.scale.z
+                }
+            });
+            memcpy(serialized_joint.inverse_bind_matrix, &joint.inverse_bind_matrix[0][0], sizeof(glm::mat4));
+        }
+
+        for (const auto instance : skeleton.instances)
+        {
+            skin_bindings.emplace_back( serialization::Skin_Binding_00 {
+                .instance_index = static_cast<uint32_t>(instance)
+            });
+        }
+    }
+
+    std::vector<serialization::Animation_Clip_00> clips;
+    std::vector<serialization::Joint_Track_00> tracks;
+    std::vector<serialization::Joint_Key_00> keys;
+    for (const auto& clip : gltf_model.animation_clips)
+    {
+        const auto joint_count = gltf_model.skeletons[clip.skeleton_index].joints.size();
+        auto& serialized_clip = clips.emplace_back( serialization::Animation_Clip_00 {
+            .skeleton_index = static_cast<uint32_t>(clip.skeleton_index),
+            .sample_rate = serialization::ANIMATION_SAMPLE_RATE,
+            .duration = clip.duration,
+            .sample_count = clip.sample_count,
+            .track_range_start = static_cast<uint32_t>(tracks.size()),
+            .track_range_end = static_cast<uint32_t>(tracks.size() + joint_count),
+        });
+        clip.name.copy(serialized_clip.name, std::min(clip.name.length(), serialization::NAME_MAX_SIZE));
+
+        for (auto joint_idx = 0; joint_idx < joint_count; ++joint_idx)
+        {
+            const auto* samples = &clip.samples[joint_idx * clip.sample_count];
+
+            auto translation_min = glm::vec3(std::numeric_limits<float>::max());
+            auto translation_max = glm::vec3(std::numeric_limits<float>::lowest());
+            auto scale_min = glm::vec3(std::numeric_limits<float>::max());
+            auto scale_max = glm::vec3(std::numeric_limits<float>::lowest());
+            for (uint32_t i = 0; i < clip.sample_count; ++i)
+            {
+                translation_min = glm::min(translation_min, samples[i].translation);
+                translation_max = glm::max(translation_max, samples[i].translation);
+                scale_min = glm::min(scale_min, samples[i].scale);
+                scale_max = glm::max(scale_max, samples[i].scale);
+            }
+            const auto translation_extent = translation_max - translation_min;
+            const auto scale_extent = scale_max - scale_min;
+
+            tracks.emplace_back( serialization::Joint_Track_00 {
+                .translation_min = { translation_min.x, translation_min.y, translation_min.z },
+                .translation_extent = { translation_extent.x, translation_extent.y, translation_extent.z },
+                .scale_min = { scale_min.x, scale_min.y, scale_min.z },
+                .scale_extent = { scale_extent.x, scale_extent.y, scale_extent.z },
+                .key_range_start = static_cast<uint32_t>(keys.size()),
+            });
+
+            // Keep consecutive rotations in the same hemisphere, so they can be interpolated directly.
+            auto previous_rotation = samples[0].rotation;
+            for (uint32_t i = 0; i < clip.sample_count; ++i)
+            {
+                auto rotation = samples[i].rotation;
+                if (glm::dot(rotation, previous_rotation) < 0.f)
+                    rotation = -rotation;
+                previous_rotation = rotation;
+
+                keys.emplace_back( serialization::Joint_Key_00 {
+                    .translation = {
+                        quantize_unorm16(samples[i].translation.x, translation_min.x, translation_extent.x),
+                        quantize_unorm16(samples[i].translation.y, translation_min.y, translation_extent.y),
+                        quantize_unorm16(samples[i].translation.z, translation_min.z, translation_extent.z)
+                    },
+                    .rotation = {
+                        quantize_snorm16(rotation.x), quantize_snorm16(rotation.y),
+                        quantize_snorm16(rotation.z), quantize_snorm16(rotation.w)
+                    },
+                    .scale = {
+                        quantize_unorm16(samples[i].scale.x, scale_min.x, scale_extent.x),
+                        quantize_unorm16(samples[i].scale.y, scale_min.y, scale_extent.y),
+                        quantize_unorm16(samples[i].scale.z, scale_min.z, scale_extent.z)
+                    }
+                });
+            }
+        }
+    }
+
+    serialized_animations.skeleton_count = static_cast<uint32_t>(skeletons.size());
+    serialized_animations.joint_count = static_cast<uint32_t>(joints.size());
+    serialized_animations.skin_binding_count = static_cast<uint32_t>(skin_bindings.size());
+    serialized_animations.clip_count = static_cast<uint32_t>(clips.size());
+    serialized_animations.track_count = static_cast<uint32_t>(tracks.size());
+    serialized_animations.key_count = static_cast<uint32_t>(keys.size());
+
+    std::vector<char> result;
+    result.resize(serialized_animations.get_size());
+    spdlog::trace("Saving animations. Total size: {}", serialized_animations.get_size());
+
+    memcpy(result.data(), &serialized_animations, sizeof(serialization::Animation_Header_00));
+    memcpy(&result[serialized_animations.get_skeletons_offset()], skeletons.data(),
+        skeletons.size() * sizeof(serialization::Skeleton_00));
+    memcpy(&result[serialized_animations.get_joints_offset()], joints.data(),
+        joints.size() * sizeof(serialization::Joint_00));
+    memcpy(&result[serialized_animations.get_skin_bindings_offset()], skin_bindings.data(),
+        skin_bindings.size() * sizeof(serialization::Skin_Binding_00));
+    memcpy(&result[serialized_animations.get_clips_offset()], clips.data(),
+        clips.size() * sizeof(serialization::Animation_Clip_00));
+    memcpy(&result[serialized_animations.get_tracks_offset()], tracks.data(),
+        tracks.size() * sizeof(serialization::Joint_Track_00));
+    memcpy(&result[serialized_animations.get_keys_offset()], keys.data(),
+        keys.size() * sizeof(serialization::Joint_Key_00));
+
+    return result;
+}
 }
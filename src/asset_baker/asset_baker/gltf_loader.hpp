@@ -6,6 +6,14 @@
 #include <expected>
 #include <rhi/resource.hpp>
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "asset_baker/bake_report.hpp"
+
+namespace enki
+{
+class TaskScheduler;
+}
 
 namespace asset_baker
 {
@@ -78,15 +86,58 @@ struct GLTF_Texture_Load_Request
     rhi::Image_Format target_format;
 };
 
+struct GLTF_Joint_Pose
+{
+    glm::vec3 translation;
+    glm::quat rotation;
+    glm::vec3 scale;
+};
+
+struct GLTF_Joint
+{
+    std::size_t parent_index; // Index into GLTF_Skeleton::joints
+    glm::mat4 inverse_bind_matrix;
+    GLTF_Joint_Pose rest_pose;
+};
+
+struct GLTF_Skeleton
+{
+    std::string name;
+    glm::mat4 root_transform;
+    std::vector<GLTF_Joint> joints;
+    std::vector<std::size_t> instances; // Indices into GLTF_Model::instances
+};
+
+struct GLTF_Animation_Clip
+{
+    std::string name;
+    std::size_t skeleton_index;
+    float duration;
+    uint32_t sample_count;
+    std::vector<GLTF_Joint_Pose> samples; // `sample_count` samples per joint, joint major
+};
+
 struct GLTF_Model
 {
     std::vector<GLTF_Material> materials;
     std::vector<GLTF_Submesh> submeshes;
     std::vector<GLTF_Mesh_Instance> instances;
     std::vector<GLTF_Texture_Load_Request> texture_load_requests;
+    std::vector<GLTF_Skeleton> skeletons;
+    std::vector<GLTF_Animation_Clip> animation_clips;
+    std::size_t source_size; // Size of the glTF file and its external buffers, images are not included
 };
 
-std::expected<GLTF_Model, GLTF_Error> process_gltf_from_file(const std::filesystem::path& path);
-std::vector<char> process_and_serialize_gltf_texture(const GLTF_Texture_Load_Request& request);
+// Geometry of all primitives is processed in parallel on `task_scheduler`.
+// If `timings` is set, the time spent in each bake stage is accumulated into it.
+std::expected<GLTF_Model, GLTF_Error> process_gltf_from_file(const std::filesystem::path& path,
+    enki::TaskScheduler& task_scheduler, Bake_Stage_Timings* timings = nullptr);
+// Estimates the peak amount of memory `process_and_serialize_gltf_texture` allocates for `request`.
+// Only the image header is parsed, the image is not decoded.
+std::size_t estimate_gltf_texture_working_set(const GLTF_Texture_Load_Request& request);
+std::vector<char> process_and_serialize_gltf_texture(const GLTF_Texture_Load_Request& request,
+    Bake_Stage_Timings* timings = nullptr);
 std::vector<char> serialize_gltf_model(const std::string& name, GLTF_Model& gltf_model);
+// Returns an empty vector if the model has no skeletons.
+std::vector<char> serialize_gltf_animations(const std::string& name, const GLTF_Model& gltf_model);
 }
@@ -7,8 +7,11 @@
 #include <shared/serialized_asset_formats.hpp>
 #include <TaskScheduler.h>
 #include <ankerl/unordered_dense.h>
+#include <chrono>
 
+#include "asset_baker/bake_report.hpp"
 #include "asset_baker/hdr_image_loader.hpp"
+#include "asset_baker/memory_budget.hpp"
 
 namespace asset_baker
 {
@@ -20,18 +23,35 @@ struct Asset_Bake_Context
     ankerl::unordered_dense::set<std::string> processed_hashes;
     // bool use_cache;
     enki::TaskScheduler task_scheduler;
+    Memory_Budget texture_memory_budget;
     bool enable_gltf_load;
     bool enable_hdri_load;
+    std::filesystem::path report_path;
+    std::size_t processed_model_count = 0;
+    std::size_t processed_texture_count = 0;
+    Bake_Report report;
 };
 
+constexpr static auto MIB = 1ull << 20;
+
+uint64_t get_elapsed_ns(const std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
 void process_gltf(Asset_Bake_Context& context, const std::filesystem::path& input_file)
 {
     spdlog::info("Processing GLTF file '{}'", input_file.string());
     // TODO: check cache
-    auto gltf = process_gltf_from_file(input_file);
+    const auto start = std::chrono::steady_clock::now();
+    auto& report_asset = context.report.add_asset(input_file.string(), "model");
+    auto gltf = process_gltf_from_file(input_file, context.task_scheduler, &report_asset.timings);
     if (gltf.has_value())
     {
+        report_asset.input_bytes = gltf.value().source_size;
         {
+            Scoped_Stage_Timer timer(&report_asset.timings, Bake_Stage::Write);
             const auto serialized_model = serialize_gltf_model(input_file.filename().string(), gltf.value());
             const auto outfile_path = (context.output_directory / input_file.stem()).string() + serialization::MODEL_FILE_EXTENSION;
             if (!std::filesystem::exists(context.output_directory))
@@ -42,15 +62,41 @@ void process_gltf(Asset_Bake_Context& context, const std::filesystem::path& inpu
             std::ofstream outfile(outfile_path, std::ios::binary | std::ios::out);
             outfile.write(serialized_model.data(), static_cast<std::streamsize>(serialized_model.size()));
             outfile.close();
+            report_asset.output_bytes += serialized_model.size();
             spdlog::info("Successfully processed GLTF file '{}' and written it to '{}'",
                 input_file.string(),
                 outfile_path);
         }
+        {
+            Scoped_Stage_Timer timer(&report_asset.timings, Bake_Stage::Write);
+            const auto serialized_animations = serialize_gltf_animations(input_file.filename().string(), gltf.value());
+            if (!serialized_animations.empty())
+            {
+                const auto outfile_path = (context.output_directory / input_file.stem()).string() + serialization::ANIMATION_FILE_EXTENSION;
+                std::ofstream outfile(outfile_path, std::ios::binary | std::ios::out);
+                outfile.write(serialized_animations.data(), static_cast<std::streamsize>(serialized_animations.size()));
+                outfile.close();
+                report_asset.output_bytes += serialized_animations.size();
+                spdlog::info("Written {} skeletons and {} animation clips of GLTF file '{}' to '{}'",
+                    gltf.value().skeletons.size(),
+                    gltf.value().animation_clips.size(),
+                    input_file.string(),
+                    outfile_path);
+            }
+        }
+        report_asset.wall_ns = get_elapsed_ns(start);
 
         spdlog::debug("Processing textures.");
 
-        std::vector<std::unique_ptr<enki::TaskSet>> tasks;
+        struct Texture_Task
+        {
+            std::unique_ptr<enki::TaskSet> task;
+            std::size_t working_set_size;
+        };
+
+        std::vector<Texture_Task> tasks;
         tasks.reserve(gltf.value().texture_load_requests.size());
+        std::size_t oldest_pending_task = 0;
         for (auto& request : gltf.value().texture_load_requests)
         {
             if (context.processed_hashes.contains(request.hash_identifier))
@@ -58,18 +104,47 @@ void process_gltf(Asset_Bake_Context& context, const std::filesystem::path& inpu
                 continue;
             }
             context.processed_hashes.insert(request.hash_identifier);
+
+            // Only admit as many tasks as fit into the budget. While waiting, the calling thread
+            // participates in running the already admitted tasks.
+            const auto working_set_size = estimate_gltf_texture_working_set(request);
+            while (!context.texture_memory_budget.try_acquire(working_set_size))
+            {
+                while (oldest_pending_task < tasks.size() && tasks[oldest_pending_task].task->GetIsComplete())
+                {
+                    ++oldest_pending_task;
+                }
+                // Without a pending task of our own, the budget is freed by tasks completing elsewhere.
+                // Called with nullptr, WaitforTask runs one of any queued tasks if there is one.
+                const auto* pending_task = oldest_pending_task < tasks.size()
+                    ? tasks[oldest_pending_task].task.get()
+                    : nullptr;
+                context.task_scheduler.WaitforTask(pending_task);
+            }
+            spdlog::debug("Admitted texture '{}' with an estimated working set of {} MiB ({} MiB in flight).",
+                request.name,
+                working_set_size / MIB,
+                context.texture_memory_budget.get_in_flight() / MIB);
+
             auto& task = tasks.emplace_back(std::make_unique<enki::TaskSet>(
                 1,
-                [&](enki::TaskSetPartition range, uint32_t thread_idx)
+                [&, working_set_size](enki::TaskSetPartition range, uint32_t thread_idx)
                 {
+                    const Memory_Budget_Reservation reservation(context.texture_memory_budget, working_set_size);
                     spdlog::info("Processing texture '{}' with hash '{}'",
                         request.name,
                         request.hash_identifier);
 
-                    auto texture_data = process_and_serialize_gltf_texture(request);
+                    const auto texture_start = std::chrono::steady_clock::now();
+                    auto& texture_report_asset = context.report.add_asset(request.name, "texture");
+                    texture_report_asset.input_bytes = request.data.size();
+
+                    auto texture_data = process_and_serialize_gltf_texture(request, &texture_report_asset.timings);
+                    request.data = {};
 
                     if (texture_data.empty())
                     {
+                        texture_report_asset.wall_ns = get_elapsed_ns(texture_start);
                         spdlog::debug("Skipping texture write");
                         return;
                     }
@@ -78,17 +153,25 @@ void process_gltf(Asset_Bake_Context& context, const std::filesystem::path& inpu
                         + "/" + request.hash_identifier
                         + serialization::TEXTURE_FILE_EXTENSION;
 
-                    std::ofstream outfile(outfile_path, std::ios::binary | std::ios::out);
-                    outfile.write(texture_data.data(), static_cast<std::streamsize>(texture_data.size()));
-                    outfile.close();
+                    {
+                        Scoped_Stage_Timer timer(&texture_report_asset.timings, Bake_Stage::Write);
+                        std::ofstream outfile(outfile_path, std::ios::binary | std::ios::out);
+                        outfile.write(texture_data.data(), static_cast<std::streamsize>(texture_data.size()));
+                        outfile.close();
+                    }
+                    texture_report_asset.output_bytes = texture_data.size();
+                    texture_report_asset.wall_ns = get_elapsed_ns(texture_start);
+                    texture_data = {};
 
                     spdlog::info("Successfully processed texture of GLTF file '{}' and written it to '{}'",
                         input_file.string(),
                         outfile_path);
-                }));
-            context.task_scheduler.AddTaskSetToPipe(task.get());
+                }), working_set_size);
+            context.task_scheduler.AddTaskSetToPipe(task.task.get());
         }
         context.task_scheduler.WaitforAll();
+        context.processed_model_count += 1;
+        context.processed_texture_count += tasks.size();
     }
     else
     {
@@ -112,14 +195,27 @@ void process_gltf(Asset_Bake_Context& context, const std::filesystem::path& inpu
 void process_hdri(Asset_Bake_Context& context, const std::filesystem::path& input_file)
 {
     spdlog::info("Processing HDRI file '{}'", input_file.string());
-    const auto image_data = load_radiance_hdr(input_file);
+    const auto start = std::chrono::steady_clock::now();
+    auto& report_asset = context.report.add_asset(input_file.string(), "hdri");
+    report_asset.input_bytes = std::filesystem::file_size(input_file);
+
+    std::vector<char> image_data;
+    {
+        Scoped_Stage_Timer timer(&report_asset.timings, Bake_Stage::Decode);
+        image_data = load_radiance_hdr(input_file);
+    }
     const auto outfile_path = context.output_directory.string()
         + "/" + input_file.stem().string()
         + serialization::TEXTURE_FILE_EXTENSION;
 
-    std::ofstream outfile(outfile_path, std::ios::binary | std::ios::out);
-    outfile.write(image_data.data(), static_cast<std::streamsize>(image_data.size()));
-    outfile.close();
+    {
+        Scoped_Stage_Timer timer(&report_asset.timings, Bake_Stage::Write);
+        std::ofstream outfile(outfile_path, std::ios::binary | std::ios::out);
+        outfile.write(image_data.data(), static_cast<std::streamsize>(image_data.size()));
+        outfile.close();
+    }
+    report_asset.output_bytes = image_data.size();
+    report_asset.wall_ns = get_elapsed_ns(start);
 
     spdlog::info("Successfully processed HDRI file '{}' and written it to '{}'",
         input_file.string(),
@@ -138,8 +234,10 @@ void process_file(Asset_Bake_Context& context, const std::filesystem::path& inpu
     }
 }
 
-void process_files(Asset_Bake_Context& context)
+// Returns false if the input throughput is below the configured minimum.
+bool process_files(Asset_Bake_Context& context)
 {
+    const auto start = std::chrono::steady_clock::now();
     for (const auto& directory_entry : std::filesystem::recursive_directory_iterator(context.input_directory))
     {
         if (!std::filesystem::is_directory(directory_entry))
@@ -148,6 +246,31 @@ void process_files(Asset_Bake_Context& context)
             process_file(context, directory_path);
         }
     }
+
+    spdlog::info("Bake finished: {} models, {} textures.",
+        context.processed_model_count,
+        context.processed_texture_count);
+    spdlog::info("Peak estimated in-flight texture memory: {} MiB (budget: {}).",
+        context.texture_memory_budget.get_peak_in_flight() / MIB,
+        context.texture_memory_budget.get_budget() != 0
+            ? std::to_string(context.texture_memory_budget.get_budget() / MIB) + " MiB"
+            : std::string("unlimited"));
+    spdlog::info("Peak process memory: {} MiB.", get_process_peak_memory() / MIB);
+
+    const auto total_wall_seconds = static_cast<double>(get_elapsed_ns(start)) / 1e9;
+    context.report.log_summary(total_wall_seconds);
+    if (!context.report_path.empty())
+    {
+        if (context.report.write_json(
+            context.report_path,
+            total_wall_seconds,
+            get_process_peak_memory(),
+            context.texture_memory_budget.get_peak_in_flight()))
+        {
+            spdlog::info("Written bake report to '{}'.", context.report_path.string());
+        }
+    }
+    return true;
 }
 
 }
@@ -189,6 +312,22 @@ int32_t main(const int32_t argc, char** argv) try
         "If set, allows HDRI processing",
         false);
     cmd.add(enable_hdri_arg);
+    TCLAP::ValueArg<uint32_t> memory_budget_arg(
+        "",
+        "memory-budget",
+        "Set the maximum estimated memory in MiB used by texture tasks in flight. 0 is unlimited.",
+        false,
+        2048,
+        "int");
+    cmd.add(memory_budget_arg);
+    TCLAP::ValueArg<std::string> report_arg(
+        "",
+        "report",
+        "If set, writes per-asset and per-stage timings, sizes and peak memory as JSON to this file",
+        false,
+        "",
+        "string");
+    cmd.add(report_arg);
     TCLAP::ValueArg<int32_t> log_level_arg(
         "l",
         "log-level",
@@ -206,11 +345,16 @@ int32_t main(const int32_t argc, char** argv) try
         .output_directory = output_directory_arg.getValue(),
     //     .use_cache = use_cache_arg.getValue()
         .task_scheduler = enki::TaskScheduler(),
+        .texture_memory_budget = asset_baker::Memory_Budget(memory_budget_arg.getValue() * asset_baker::MIB),
         .enable_gltf_load = enable_gltf_arg.getValue(),
         .enable_hdri_load = enable_hdri_arg.getValue(),
+        .report_path = report_arg.getValue(),
     };
     asset_bake_context.task_scheduler.Initialize();
-    asset_baker::process_files(asset_bake_context);
+    if (!asset_baker::process_files(asset_bake_context))
+    {
+        return 1;
+    }
 
     return 0;
 }
@@ -0,0 +1,83 @@
+#include "asset_baker/memory_budget.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace asset_baker
+{
+Memory_Budget::Memory_Budget(std::size_t budget)
+    : m_budget(budget)
+{}
+
+bool Memory_Budget::try_acquire(std::size_t size)
+{
+    auto in_flight = m_in_flight.load(std::memory_order_acquire);
+    do
+    {
+        if (m_budget != 0 && in_flight != 0 && in_flight + size > m_budget)
+        {
+            return false;
+        }
+    } while (!m_in_flight.compare_exchange_weak(in_flight, in_flight + size, std::memory_order_acq_rel));
+
+    auto peak = m_peak_in_flight.load(std::memory_order_relaxed);
+    while (peak < in_flight + size
+        && !m_peak_in_flight.compare_exchange_weak(peak, in_flight + size, std::memory_order_relaxed))
+    {}
+    return true;
+}
+
+void Memory_Budget::release(std::size_t size)
+{
+    m_in_flight.fetch_sub(size, std::memory_order_acq_rel);
+}
+
+Memory_Budget_Reservation::Memory_Budget_Reservation(Memory_Budget& budget, std::size_t size) noexcept
+    : m_budget(budget)
+    , m_size(size)
+{}
+
+Memory_Budget_Reservation::~Memory_Budget_Reservation()
+{
+    m_budget.release(m_size);
+}
+
+std::size_t Memory_Budget::get_budget() const
+{
+    return m_budget;
+}
+
+std::size_t Memory_Budget::get_in_flight() const
+{
+    return m_in_flight.load(std::memory_order_acquire);
+}
+
+std::size_t Memory_Budget::get_peak_in_flight() const
+{
+    return m_peak_in_flight.load(std::memory_order_relaxed);
+}
+
+std::size_t get_process_peak_memory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        // ru_maxrss is reported in KiB.
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024ull;
+    }
+    return 0;
+#endif
+}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace asset_baker
+{
+// Admission control for tasks with a large transient working set.
+// A budget of 0 disables the limit, only the statistics are tracked then.
+class Memory_Budget
+{
+public:
+    explicit Memory_Budget(std::size_t budget);
+
+    Memory_Budget(const Memory_Budget&) = delete;
+    Memory_Budget& operator=(const Memory_Budget&) = delete;
+    Memory_Budget(Memory_Budget&&) = delete;
+    Memory_Budget& operator=(Memory_Budget&&) = delete;
+
+    // Succeeds if `size` fits into the remaining budget. A request larger than the whole budget
+    // is admitted if nothing else is in flight, so it can never stall the bake.
+    [[nodiscard]] bool try_acquire(std::size_t size);
+    void release(std::size_t size);
+
+    [[nodiscard]] std::size_t get_budget() const;
+    [[nodiscard]] std::size_t get_in_flight() const;
+    [[nodiscard]] std::size_t get_peak_in_flight() const;
+
+private:
+    const std::size_t m_budget;
+    std::atomic<std::size_t> m_in_flight = 0;
+    std::atomic<std::size_t> m_peak_in_flight = 0;
+};
+
+// Releases an acquired part of the budget when it goes out of scope, also if the task using it throws.
+class Memory_Budget_Reservation
+{
+public:
+    // Takes over `size` bytes that were already acquired from `budget`.
+    Memory_Budget_Reservation(Memory_Budget& budget, std::size_t size) noexcept;
+    ~Memory_Budget_Reservation();
+
+    Memory_Budget_Reservation(const Memory_Budget_Reservation&) = delete;
+    Memory_Budget_Reservation& operator=(const Memory_Budget_Reservation&) = delete;
+    Memory_Budget_Reservation(Memory_Budget_Reservation&&) = delete;
+    Memory_Budget_Reservation& operator=(Memory_Budget_Reservation&&) = delete;
+
+private:
+    Memory_Budget& m_budget;
+    const std::size_t m_size;
+};
+
+// Peak resident set size of the current process in bytes, 0 if unavailable.
+std::size_t get_process_peak_memory();
+}
@@ -0,0 +1,197 @@
+#include <tclap/CmdLine.h>
+#include <spdlog/spdlog.h>
+#include <shared/serialized_asset_formats.hpp>
+
+#include "renderer/filesystem/mapped_file.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ren::benchmark
+{
+constexpr static auto MIB = 1ull << 20;
+
+struct Benchmark_Configuration
+{
+    const char* name;
+    Mapped_File_Options options;
+    bool prefetch;
+};
+
+constexpr static Benchmark_Configuration CONFIGURATIONS[] = {
+    { "default", {}, false },
+    { "sequential", { .access_pattern = Mapped_File_Access_Pattern::Sequential }, false },
+    { "populate", { .populate = true }, false },
+    { "prefetch", {}, true },
+    { "huge_pages", { .access_pattern = Mapped_File_Access_Pattern::Sequential, .huge_pages = true }, false },
+};
+
+// Drops the clean pages of the file from the page cache, so the next map reads from disk.
+void evict_from_page_cache(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+    // Opening a file unbuffered discards its cached pages.
+    const auto handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_NO_BUFFERING, nullptr);
+    if (handle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(handle);
+    }
+#else
+    const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#endif
+}
+
+// Reads every cache line, like an upload of the whole file would.
+uint64_t consume(const Mapped_File& file)
+{
+    const auto* data = static_cast<const uint8_t*>(file.data);
+    uint64_t checksum = 0;
+    for (auto offset = 0ull; offset < file.size; offset += 64)
+    {
+        checksum += data[offset];
+    }
+    return checksum;
+}
+
+struct Load_Result
+{
+    double milliseconds;
+    uint64_t checksum;
+};
+
+Load_Result load_all(const std::vector<std::filesystem::path>& paths, const Benchmark_Configuration& configuration)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Mapped_File> files(paths.size());
+    for (auto i = 0ull; i < paths.size(); ++i)
+    {
+        files[i].map(paths[i].string().c_str(), configuration.options);
+        if (configuration.prefetch)
+        {
+            files[i].prefetch();
+        }
+    }
+    uint64_t checksum = 0;
+    for (auto& file : files)
+    {
+        if (file.data)
+        {
+            checksum += consume(file);
+        }
+        file.unmap();
+    }
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return { .milliseconds = elapsed, .checksum = checksum };
+}
+
+double median(std::vector<double> values)
+{
+    std::ranges::sort(values);
+    return values[values.size() / 2];
+}
+
+int32_t run(const std::filesystem::path& input_directory, const uint32_t iterations)
+{
+    std::vector<std::filesystem::path> paths;
+    uint64_t total_size = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(input_directory))
+    {
+        const auto extension = entry.path().extension();
+        if (entry.is_regular_file()
+            && (extension == serialization::MODEL_FILE_EXTENSION || extension == serialization::TEXTURE_FILE_EXTENSION))
+        {
+            paths.push_back(entry.path());
+            total_size += entry.file_size();
+        }
+    }
+    if (paths.empty())
+    {
+        spdlog::error("No baked models or textures found in '{}'.", input_directory.string());
+        return 1;
+    }
+    spdlog::info("Loading {} files, {:.1f} MiB in total, {} iterations per configuration.",
+        paths.size(), double(total_size) / MIB, iterations);
+
+    const auto throughput = [&](const double milliseconds)
+    {
+        return double(total_size) / MIB / (milliseconds / 1000.);
+    };
+    for (const auto& configuration : CONFIGURATIONS)
+    {
+        std::vector<double> cold_times;
+        std::vector<double> warm_times;
+        uint64_t checksum = 0;
+        for (auto i = 0u; i < iterations; ++i)
+        {
+            for (const auto& path : paths)
+            {
+                evict_from_page_cache(path);
+            }
+            const auto cold = load_all(paths, configuration);
+            const auto warm = load_all(paths, configuration);
+            cold_times.push_back(cold.milliseconds);
+            warm_times.push_back(warm.milliseconds);
+            checksum += cold.checksum + warm.checksum;
+        }
+        const auto cold_time = median(cold_times);
+        const auto warm_time = median(warm_times);
+        spdlog::info("{:<12} cold {:>9.2f} ms ({:>8.1f} MiB/s), warm {:>9.2f} ms ({:>8.1f} MiB/s) [{:x}]",
+            configuration.name, cold_time, throughput(cold_time), warm_time, throughput(warm_time), checksum);
+    }
+    return 0;
+}
+}
+
+int32_t main(const int32_t argc, char** argv) try
+{
+    TCLAP::CmdLine cmd("Mapped file benchmark", ' ', "0.1", true);
+    TCLAP::ValueArg<std::string> input_directory_arg(
+        "i",
+        "input-dir",
+        "Set input directory - baked models and textures are loaded recursively from this directory",
+        true,
+        "",
+        "string");
+    cmd.add(input_directory_arg);
+    TCLAP::ValueArg<uint32_t> iterations_arg(
+        "n",
+        "iterations",
+        "Set the number of cold and warm loads per configuration, the median is reported",
+        false,
+        5,
+        "int");
+    cmd.add(iterations_arg);
+    cmd.parse(argc, argv);
+
+    return ren::benchmark::run(input_directory_arg.getValue(), std::max(iterations_arg.getValue(), 1u));
+}
+catch (TCLAP::ArgException& e)
+{
+    spdlog::critical("Error: '{}' at '{}'", e.error(), e.argId());
+    return -2;
+}
+catch (...)
+{
+    spdlog::critical("An unknown error occurred.");
+    return -1;
+}
@@ -0,0 +1,103 @@
+#include <spdlog/spdlog.h>
+
+#include "renderer/asset/pipeline_cache.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+
+// Runs the pipeline cache through several sessions with the recording device, no GPU is required.
+namespace ren::check
+{
+constexpr static Pipeline_Cache_Device_Identity IDENTITY = {
+    .graphics_api = rhi::Graphics_API::D3D12,
+    .vendor_id = 0x10de,
+    .device_id = 0x2684,
+    .driver_version = 0x0020000000000001
+};
+
+struct Session_Result
+{
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    uint32_t device_hits;
+    uint32_t device_misses;
+};
+
+// A session loads the cache, requests the pipelines and saves the cache again, like a run of the renderer.
+Session_Result run_session(const std::shared_ptr<Logger>& logger, const std::filesystem::path& directory,
+    const Pipeline_Cache_Device_Identity& identity, std::initializer_list<uint64_t> keys)
+{
+    auto device = std::make_unique<Recording_Pipeline_Cache_Device>(identity);
+    auto& recording_device = *device;
+    Pipeline_Cache cache(logger, std::move(device), directory);
+    cache.load();
+    for (const auto key : keys)
+    {
+        [[maybe_unused]] const auto result = cache.create_pipeline(key, rhi::Compute_Pipeline_Create_Info{});
+    }
+    cache.save();
+    return {
+        .cache_hits = cache.get_hit_count(),
+        .cache_misses = cache.get_miss_count(),
+        .device_hits = recording_device.get_hit_count(),
+        .device_misses = recording_device.get_miss_count()
+    };
+}
+
+bool expect(const char* session, const Session_Result& result, uint32_t hits, uint32_t misses)
+{
+    const auto passed = result.cache_hits == hits && result.cache_misses == misses
+        && result.device_hits == hits && result.device_misses == misses;
+    if (passed)
+    {
+        spdlog::info("{:<16} passed: {} hits, {} misses.", session, hits, misses);
+    }
+    else
+    {
+        spdlog::error("{:<16} failed: expected {} hits and {} misses, the cache reported {} and {}, the device {} and {}.",
+            session, hits, misses, result.cache_hits, result.cache_misses, result.device_hits, result.device_misses);
+    }
+    return passed;
+}
+
+int32_t run()
+{
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("pipeline_cache_check_" + std::to_string(std::random_device()()));
+    auto logger = std::make_shared<Logger>(spdlog::level::warn);
+
+    const auto key_a = Pipeline_Cache::compute_key(std::to_array<uint64_t>({ 1, 2 }));
+    const auto key_b = Pipeline_Cache::compute_key(std::to_array<uint64_t>({ 3 }), 4);
+    const auto key_c = Pipeline_Cache::compute_key(std::to_array<uint64_t>({ 5 }));
+
+    auto other_driver = IDENTITY;
+    other_driver.driver_version += 1;
+
+    auto passed = true;
+    passed &= expect("cold", run_session(logger, directory, IDENTITY, { key_a, key_b }), 0, 2);
+    passed &= expect("warm", run_session(logger, directory, IDENTITY, { key_a, key_c, key_a }), 2, 1);
+    // `key_b` was not requested by the last session, so it was pruned from the cache.
+    passed &= expect("pruned", run_session(logger, directory, IDENTITY, { key_b, key_c }), 1, 1);
+    passed &= expect("other driver", run_session(logger, directory, other_driver, { key_b, key_c }), 0, 2);
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return passed ? 0 : 1;
+}
+}
+
+int32_t main() try
+{
+    return ren::check::run();
+}
+catch (...)
+{
+    spdlog::critical("An unknown error occurred.");
+    return -1;
+}
@@ -0,0 +1,98 @@
+#include <spdlog/spdlog.h>
+
+#include "renderer/asset/pipeline_description.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+
+// Edits a pipeline JSON between loads through the description cache and checks which loads see the edit.
+namespace ren::check
+{
+struct Load_Result
+{
+    std::string vs_library;
+    uint64_t source_hash;
+};
+
+// Every write moves the timestamp forward, file systems with a coarse timestamp resolution would miss the change otherwise.
+void write_json(const std::filesystem::path& path, const std::string& vs_library, uint32_t revision)
+{
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << R"({ "name": "check", "vs": { "name": ")" << vs_library << R"(" } })";
+    }
+    const auto base_time = std::filesystem::file_time_type(std::chrono::seconds(1'000'000));
+    std::filesystem::last_write_time(path, base_time + std::chrono::seconds(revision));
+}
+
+Load_Result load(const std::shared_ptr<Logger>& logger, const std::filesystem::path& cache_directory,
+    const std::filesystem::path& json_path)
+{
+    // A new cache per load, like a new run of the renderer.
+    const Pipeline_Description_Cache cache(logger, cache_directory);
+    const auto description = cache.load_graphics(json_path);
+    if (!description.has_value())
+    {
+        return {};
+    }
+    return { .vs_library = description->vs.library, .source_hash = description->source_hash };
+}
+
+bool expect(const char* step, const bool passed)
+{
+    if (passed)
+    {
+        spdlog::info("{:<16} passed.", step);
+    }
+    else
+    {
+        spdlog::error("{:<16} failed.", step);
+    }
+    return passed;
+}
+
+int32_t run()
+{
+    const auto directory = std::filesystem::temp_directory_path()
+        / ("pipeline_description_check_" + std::to_string(std::random_device()()));
+    const auto cache_directory = directory / "cache";
+    const auto json_path = directory / "check.json";
+    std::filesystem::create_directories(directory);
+    auto logger = std::make_shared<Logger>(spdlog::level::warn);
+
+    auto passed = true;
+    write_json(json_path, "lib_a", 0);
+    const auto cold = load(logger, cache_directory, json_path);
+    passed &= expect("cold", cold.vs_library == "lib_a");
+    passed &= expect("unchanged", load(logger, cache_directory, json_path).vs_library == "lib_a");
+
+    // Same size, so only the hash tells the edit apart from a checkout that only touched the file.
+    write_json(json_path, "lib_b", 1);
+    const auto edited = load(logger, cache_directory, json_path);
+    passed &= expect("edited", edited.vs_library == "lib_b" && edited.source_hash != cold.source_hash);
+
+    write_json(json_path, "lib_b", 2);
+    const auto touched = load(logger, cache_directory, json_path);
+    passed &= expect("touched", touched.vs_library == "lib_b" && touched.source_hash == edited.source_hash);
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return passed ? 0 : 1;
+}
+}
+
+int32_t main() try
+{
+    return ren::check::run();
+}
+catch (...)
+{
+    spdlog::critical("An unknown error occurred.");
+    return -1;
+}
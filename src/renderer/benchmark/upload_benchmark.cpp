@@ -0,0 +1,188 @@
+#include <tclap/CmdLine.h>
+#include <spdlog/spdlog.h>
+#include <shared/serialized_asset_formats.hpp>
+#include <TaskScheduler.h>
+
+#include "renderer/filesystem/mapped_file.hpp"
+#include "renderer/upload_copy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace ren::benchmark
+{
+constexpr static auto GIB = 1ull << 30;
+
+enum class Upload_Method
+{
+    Memcpy,
+    Stream,
+    Parallel_Stream,
+    Touch_Pages
+};
+
+struct Benchmark_Configuration
+{
+    const char* name;
+    Upload_Method method;
+    bool is_lower_bound = false;
+};
+
+constexpr static Benchmark_Configuration CONFIGURATIONS[] = {
+    { "memcpy", Upload_Method::Memcpy },
+    { "stream", Upload_Method::Stream },
+    { "parallel", Upload_Method::Parallel_Stream },
+    // Only reads one byte per cache line of the mapped files and copies nothing. A lower bound for any upload,
+    // not a measurement of a GPU reading straight from the file.
+    { "touch_pages", Upload_Method::Touch_Pages, true },
+};
+
+uint64_t consume(const Mapped_File& file)
+{
+    const auto* data = static_cast<const uint8_t*>(file.data);
+    uint64_t checksum = 0;
+    for (auto offset = 0ull; offset < file.size; offset += 64)
+    {
+        checksum += data[offset];
+    }
+    return checksum;
+}
+
+// Copies every file into the staging memory back to back, like a frame of uploads would.
+double upload_all(const std::vector<Mapped_File>& files, std::vector<std::byte>& staging,
+    const Upload_Method method, enki::TaskScheduler& task_scheduler, uint64_t& checksum)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto offset = 0ull;
+    for (const auto& file : files)
+    {
+        auto* dst = staging.data() + offset;
+        switch (method)
+        {
+        case Upload_Method::Memcpy:
+            memcpy(dst, file.data, file.size);
+            break;
+        case Upload_Method::Stream:
+            copy_to_upload_memory(dst, file.data, file.size);
+            break;
+        case Upload_Method::Parallel_Stream:
+            copy_to_upload_memory(dst, file.data, file.size, task_scheduler);
+            break;
+        case Upload_Method::Touch_Pages:
+            checksum += consume(file);
+            break;
+        }
+        offset += file.size;
+    }
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (method != Upload_Method::Touch_Pages)
+    {
+        checksum += uint64_t(staging[offset / 2]);
+    }
+    return elapsed;
+}
+
+double median(std::vector<double> values)
+{
+    std::ranges::sort(values);
+    return values[values.size() / 2];
+}
+
+int32_t run(const std::filesystem::path& input_directory, const uint32_t iterations)
+{
+    std::vector<Mapped_File> files;
+    uint64_t total_size = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(input_directory))
+    {
+        const auto extension = entry.path().extension();
+        if (entry.is_regular_file()
+            && (extension == serialization::MODEL_FILE_EXTENSION || extension == serialization::TEXTURE_FILE_EXTENSION))
+        {
+            auto& file = files.emplace_back();
+            file.map(entry.path().string().c_str(), { .access_pattern = Mapped_File_Access_Pattern::Sequential });
+            if (!file.data)
+            {
+                files.pop_back();
+                continue;
+            }
+            // The files are warm, only the copy into upload memory is measured.
+            file.populate();
+            total_size += file.size;
+        }
+    }
+    if (files.empty())
+    {
+        spdlog::error("No baked models or textures found in '{}'.", input_directory.string());
+        return 1;
+    }
+
+    enki::TaskScheduler task_scheduler;
+    task_scheduler.Initialize();
+
+    // Touched once up front so page faults on the staging memory aren't measured.
+    std::vector<std::byte> staging(total_size);
+    spdlog::info("Uploading {} files, {:.2f} GiB in total, {} iterations per configuration, {} threads.",
+        files.size(), double(total_size) / GIB, iterations, task_scheduler.GetNumTaskThreads());
+    spdlog::info("Staging is cached heap memory, not write-combined upload memory, the copies may behave differently there.");
+
+    for (const auto& configuration : CONFIGURATIONS)
+    {
+        std::vector<double> times;
+        uint64_t checksum = 0;
+        for (auto i = 0u; i < iterations; ++i)
+        {
+            times.push_back(upload_all(files, staging, configuration.method, task_scheduler, checksum));
+        }
+        const auto time = median(times);
+        spdlog::info("{:<11} {:>9.2f} ms ({:>6.2f} GiB/s) [{:x}]{}",
+            configuration.name, time, double(total_size) / GIB / (time / 1000.), checksum,
+            configuration.is_lower_bound ? " lower bound, nothing is copied" : "");
+    }
+
+    for (auto& file : files)
+    {
+        file.unmap();
+    }
+    task_scheduler.WaitforAllAndShutdown();
+    return 0;
+}
+}
+
+int32_t main(const int32_t argc, char** argv) try
+{
+    TCLAP::CmdLine cmd("Upload benchmark", ' ', "0.1", true);
+    TCLAP::ValueArg<std::string> input_directory_arg(
+        "i",
+        "input-dir",
+        "Set input directory - baked models and textures are loaded recursively from this directory",
+        true,
+        "",
+        "string");
+    cmd.add(input_directory_arg);
+    TCLAP::ValueArg<uint32_t> iterations_arg(
+        "n",
+        "iterations",
+        "Set the number of uploads per configuration, the median is reported",
+        false,
+        5,
+        "int");
+    cmd.add(iterations_arg);
+    cmd.parse(argc, argv);
+
+    return ren::benchmark::run(input_directory_arg.getValue(), std::max(iterations_arg.getValue(), 1u));
+}
+catch (TCLAP::ArgException& e)
+{
+    spdlog::critical("Error: '{}' at '{}'", e.error(), e.argId());
+    return -2;
+}
+catch (...)
+{
+    spdlog::critical("An unknown error occurred.");
+    return -1;
+}
@@ -0,0 +1,151 @@
+#include <spdlog/spdlog.h>
+
+#include "renderer/write_coalescing.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+// Checks how small buffer writes are merged into runs and split between copies and the scatter kernel.
+namespace ren::check
+{
+// Destinations are only compared, never dereferenced. Their order is the order of the array.
+std::array<std::byte, 2> g_buffer_storage = {};
+rhi::Buffer* const BUFFER_A = reinterpret_cast<rhi::Buffer*>(&g_buffer_storage[0]);
+rhi::Buffer* const BUFFER_B = reinterpret_cast<rhi::Buffer*>(&g_buffer_storage[1]);
+
+struct Write_List
+{
+    std::vector<Buffer_Write> writes;
+    std::vector<std::byte> data;
+
+    void add(rhi::Buffer* dst, std::size_t dst_offset, std::size_t size, uint8_t value)
+    {
+        writes.push_back({ .dst = dst, .dst_offset = dst_offset, .size = size, .data_offset = data.size() });
+        data.insert(data.end(), size, std::byte(value));
+    }
+};
+
+bool expect(const char* name, const bool passed)
+{
+    if (passed)
+    {
+        spdlog::info("{:<24} passed.", name);
+    }
+    else
+    {
+        spdlog::error("{:<24} failed.", name);
+    }
+    return passed;
+}
+
+bool is_run(const Buffer_Write& run, rhi::Buffer* dst, std::size_t dst_offset, std::size_t size)
+{
+    return run.dst == dst && run.dst_offset == dst_offset && run.size == size;
+}
+
+bool has_bytes(const std::vector<std::byte>& run_data, const Buffer_Write& run, std::size_t dst_offset,
+    std::size_t size, uint8_t value)
+{
+    for (auto i = 0ull; i < size; ++i)
+    {
+        if (run_data[run.data_offset + dst_offset - run.dst_offset + i] != std::byte(value))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool check_sorting_and_merging()
+{
+    Write_List list;
+    list.add(BUFFER_B, 16, 4, 1);
+    list.add(BUFFER_A, 100, 4, 2);
+    list.add(BUFFER_A, 8, 8, 3);
+    list.add(BUFFER_A, 0, 8, 4); // Adjacent to the previous write
+    list.add(BUFFER_B, 20, 4, 5);
+
+    std::vector<Buffer_Write> runs;
+    std::vector<std::byte> run_data;
+    coalesce_buffer_writes(list.writes, list.data, runs, run_data);
+    return runs.size() == 3
+        && is_run(runs[0], BUFFER_A, 0, 16)
+        && is_run(runs[1], BUFFER_A, 100, 4)
+        && is_run(runs[2], BUFFER_B, 16, 8)
+        && run_data.size() == 28
+        && has_bytes(run_data, runs[0], 0, 8, 4)
+        && has_bytes(run_data, runs[0], 8, 8, 3)
+        && has_bytes(run_data, runs[1], 100, 4, 2)
+        && has_bytes(run_data, runs[2], 16, 4, 1)
+        && has_bytes(run_data, runs[2], 20, 4, 5);
+}
+
+bool check_last_write_wins()
+{
+    Write_List list;
+    list.add(BUFFER_A, 4, 8, 1);
+    list.add(BUFFER_A, 0, 8, 2); // Sorted before the first write, but enqueued after it
+    list.add(BUFFER_A, 2, 2, 3);
+    list.add(BUFFER_A, 8, 2, 4);
+
+    std::vector<Buffer_Write> runs;
+    std::vector<std::byte> run_data;
+    coalesce_buffer_writes(list.writes, list.data, runs, run_data);
+    return runs.size() == 1
+        && is_run(runs[0], BUFFER_A, 0, 12)
+        && has_bytes(run_data, runs[0], 0, 2, 2)
+        && has_bytes(run_data, runs[0], 2, 2, 3)
+        && has_bytes(run_data, runs[0], 4, 4, 2)
+        && has_bytes(run_data, runs[0], 8, 2, 4)
+        && has_bytes(run_data, runs[0], 10, 2, 1);
+}
+
+bool check_scatter_copy_split()
+{
+    const Buffer_Write words = { .dst = BUFFER_A, .dst_offset = 8, .size = 8, .data_offset = 0 };
+    const Buffer_Write large = { .dst = BUFFER_A, .dst_offset = 0, .size = MIN_COPY_SIZE, .data_offset = 0 };
+    const Buffer_Write unaligned = { .dst = BUFFER_A, .dst_offset = 2, .size = 8, .data_offset = 0 };
+    const Buffer_Write partial_word = { .dst = BUFFER_A, .dst_offset = 8, .size = 6, .data_offset = 0 };
+    return is_scattered_write_run(words, true)
+        && !is_scattered_write_run(words, false)
+        && !is_scattered_write_run(large, true)
+        && !is_scattered_write_run(unaligned, true)
+        && !is_scattered_write_run(partial_word, true);
+}
+
+bool check_scatter_encoding()
+{
+    const auto run_words = std::to_array<uint32_t>({ 0xdeadbeef, 0x01234567 });
+    std::vector<std::byte> run_data(4 + sizeof(run_words));
+    memcpy(run_data.data() + 4, run_words.data(), sizeof(run_words));
+    const Buffer_Write run = { .dst = BUFFER_A, .dst_offset = 8, .size = sizeof(run_words), .data_offset = 4 };
+
+    std::array<uint32_t, 4> scatter_writes = {};
+    auto* end = encode_scatter_writes(run, run_data, reinterpret_cast<std::byte*>(scatter_writes.data()));
+    return end == reinterpret_cast<std::byte*>(scatter_writes.data()) + 2 * SCATTER_WRITE_SIZE
+        && scatter_writes == std::to_array<uint32_t>({ 2, 0xdeadbeef, 3, 0x01234567 });
+}
+
+int32_t run()
+{
+    auto passed = true;
+    passed &= expect("sorting and merging", check_sorting_and_merging());
+    passed &= expect("last write wins", check_last_write_wins());
+    passed &= expect("scatter and copy split", check_scatter_copy_split());
+    passed &= expect("scatter encoding", check_scatter_encoding());
+    return passed ? 0 : 1;
+}
+}
+
+int32_t main() try
+{
+    return ren::check::run();
+}
+catch (...)
+{
+    spdlog::critical("An unknown error occurred.");
+    return -1;
+}
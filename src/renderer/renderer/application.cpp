@@ -1,6 +1,7 @@
 #include "renderer/application.hpp"
 
 #include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <imgui.h>
 
@@ -13,6 +14,12 @@ namespace ren
 static const uint32_t RESERVED_BINDLESS_RESOURCE_COUNT = 1000;
 static const uint32_t RESERVED_BINDLESS_SAMPLER_COUNT = 20;
 
+enki::TaskScheduler& initialize_task_scheduler(enki::TaskScheduler& task_scheduler)
+{
+    task_scheduler.Initialize();
+    return task_scheduler;
+}
+
 Application::Application(const Application_Create_Info& create_info) noexcept
     : m_logger(std::make_shared<Logger>(create_info.log_level))
     , m_window(Window::create({
@@ -39,13 +46,15 @@ Application::Application(const Application_Create_Info& create_info) noexcept
         .image_count = REN_MAX_FRAMES_IN_FLIGHT + 1,
         .present_mode = rhi::Present_Mode::Immediate
         }))
-    , m_gpu_transfer_context(m_device.get())
+    , m_gpu_transfer_context(m_device.get(), &m_task_scheduler)
+    , m_gpu_readback_context(m_device.get())
     , m_acceleration_structure_builder(m_device.get())
     , m_frames()
     , m_frame_counter(0)
     , m_asset_repository(std::make_unique<Asset_Repository>(
         m_logger,
         m_device.get(),
+        initialize_task_scheduler(m_task_scheduler),
         Asset_Repository_Paths {
         .shaders = "../assets/shaders/",
         .pipelines = "../assets/pipelines/",
@@ -53,7 +62,9 @@ Application::Application(const Application_Create_Info& create_info) noexcept
             "../",
             "../../src/shared/"
         },
-        .models = "../assets/cache/"}))
+        .models = "../assets/cache/",
+        .shader_cache = "../assets/cache/shaders/",
+        .pipeline_cache = "../assets/cache/pipelines/"}))
     , m_resource_blackboard(std::make_unique<Render_Resource_Blackboard>(m_device.get()))
     , m_static_scene_data(std::make_unique<Static_Scene_Data>(
         m_device.get(),
@@ -61,9 +72,11 @@ Application::Application(const Application_Create_Info& create_info) noexcept
         m_gpu_transfer_context,
         *m_asset_repository,
         *m_resource_blackboard,
-        m_acceleration_structure_builder))
+        m_acceleration_structure_builder,
+        m_task_scheduler))
     , m_renderer(
         m_gpu_transfer_context,
+        m_gpu_readback_context,
         *m_swapchain,
         *m_asset_repository,
         *m_resource_blackboard)
@@ -200,12 +213,14 @@ void Application::setup_frame(Frame& frame) noexcept
     frame.compute_command_pool->reset();
     frame.copy_command_pool->reset();
     m_resource_blackboard->garbage_collect(m_frame_counter);
+    m_asset_repository->garbage_collect(m_frame_counter);
     auto [is_size_changed, width, height] = m_swapchain->query_resize();
     if (is_size_changed)
     {
         m_renderer.on_resize(width, height);
     }
     m_gpu_transfer_context.garbage_collect();
+    m_gpu_readback_context.garbage_collect(m_frame_counter);
     if (m_is_hdr_mode_changed || m_is_hdr_luminance_changed)
     {
         m_renderer.set_hdr_state(m_enable_hdr, static_cast<float>(m_display_peak_luminance));
@@ -227,11 +242,20 @@ void Application::setup_frame(Frame& frame) noexcept
     if (m_input_state->is_key_clicked(SDL_SCANCODE_F5))
     {
         m_logger->info("Recompiling shaders and recreating pipelines.");
-        m_device->wait_idle();
         m_asset_repository->recompile_shaders();
     }
+    else if (!m_asset_repository->is_reload_in_progress() && m_asset_repository->poll_file_changes())
+    {
+        m_logger->info("Shader sources changed, recompiling affected shaders and pipelines.");
+        m_asset_repository->recompile_changed_shaders();
+    }
+    if (m_asset_repository->apply_finished_reload())
+    {
+        m_logger->info("Swapped in recompiled shaders and pipelines.");
+    }
 
     m_renderer.setup_frame();
+    m_static_scene_data->integrate_loads();
     m_static_scene_data->update_tlas();
 }
 
@@ -239,13 +263,30 @@ void Application::render_frame(Frame& frame, double t, double dt) noexcept
 {
     auto graphics_cmd = frame.graphics_command_pool->acquire_command_list();
     auto upload_cmd = frame.graphics_command_pool->acquire_command_list();
+    auto skinning_cmd = frame.graphics_command_pool->acquire_command_list();
     auto acceleration_structure_cmd = frame.graphics_command_pool->acquire_command_list();
 
     m_renderer.render(*m_static_scene_data, graphics_cmd, t, dt);
-    m_gpu_transfer_context.process_immediate_uploads_on_graphics_queue(upload_cmd);
+    m_gpu_transfer_context.schedule_deferred_uploads();
+    if (m_gpu_transfer_context.has_async_uploads())
+    {
+        auto copy_cmd = frame.copy_command_pool->acquire_command_list();
+        auto copy_fence_signal_info = m_gpu_transfer_context.process_async_uploads_on_copy_queue(copy_cmd);
+        m_device->submit({
+            .queue_type = rhi::Queue_Type::Copy,
+            .wait_swapchain = nullptr,
+            .present_swapchain = nullptr,
+            .wait_infos = {},
+            .command_lists = { &copy_cmd, 1 },
+            .signal_infos = { &copy_fence_signal_info, 1 }
+            });
+    }
+    m_gpu_transfer_context.process_immediate_uploads_on_graphics_queue(upload_cmd,
+        m_asset_repository->get_compute_pipeline("upload_scatter"));
+    m_renderer.skin(*m_static_scene_data, skinning_cmd);
     m_acceleration_structure_builder.build_acceleration_structures(acceleration_structure_cmd);
 
-    auto cmds = std::to_array({ upload_cmd, acceleration_structure_cmd, graphics_cmd });
+    auto cmds = std::to_array({ upload_cmd, skinning_cmd, acceleration_structure_cmd, graphics_cmd });
 
     frame.fence_value += 1;
     rhi::Submit_Fence_Info frame_fence_signal_info = {
@@ -313,7 +354,9 @@ void Application::process_gui() noexcept
 void Application::update(double t, double dt) noexcept
 {
     m_static_scene_data->upload_scene_info();
+    m_static_scene_data->update_animations(static_cast<float>(dt), m_task_scheduler);
     m_renderer.update(*m_input_state, *m_static_scene_data, t, dt);
+    m_static_scene_data->update_texture_streaming(m_renderer.get_camera());
 }
 
 void Application::imgui_close_all_windows() noexcept
@@ -338,7 +381,7 @@ void Application::imgui_process_modals() noexcept
         {
             const auto model_files =  m_asset_repository->get_model_files();
             static std::string selected = "";
-            if (ImGui::BeginListBox("##Models", ImVec2(MODAL_WIDTH - 20.f, MODAL_HEIGHT -90.f)))
+            if (ImGui::BeginListBox("##Models", ImVec2(MODAL_WIDTH - 20.f, MODAL_HEIGHT - 115.f)))
             {
                 for (auto& file : model_files)
                 {
@@ -350,19 +393,35 @@ void Application::imgui_process_modals() noexcept
                 }
                 ImGui::EndListBox();
             }
+            // Multiple instances are laid out on a grid, e.g. to stress test skinning with crowds.
+            ImGui::SliderInt("Instances", &m_imgui_data.modals.add_model_instance_count, 1, 1024, "%d", ImGuiSliderFlags_AlwaysClamp);
+            if (const auto progress = m_static_scene_data->get_load_progress(); progress.pending_models + progress.pending_textures > 0)
+            {
+                ImGui::Text("Loading %u models and %u textures", progress.pending_models, progress.pending_textures);
+            }
             if (ImGui::Button("Add"))
             {
+                constexpr static auto INSTANCE_SPACING = 2.f;
                 m_imgui_data.modals.add_model = false;
-                const Model_Descriptor descriptor = {
+                const auto instance_count = m_imgui_data.modals.add_model_instance_count;
+                const auto grid_size = static_cast<int32_t>(std::ceil(std::sqrt(static_cast<float>(instance_count))));
+                Model_Descriptor descriptor = {
                     .name = selected,
-                    .instances = {
-                        {
-                            .translation = { 0.f, 0.f, 0.f },
-                            .rotation = glm::identity<glm::quat>(),
-                            .scale = { 1.f, 1.f, 1.f }
-                        }
-                    }
+                    .instances = {}
                 };
+                descriptor.instances.reserve(instance_count);
+                for (auto i = 0; i < instance_count; ++i)
+                {
+                    descriptor.instances.push_back({
+                        .translation = {
+                            INSTANCE_SPACING * static_cast<float>(i % grid_size),
+                            INSTANCE_SPACING * static_cast<float>(i / grid_size),
+                            0.f
+                        },
+                        .rotation = glm::identity<glm::quat>(),
+                        .scale = { 1.f, 1.f, 1.f }
+                    });
+                }
                 if (!selected.empty())
                     m_static_scene_data->add_model(descriptor);
             }
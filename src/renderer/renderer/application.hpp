@@ -5,11 +5,13 @@
 #include "renderer/renderer.hpp"
 #include "renderer/asset/asset_repository.hpp"
 #include "renderer/render_resource_blackboard.hpp"
+#include "renderer/gpu_readback.hpp"
 #include "renderer/gpu_transfer.hpp"
 #include "renderer/acceleration_structure_builder.hpp"
 
 #include <rhi/graphics_device.hpp>
 #include <rhi/swapchain.hpp>
+#include <TaskScheduler.h>
 
 #include "scene/scene.hpp"
 
@@ -26,6 +28,7 @@ struct ImGui_Data
     struct
     {
         bool add_model = false;
+        int32_t add_model_instance_count = 1;
     } modals;
 };
 
@@ -69,11 +72,13 @@ private:
 
 private:
     std::shared_ptr<Logger> m_logger;
+    enki::TaskScheduler m_task_scheduler;
     std::unique_ptr<Window> m_window;
     std::unique_ptr<Input_State> m_input_state;
     std::unique_ptr<rhi::Graphics_Device> m_device;
     std::unique_ptr<rhi::Swapchain> m_swapchain;
     GPU_Transfer_Context m_gpu_transfer_context;
+    GPU_Readback_Context m_gpu_readback_context;
     Acceleration_Structure_Builder m_acceleration_structure_builder;
     std::array<Frame, REN_MAX_FRAMES_IN_FLIGHT> m_frames;
     uint64_t m_frame_counter;
@@ -1,12 +1,16 @@
 #include "renderer/asset/asset_repository.hpp"
 #include <rhi_dxc_lib/shader_compiler.hpp>
 #include <nlohmann/json.hpp>
+#include <TaskScheduler.h>
 #include <fstream>
+#include <xxhash.h>
 #include <shared/serialized_asset_formats.hpp>
 #include "renderer/application.hpp"
 #include "renderer/filesystem/mapped_file.hpp"
 #include "renderer/filesystem/file_util.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <string_view>
 #include <ranges>
 
@@ -14,6 +18,50 @@
 
 namespace ren
 {
+struct Asset_Repository::Shader_Library_Source
+{
+    std::string hlsl_path;
+    std::string name;
+    std::string entry_point;
+    std::string shader_type_string;
+    rhi::dxc::Shader_Type shader_type;
+    std::vector<uint8_t> file;
+    std::vector<std::pair<std::string, std::vector<std::wstring>>> define_lists; // Never empty
+    uint64_t source_hash; // Includes are resolved
+    std::vector<std::string> dependencies;
+};
+
+struct Asset_Repository::Shader_Reload
+{
+    std::vector<Shader_Library_Source> sources;
+    std::vector<Shader_Library*> shader_libraries; // Target library per source
+    ankerl::unordered_dense::map<const Shader_Library*, std::size_t> source_indices;
+    ankerl::unordered_dense::set<std::string> requested_variants; // 'library/variant' that are compiled up front
+    std::vector<std::pair<std::size_t, std::size_t>> permutations; // Source and define list index per compiled permutation
+    std::vector<Shader_Cache_Entry> compiled_permutations; // Parallel to `permutations`
+    std::vector<std::vector<Named_Shader>> shaders; // Per source
+    std::vector<Compute_Library> compute_libraries; // Per source, empty for everything but compute shaders
+    std::vector<std::pair<std::string, Graphics_Pipeline_Description>> graphics_descriptions; // JSON path and description
+    std::vector<std::pair<std::string, Graphics_Pipeline_Library>> graphics_pipeline_libraries;
+    std::vector<std::pair<std::string, Ray_Tracing_Pipeline_Description>> ray_tracing_descriptions;
+    std::vector<std::pair<std::string, Ray_Tracing_Pipeline_Library>> ray_tracing_pipeline_libraries;
+    std::unique_ptr<enki::TaskSet> task;
+};
+
+struct Asset_Repository::Shader_Warm_Up
+{
+    struct Job
+    {
+        std::shared_ptr<const Shader_Library_Source> source;
+        std::size_t define_list_index;
+    };
+
+    std::vector<Job> jobs;
+    std::vector<std::wstring> include_dirs;
+    std::atomic<bool> is_cancelled = false;
+    std::unique_ptr<enki::TaskSet> task;
+};
+
 class Asset_Repository::Shader_Compiler
 {
 public:
@@ -36,86 +84,139 @@ private:
 
 Asset_Repository::Asset_Repository(
     std::shared_ptr<Logger> logger, rhi::Graphics_Device* graphics_device,
-    Asset_Repository_Paths&& paths)
+    enki::TaskScheduler& task_scheduler,
+    Asset_Repository_Paths&& paths,
+    std::unique_ptr<Pipeline_Cache_Device> pipeline_cache_device)
     : m_logger(std::move(logger))
     , m_graphics_device(graphics_device)
+    , m_task_scheduler(task_scheduler)
     , m_paths(std::move(paths))
-    , m_shader_compiler(std::make_unique<Shader_Compiler>())
+    , m_shader_compilers(task_scheduler.GetNumTaskThreads())
+    , m_shader_cache(m_logger, m_paths.shader_cache)
+    , m_pipeline_description_cache(m_logger, m_paths.pipeline_cache)
+    , m_pipeline_cache(std::make_unique<Pipeline_Cache>(m_logger,
+        pipeline_cache_device
+            ? std::move(pipeline_cache_device)
+            : std::make_unique<Rhi_Pipeline_Cache_Device>(graphics_device),
+        m_paths.pipeline_cache))
+    , m_current_garbage_frame(REN_MAX_FRAMES_IN_FLIGHT)
 {
     m_logger->info("Asset repository created with the following asset paths:");
     m_logger->info("Shaders: '{}'", m_paths.shaders);
     m_logger->info("Pipelines: '{}'", m_paths.pipelines);
+    m_logger->info("Shader cache: '{}'", m_paths.shader_cache);
+    m_logger->info("Pipeline cache: '{}'", m_paths.pipeline_cache);
     m_logger->info("Asset repository uses the following include dirs for shader compilation:");
     for (auto& path : m_paths.shader_include_paths)
     {
         m_logger->info("Include path: '{}'", path);
     }
 
-    create_shader_and_compute_libraries();
-    create_graphics_pipeline_libraries();
-    create_ray_tracing_pipeline_libraries();
+    load_session_variants();
+    m_pipeline_cache->load();
+    recompile_shaders();
+    wait_for_reload();
+    if (m_pipeline_cache->get_device().has_native_cache())
+    {
+        m_logger->info("Pipeline cache: {} hits, {} misses.",
+            m_pipeline_cache->get_hit_count(), m_pipeline_cache->get_miss_count());
+    }
+    else
+    {
+        m_logger->info("Pipeline cache: the backend has no native pipeline cache, {} pipelines were compiled by the driver.",
+            m_pipeline_cache->get_hit_count() + m_pipeline_cache->get_miss_count());
+    }
+    create_file_watches();
     register_textures();
     register_models();
+    register_animations();
 }
 
 Asset_Repository::~Asset_Repository()
 {
+    // The background tasks reference the repository, they have to finish first.
+    stop_warm_up();
+    if (m_reload)
+    {
+        m_task_scheduler.WaitforTask(m_reload->task.get());
+    }
+    save_session_variants();
+    m_pipeline_cache->save();
+    garbage_collect(~0ull);
     for (auto& file : m_files)
     {
-        file.unmap();
+        if (file.data)
+            file.unmap();
     }
 }
 
-rhi::Shader_Blob* Asset_Repository::get_shader_blob(const std::string_view& name, const std::string_view& variant) const
+rhi::Shader_Blob* Asset_Repository::get_shader_blob(const Name name, const Name variant)
 {
-    if (!m_shader_library_ptrs.contains(std::string(name)))
+    const auto it = m_shader_library_ptrs.find(name);
+    if (it == m_shader_library_ptrs.end())
     {
-        m_logger->error("Asset repository does not contain shader blob '{}'", name);
+        m_logger->error("Asset repository does not contain shader blob '{}'", name.str());
         return nullptr;
     }
-    return m_shader_library_ptrs.at(std::string(name))->get_shader(variant);
+    auto* shader_library = it->second;
+    for (auto i = 0ull; i < shader_library->shaders.size(); ++i)
+    {
+        if (shader_library->shaders[i].name == variant.str())
+        {
+            return request_shader_variant(*shader_library, i);
+        }
+    }
+    return nullptr;
 }
 
-rhi::Shader_Blob* Asset_Repository::get_shader_blob(const std::string_view& name) const
+rhi::Shader_Blob* Asset_Repository::get_shader_blob(const Name name) const
 {
-    if (!m_shader_library_ptrs.contains(std::string(name)))
+    const auto it = m_shader_library_ptrs.find(name);
+    if (it == m_shader_library_ptrs.end())
     {
-        m_logger->error("Asset repository does not contain shader blob '{}'", name);
+        m_logger->error("Asset repository does not contain shader blob '{}'", name.str());
         return nullptr;
     }
-    return m_shader_library_ptrs.at(std::string(name))->shaders.at(0).blob;
+    return it->second->shaders.at(0).blob;
 }
 
-Compute_Pipeline Asset_Repository::get_compute_pipeline(const std::string_view& name) const
+Compute_Pipeline Asset_Repository::get_compute_pipeline(const Name name) const
 {
-    return Compute_Pipeline(m_compute_library_ptrs.at(std::string(name)));
+    return Compute_Pipeline(m_compute_library_ptrs.at(name));
 }
 
-Graphics_Pipeline Asset_Repository::get_graphics_pipeline(const std::string_view& name) const
+Graphics_Pipeline Asset_Repository::get_graphics_pipeline(const Name name) const
 {
-    return Graphics_Pipeline(m_pipeline_library_ptrs.at(std::string(name)));
+    return Graphics_Pipeline(m_pipeline_library_ptrs.at(name));
 }
 
-Ray_Tracing_Pipeline Asset_Repository::get_ray_tracing_pipeline(const std::string_view& name) const
+Ray_Tracing_Pipeline Asset_Repository::get_ray_tracing_pipeline(const Name name) const
 {
-    return Ray_Tracing_Pipeline(m_ray_tracing_pipeline_library_ptrs.at(std::string(name)));
+    return Ray_Tracing_Pipeline(m_ray_tracing_pipeline_library_ptrs.at(name));
 }
 
-Mapped_File* Asset_Repository::get_model(const std::string_view& name) const
+Mapped_File* Asset_Repository::get_model(const std::string_view& name)
 {
-    return m_model_ptrs.at(std::string(name));
+    return use_file(m_model_ptrs.at(std::string(name)));
 }
 
-Mapped_File* Asset_Repository::get_texture(const std::string_view& name) const
+Mapped_File* Asset_Repository::get_texture(const std::string_view& name)
 {
-    return m_texture_ptrs.at(std::string(name));
+    return use_file(m_texture_ptrs.at(std::string(name)));
 }
 
-Mapped_File* Asset_Repository::get_texture_safe(const std::string_view& name) const
+Mapped_File* Asset_Repository::get_texture_safe(const std::string_view& name)
 {
     if (!m_texture_ptrs.contains(std::string(name)))
         return nullptr;
-    return m_texture_ptrs.at(std::string(name));
+    return use_file(m_texture_ptrs.at(std::string(name)));
+}
+
+Mapped_File* Asset_Repository::get_animation_safe(const std::string_view& name)
+{
+    if (!m_animation_ptrs.contains(std::string(name)))
+        return nullptr;
+    return use_file(m_animation_ptrs.at(std::string(name)));
 }
 
 std::vector<std::string> Asset_Repository::get_model_files() const
@@ -129,13 +230,146 @@ std::vector<std::string> Asset_Repository::get_model_files() const
     return result;
 }
 
+void Asset_Repository::pin_file(Mapped_File* file)
+{
+    static_cast<Asset_File*>(file)->pin_count += 1;
+}
+
+void Asset_Repository::unpin_file(Mapped_File* file)
+{
+    static_cast<Asset_File*>(file)->pin_count -= 1;
+}
+
 void Asset_Repository::recompile_shaders()
 {
-    create_shader_and_compute_libraries();
-    create_graphics_pipeline_libraries();
-    create_ray_tracing_pipeline_libraries();
+    if (is_reload_in_progress())
+    {
+        m_logger->warn("Shaders are already being recompiled.");
+        return;
+    }
+    start_reload(get_hlsl_paths(), get_pipeline_json_paths(false), get_pipeline_json_paths(true));
+}
+
+bool Asset_Repository::is_reload_in_progress() const
+{
+    return m_reload != nullptr;
+}
+
+bool Asset_Repository::apply_finished_reload()
+{
+    if (!m_reload || !m_reload->task->GetIsComplete())
+    {
+        return false;
+    }
+    const auto reload = std::move(m_reload);
+    commit_reload(*reload);
+    return true;
+}
+
+void Asset_Repository::wait_for_reload()
+{
+    if (m_reload)
+    {
+        m_task_scheduler.WaitforTask(m_reload->task.get());
+        apply_finished_reload();
+    }
+}
+
+void Asset_Repository::garbage_collect(const uint64_t frame)
+{
+    std::vector<Retired_Pipeline> survivors;
+    survivors.reserve(m_retired_pipelines.size());
+    for (const auto& retired_pipeline : m_retired_pipelines)
+    {
+        if (frame > retired_pipeline.frame)
+        {
+            std::scoped_lock lock(m_device_object_mutex);
+            m_graphics_device->destroy_pipeline(retired_pipeline.pipeline);
+        }
+        else
+        {
+            survivors.emplace_back(retired_pipeline);
+        }
+    }
+    std::swap(m_retired_pipelines, survivors);
+    m_current_garbage_frame = frame + REN_MAX_FRAMES_IN_FLIGHT;
+    evict_mapped_files();
+    m_frame = frame;
+}
+
+Asset_Repository::Asset_File* Asset_Repository::use_file(Asset_File* file)
+{
+    file->last_use_frame = m_frame;
+    if (!file->data)
+    {
+        file->map(file->path.c_str(), file->options);
+        if (!file->data)
+        {
+            m_logger->error("Failed to open file '{}'", file->path);
+            return file;
+        }
+        m_mapped_file_usage.add(file->size);
+    }
+    return file;
+}
+
+void Asset_Repository::evict_mapped_files()
+{
+    if (m_mapped_file_usage.bytes <= m_mapped_file_budget)
+    {
+        return;
+    }
+    // Runs before `m_frame` advances, so files used since the last collection, i.e. by the frame that was just
+    // recorded, are kept even over budget. The next frame would most likely map them again.
+    std::vector<Asset_File*> candidates;
+    for (auto& file : m_files)
+    {
+        if (file.data && file.pin_count == 0 && file.last_use_frame < m_frame)
+        {
+            candidates.push_back(&file);
+        }
+    }
+    std::ranges::sort(candidates, {}, &Asset_File::last_use_frame);
+    for (auto* file : candidates)
+    {
+        if (m_mapped_file_usage.bytes <= m_mapped_file_budget)
+        {
+            break;
+        }
+        m_logger->debug("Unmapping '{}'", file->path);
+        m_mapped_file_usage.remove(file->size);
+        file->unmap();
+    }
+}
+
+void Asset_Repository::request_compute_variant(Compute_Library& compute_library, Compute_Pipeline_Wrapper& wrapper)
+{
+    wrapper.is_requested = true;
+    if (!compute_library.shader_library)
+    {
+        return;
+    }
+    const auto& shaders = compute_library.shader_library->shaders;
+    const auto it = std::ranges::find(shaders, wrapper.name.str(), &Named_Shader::name);
+    if (it == shaders.end())
+    {
+        return;
+    }
+    auto* blob = request_shader_variant(*compute_library.shader_library, std::distance(shaders.begin(), it));
+    if (!wrapper.pipeline && blob)
+    {
+        rhi::Compute_Pipeline_Create_Info create_info = {
+            blob
+        };
+        const auto key = Pipeline_Cache::compute_key({ &it->bytecode_hash, 1 });
+        std::scoped_lock lock(m_device_object_mutex);
+        wrapper.pipeline = m_pipeline_cache->create_pipeline(key, create_info).value_or(nullptr);
+        m_logger->debug("Created deferred compute pipeline '{}'", wrapper.name.str());
+    }
 }
 
+constexpr static auto SHADER_SESSION_FILE_NAME = "used_variants.json";
+
 rhi::dxc::Shader_Type shader_type_from_string(std::string_view type)
 {
     if (type == "vs")
@@ -163,15 +397,25 @@ rhi::dxc::Shader_Type shader_type_from_string(std::string_view type)
     std::unreachable();
 }
 
+const Named_Shader* find_shader(const std::vector<Named_Shader>& shaders, const std::string_view& name)
+{
+    for (const auto& shader : shaders)
+    {
+        if (shader.name == name)
+        {
+            return &shader;
+        }
+    }
+    return nullptr;
+}
+
 std::vector<std::string> split_string_into_lines(const std::string_view text)
 {
     return text | std::ranges::views::split('\n')
                 | std::ranges::to<std::vector<std::string>>();
 }
 
-void Asset_Repository::compile_shader_library(
-    std::string_view hlsl_path,
-    const std::vector<std::wstring>& include_dirs)
+Asset_Repository::Shader_Library_Source Asset_Repository::parse_shader_library(std::string_view hlsl_path)
 {
     auto shader_text = load_file_as_string_unsafe(std::string(hlsl_path).c_str());
     auto shader_text_lines = split_string_into_lines(shader_text);
@@ -353,261 +597,567 @@ void Asset_Repository::compile_shader_library(
         }
     }
 
-    std::vector<Named_Shader> named_shaders;
-    // Compile all shader permutations
+    if (define_lists.empty())
     {
-        auto file = load_file_binary_unsafe(std::string(hlsl_path).c_str());
-        rhi::dxc::Shader_Compile_Info compile_info = {
-            .data = file.data(),
-            .data_size = file.size(),
-            .entrypoint = std::wstring(entry_point.begin(), entry_point.end()),
-            .matrix_majorness = rhi::dxc::Matrix_Majorness::Column_Major,
-            .shader_type = shader_type,
-            .version = rhi::dxc::Shader_Version::SM6_8,
-            .embed_debug = true
-        };
-        rhi::dxc::Shader_Compiler_Settings settings = {
-            .include_dirs = include_dirs
-        };
+        define_lists.emplace_back( name, std::vector<std::wstring>{} );
+    }
+
+    return {
+        .hlsl_path = std::string(hlsl_path),
+        .name = std::move(name),
+        .entry_point = std::move(entry_point),
+        .shader_type_string = std::move(shader_type_string),
+        .shader_type = shader_type,
+        .file = load_file_binary_unsafe(std::string(hlsl_path).c_str()),
+        .define_lists = std::move(define_lists),
+        .source_hash = 0
+    };
+}
+
+void Asset_Repository::start_reload(
+    const std::vector<std::string>& hlsl_paths,
+    std::vector<std::string>&& graphics_json_paths,
+    std::vector<std::string>&& ray_tracing_json_paths)
+{
+    auto reload = std::make_unique<Shader_Reload>();
 
-        if (define_lists.empty())
+    // Besides the default variant, only variants used in this or the last session and variants referenced
+    // by pipelines are compiled up front. Everything else is compiled on first request.
+    reload->requested_variants = m_used_variants;
+    reload->requested_variants.insert(m_session_variants.begin(), m_session_variants.end());
+    for (const auto& json_path : graphics_json_paths)
+    {
+        if (auto description = m_pipeline_description_cache.load_graphics(json_path); description.has_value())
         {
-            define_lists.emplace_back( name, std::vector<std::wstring>{} );
+            reload->graphics_descriptions.emplace_back(json_path, std::move(description.value()));
         }
-        auto is_dx12 = m_graphics_device->get_graphics_api() == rhi::Graphics_API::D3D12;
-        for (auto& [name, define_list] : define_lists)
+    }
+    for (const auto& json_path : ray_tracing_json_paths)
+    {
+        if (auto description = m_pipeline_description_cache.load_ray_tracing(json_path); description.has_value())
         {
-            m_logger->info("Compiling shader: '{}'", name);
-            // compile using defines
-            settings.defines = std::move(define_list);
-            auto shader = m_shader_compiler->compile_from_memory(settings, compile_info);
-            rhi::Shader_Blob_Create_Info create_info = {
-                .data = is_dx12 ? shader.dxil.data() : shader.spirv.data(),
-                .data_size = is_dx12 ? shader.dxil.size() : shader.spirv.size(),
-                .groups_x = shader.reflection.workgroups_x,
-                .groups_y = shader.reflection.workgroups_y,
-                .groups_z = shader.reflection.workgroups_z
-            };
-            named_shaders.emplace_back( name, m_graphics_device->create_shader_blob(create_info).value_or(nullptr) );
+            reload->ray_tracing_descriptions.emplace_back(json_path, std::move(description.value()));
+        }
+    }
+
+    auto reload_hlsl_paths = hlsl_paths;
+    auto request_variant = [&](const Pipeline_Shader_Description& shader)
+    {
+        if (shader.library.empty() || shader.variant.empty())
+        {
+            return;
+        }
+        reload->requested_variants.insert(shader.library + "/" + shader.variant);
+
+        // Libraries outside of the reload have to be recompiled if they never compiled the variant.
+        const auto it = m_shader_library_ptrs.find(Name(shader.library));
+        if (it == m_shader_library_ptrs.end() || std::ranges::contains(reload_hlsl_paths, it->second->hlsl_path))
+        {
+            return;
+        }
+        if (std::ranges::any_of(it->second->shaders,
+            [&](const Named_Shader& named_shader) { return named_shader.name == shader.variant && !named_shader.blob; }))
+        {
+            reload_hlsl_paths.push_back(it->second->hlsl_path);
+        }
+    };
+    for (const auto& [json_path, description] : reload->graphics_descriptions)
+    {
+        for (const auto* shader : { &description.ts, &description.ms, &description.vs, &description.ps })
+        {
+            request_variant(*shader);
+        }
+    }
+    for (const auto& [json_path, description] : reload->ray_tracing_descriptions)
+    {
+        for (const auto& shader : description.shaders)
+        {
+            request_variant(shader.shader);
         }
     }
 
-    auto shader_library_lookup_name = name + "." + shader_type_string;
-    if (!m_shader_library_ptrs.contains(shader_library_lookup_name))
+    reload->sources.reserve(reload_hlsl_paths.size());
+    for (const auto& hlsl_path : reload_hlsl_paths)
     {
-        m_shader_library_ptrs.insert(std::make_pair(shader_library_lookup_name, &*m_shader_libraries.emplace()));
+        m_logger->debug("Processing shader {}", hlsl_path);
+        reload->sources.push_back(parse_shader_library(hlsl_path));
     }
-    auto* shader_library = m_shader_library_ptrs[shader_library_lookup_name];
-    shader_library->shaders = std::move(named_shaders);
-    shader_library->hlsl_path = hlsl_path;
-    m_logger->debug("Successfully created shader library '{}'", shader_library_lookup_name);
 
-    if (shader_type == rhi::dxc::Shader_Type::Compute)
+    // Libraries are created up front, so pipelines built in the background can reference new libraries.
+    // Until the reload is committed they are empty and not referenced by anything.
+    reload->shader_libraries.reserve(reload->sources.size());
+    for (const auto& source : reload->sources)
     {
-        m_logger->debug("Creating or updating associated compute library.");
-        if (!m_compute_library_ptrs.contains(name))
+        const Name shader_library_lookup_name(source.name + "." + source.shader_type_string);
+        if (!m_shader_library_ptrs.contains(shader_library_lookup_name))
+        {
+            auto& shader_library = *m_shader_libraries.emplace();
+            shader_library.name = shader_library_lookup_name.str();
+            shader_library.referenced_compute_library = nullptr;
+            m_shader_library_ptrs.insert(std::make_pair(shader_library_lookup_name, &shader_library));
+        }
+        auto* shader_library = m_shader_library_ptrs.at(shader_library_lookup_name);
+        reload->source_indices[shader_library] = reload->shader_libraries.size();
+        reload->shader_libraries.push_back(shader_library);
+
+        const Name compute_library_name(source.name);
+        if (source.shader_type == rhi::dxc::Shader_Type::Compute && !m_compute_library_ptrs.contains(compute_library_name))
         {
-            m_compute_library_ptrs.insert(std::make_pair(name, &*m_compute_libraries.emplace()));
+            m_compute_library_ptrs.insert(std::make_pair(compute_library_name, &*m_compute_libraries.emplace()));
         }
-        auto* compute_library = m_compute_library_ptrs[name];
-        shader_library->referenced_compute_library = compute_library;
-        compute_library->create_pipelines(m_graphics_device, shader_library);
-        m_logger->debug("Successfully created compute library '{}'", name);
     }
+
+    reload->task = std::make_unique<enki::TaskSet>(1,
+        [this, reload = reload.get()](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            compile_reload(*reload);
+            create_reload_objects(*reload);
+        });
+    m_task_scheduler.AddTaskSetToPipe(reload->task.get());
+    m_reload = std::move(reload);
 }
 
-void Asset_Repository::compile_graphics_pipeline_library(const std::string_view& json_path)
+Shader_Cache_Entry Asset_Repository::compile_permutation(
+    const Shader_Library_Source& source,
+    const std::size_t define_list_index,
+    const std::vector<std::wstring>& include_dirs,
+    const uint32_t thread_idx,
+    const bool load_cached,
+    bool* is_cache_hit)
 {
-    // parse the json file
-    auto pipeline_json = nlohmann::json::parse(std::ifstream(std::string(json_path)));
+    const auto& [name, define_list] = source.define_lists[define_list_index];
+    rhi::dxc::Shader_Compile_Info compile_info = {
+        .data = source.file.data(),
+        .data_size = source.file.size(),
+        .entrypoint = std::wstring(source.entry_point.begin(), source.entry_point.end()),
+        .matrix_majorness = rhi::dxc::Matrix_Majorness::Column_Major,
+        .shader_type = source.shader_type,
+        .version = rhi::dxc::Shader_Version::SM6_8,
+        .embed_debug = true
+    };
+    rhi::dxc::Shader_Compiler_Settings settings = {
+        .include_dirs = include_dirs
+    };
+    settings.defines = define_list;
 
-    // TODO: add permutations?
-    bool is_mesh_shading = false;
+    const auto cache_key = Shader_Cache::compute_key(source.source_hash, settings, compile_info);
+    if (!load_cached && m_shader_cache.contains(cache_key))
+    {
+        if (is_cache_hit)
+            *is_cache_hit = true;
+        return {};
+    }
+    if (load_cached)
+    {
+        if (auto cached = m_shader_cache.load(cache_key); cached.has_value())
+        {
+            m_logger->debug("Loaded shader '{}' from cache.", name);
+            if (is_cache_hit)
+                *is_cache_hit = true;
+            return std::move(cached.value());
+        }
+    }
+    if (is_cache_hit)
+        *is_cache_hit = false;
 
-    rhi::Shader_Blob* ts;
-    rhi::Shader_Blob* ms;
-    rhi::Shader_Blob* vs;
-    rhi::Shader_Blob* ps;
-    rhi::Pipeline_Blend_State_Info blend_state_info{};
-    rhi::Primitive_Topology_Type primitive_topology;
-    rhi::Pipeline_Rasterization_State_Info rasterizer_state_info{};
-    rhi::Pipeline_Depth_Stencil_State_Info depth_stencil_info{};
-    std::array<rhi::Image_Format, rhi::PIPELINE_COLOR_ATTACHMENTS_MAX> color_attachments{};
-    uint32_t color_attachment_count = 0;
-    rhi::Image_Format depth_stencil_format;
+    m_logger->info("Compiling shader: '{}'", name);
+    auto& shader_compiler = m_shader_compilers[thread_idx];
+    if (!shader_compiler)
+    {
+        shader_compiler = std::make_unique<Shader_Compiler>();
+    }
+    auto shader = shader_compiler->compile_from_memory(settings, compile_info);
+    Shader_Cache_Entry result = {
+        .dxil = std::vector<uint8_t>(shader.dxil.begin(), shader.dxil.end()),
+        .spirv = std::vector<uint8_t>(shader.spirv.begin(), shader.spirv.end()),
+        .groups_x = shader.reflection.workgroups_x,
+        .groups_y = shader.reflection.workgroups_y,
+        .groups_z = shader.reflection.workgroups_z
+    };
+    if (!result.dxil.empty() || !result.spirv.empty())
+    {
+        m_shader_cache.store(cache_key, result);
+    }
+    return result;
+}
 
-    auto set_shader = [&](auto& shader, const std::string_view type)
+void Asset_Repository::create_shader_blob(const Shader_Cache_Entry& compiled_shader, Named_Shader& shader) const
+{
+    const auto is_dx12 = m_graphics_device->get_graphics_api() == rhi::Graphics_API::D3D12;
+    const auto& bytecode = is_dx12 ? compiled_shader.dxil : compiled_shader.spirv;
+    rhi::Shader_Blob_Create_Info create_info = {
+        .data = bytecode.data(),
+        .data_size = bytecode.size(),
+        .groups_x = compiled_shader.groups_x,
+        .groups_y = compiled_shader.groups_y,
+        .groups_z = compiled_shader.groups_z
+    };
     {
-        if (pipeline_json.contains(type))
+        std::scoped_lock lock(m_device_object_mutex);
+        shader.blob = m_graphics_device->create_shader_blob(create_info).value_or(nullptr);
+    }
+    // Identifies the shader in pipeline cache keys across runs, unlike the blob pointer.
+    shader.bytecode_hash = XXH3_64bits(bytecode.data(), bytecode.size());
+}
+
+rhi::Shader_Blob* Asset_Repository::request_shader_variant(Shader_Library& shader_library, const std::size_t variant_index)
+{
+    auto& shader = shader_library.shaders[variant_index];
+    m_used_variants.insert(shader_library.name + "/" + shader.name);
+    if (shader.blob)
+    {
+        return shader.blob;
+    }
+
+    const auto source = m_shader_sources.find(&shader_library);
+    if (source == m_shader_sources.end())
+    {
+        return nullptr;
+    }
+    // Usually a cache hit, either from an earlier session or from the warm-up.
+    m_logger->debug("Requested deferred shader variant '{}'", shader.name);
+    const auto compiled_shader = compile_permutation(*source->second, variant_index, get_shader_include_dirs(),
+        m_task_scheduler.GetThreadNum(), true);
+    create_shader_blob(compiled_shader, shader);
+    return shader.blob;
+}
+
+void Asset_Repository::compile_reload(Shader_Reload& reload)
+{
+    const auto include_dirs = get_shader_include_dirs();
+    std::vector<std::filesystem::path> include_paths(include_dirs.begin(), include_dirs.end());
+
+    // Flatten the requested permutations of all libraries, the default variant is always compiled.
+    auto variant_count = 0ull;
+    for (auto i = 0ull; i < reload.sources.size(); ++i)
+    {
+        auto& source = reload.sources[i];
+        source.source_hash = m_shader_cache.hash_source(source.hlsl_path, include_paths, &source.dependencies);
+        const auto shader_library_lookup_name = source.name + "." + source.shader_type_string;
+        for (auto j = 0ull; j < source.define_lists.size(); ++j)
         {
-            if (pipeline_json[type].contains("name"))
+            if (j == 0 || reload.requested_variants.contains(shader_library_lookup_name + "/" + source.define_lists[j].first))
             {
-                const auto name = pipeline_json[type]["name"].get<std::string>();
-                auto variant_name = pipeline_json[type].contains("variant")
-                    ? pipeline_json[type]["variant"].get<std::string>()
-                    : "";
-                if (!m_shader_library_ptrs.contains(name))
-                {
-                    m_logger->error("Shader library '{}' does not exist.", name);
-                }
-                const auto shader_lib = m_shader_library_ptrs[name];
-                if (!variant_name.empty())
+                reload.permutations.emplace_back(i, j);
+            }
+        }
+        variant_count += source.define_lists.size();
+    }
+    reload.compiled_permutations.resize(reload.permutations.size());
+
+    // Every worker thread owns its compiler, DXC instances must not be shared between threads.
+    // They are only created on a cache miss, so a warm start does not touch DXC at all.
+    std::atomic<uint32_t> cache_hit_count = 0;
+    enki::TaskSet compile_task(static_cast<uint32_t>(reload.permutations.size()),
+        [&](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            for (auto i = range.start; i < range.end; ++i)
+            {
+                const auto [source_index, define_list_index] = reload.permutations[i];
+                auto is_cache_hit = false;
+                reload.compiled_permutations[i] = compile_permutation(
+                    reload.sources[source_index], define_list_index, include_dirs, thread_idx, true, &is_cache_hit);
+                if (is_cache_hit)
                 {
-                    shader = shader_lib->get_shader(variant_name);
+                    cache_hit_count.fetch_add(1, std::memory_order_relaxed);
                 }
-                else
+            }
+        });
+    if (!reload.permutations.empty())
+    {
+        m_task_scheduler.AddTaskSetToPipe(&compile_task);
+        m_task_scheduler.WaitforTask(&compile_task);
+    }
+    m_logger->info("Loaded {} of {} shaders from the shader cache, {} variants are deferred until requested.",
+        cache_hit_count.load(), reload.permutations.size(), variant_count - reload.permutations.size());
+}
+
+void Asset_Repository::create_reload_objects(Shader_Reload& reload)
+{
+    // Every declared variant gets an entry, deferred variants stay without a blob until requested.
+    reload.shaders.resize(reload.sources.size());
+    for (auto i = 0ull; i < reload.sources.size(); ++i)
+    {
+        auto& named_shaders = reload.shaders[i];
+        named_shaders.reserve(reload.sources[i].define_lists.size());
+        for (const auto& [name, define_list] : reload.sources[i].define_lists)
+        {
+            named_shaders.emplace_back( name, nullptr, 0 );
+        }
+    }
+    for (auto i = 0ull; i < reload.permutations.size(); ++i)
+    {
+        const auto [source_index, define_list_index] = reload.permutations[i];
+        create_shader_blob(reload.compiled_permutations[i], reload.shaders[source_index][define_list_index]);
+    }
+    reload.compiled_permutations = {};
+
+    reload.compute_libraries.resize(reload.sources.size());
+    auto create_compute_pipelines = [&](const std::size_t i)
+    {
+        if (reload.sources[i].shader_type != rhi::dxc::Shader_Type::Compute)
+        {
+            return;
+        }
+        Shader_Library staged_library = {};
+        staged_library.shaders = reload.shaders[i];
+        reload.compute_libraries[i].create_pipelines(m_graphics_device, *m_pipeline_cache, &staged_library);
+    };
+    reload.graphics_pipeline_libraries.resize(reload.graphics_descriptions.size());
+    auto create_graphics_pipeline = [&](const std::size_t i)
+    {
+        const auto& [json_path, description] = reload.graphics_descriptions[i];
+        m_logger->debug("Processing graphics pipeline library '{}'", json_path);
+        reload.graphics_pipeline_libraries[i] = build_graphics_pipeline_library(json_path, description, reload);
+    };
+    reload.ray_tracing_pipeline_libraries.resize(reload.ray_tracing_descriptions.size());
+    auto create_ray_tracing_pipeline = [&](const std::size_t i)
+    {
+        const auto& [json_path, description] = reload.ray_tracing_descriptions[i];
+        m_logger->debug("Processing ray tracing pipeline library '{}'", json_path);
+        reload.ray_tracing_pipeline_libraries[i] = build_ray_tracing_pipeline_library(json_path, description, reload);
+    };
+
+    // The lock is taken per library, so the frame only waits for one library at a time while pipelines are created.
+    const auto compute_count = reload.sources.size();
+    const auto graphics_count = reload.graphics_descriptions.size();
+    const auto total_count = compute_count + graphics_count + reload.ray_tracing_descriptions.size();
+    for (auto i = 0ull; i < total_count; ++i)
+    {
+        std::scoped_lock lock(m_device_object_mutex);
+        if (i < compute_count)
+            create_compute_pipelines(i);
+        else if (i < compute_count + graphics_count)
+            create_graphics_pipeline(i - compute_count);
+        else
+            create_ray_tracing_pipeline(i - compute_count - graphics_count);
+    }
+}
+
+void Asset_Repository::commit_reload(Shader_Reload& reload)
+{
+    for (auto i = 0ull; i < reload.sources.size(); ++i)
+    {
+        auto& source = reload.sources[i];
+        auto* shader_library = reload.shader_libraries[i];
+        shader_library->shaders = std::move(reload.shaders[i]);
+        shader_library->hlsl_path = source.hlsl_path;
+        shader_library->dependencies = std::move(source.dependencies);
+        m_logger->debug("Successfully created shader library '{}'", shader_library->name);
+
+        if (source.shader_type == rhi::dxc::Shader_Type::Compute)
+        {
+            auto* compute_library = m_compute_library_ptrs.at(Name(source.name));
+            shader_library->referenced_compute_library = compute_library;
+            compute_library->asset_repository = this;
+            compute_library->shader_library = shader_library;
+            auto& staged_library = reload.compute_libraries[i];
+            std::swap(compute_library->pipelines, staged_library.pipelines);
+            std::swap(compute_library->pipeline_ptrs, staged_library.pipeline_ptrs);
+            for (const auto& wrapper : staged_library.pipelines)
+            {
+                retire_pipeline(wrapper.pipeline);
+            }
+            m_logger->debug("Successfully created compute library '{}'", source.name);
+        }
+        m_shader_sources[shader_library] = std::make_shared<const Shader_Library_Source>(std::move(source));
+    }
+
+    for (auto& [name, library] : reload.graphics_pipeline_libraries)
+    {
+        const Name pipeline_library_name(name);
+        if (!m_pipeline_library_ptrs.contains(pipeline_library_name))
+        {
+            m_pipeline_library_ptrs[pipeline_library_name] = &*m_pipeline_libraries.emplace();
+        }
+        else
+        {
+            retire_pipeline(m_pipeline_library_ptrs[pipeline_library_name]->pipeline);
+        }
+        auto& pipeline_library = *m_pipeline_library_ptrs[pipeline_library_name];
+        pipeline_library = std::move(library);
+
+        // Bookkeeping
+        for (auto* shader_library : { pipeline_library.ts, pipeline_library.ms, pipeline_library.vs, pipeline_library.ps })
+        {
+            if (shader_library && !std::ranges::contains(shader_library->referenced_pipeline_libraries, &pipeline_library))
+                shader_library->referenced_pipeline_libraries.push_back(&pipeline_library);
+        }
+        m_logger->debug("Created graphics pipeline library '{}'", name);
+    }
+
+    for (auto& [name, library] : reload.ray_tracing_pipeline_libraries)
+    {
+        const Name pipeline_library_name(name);
+        if (!m_ray_tracing_pipeline_library_ptrs.contains(pipeline_library_name))
+        {
+            m_ray_tracing_pipeline_library_ptrs[pipeline_library_name] = &*m_ray_tracing_pipeline_libraries.emplace();
+        }
+        else
+        {
+            retire_pipeline(m_ray_tracing_pipeline_library_ptrs[pipeline_library_name]->pipeline);
+        }
+        auto& pipeline_library = *m_ray_tracing_pipeline_library_ptrs[pipeline_library_name];
+        pipeline_library = std::move(library);
+
+        // Bookkeeping
+        for (auto& shader_ref : pipeline_library.shaders)
+        {
+            if (shader_ref.lib && !std::ranges::contains(shader_ref.lib->referenced_ray_tracing_pipeline_libraries, &pipeline_library))
+                shader_ref.lib->referenced_ray_tracing_pipeline_libraries.push_back(&pipeline_library);
+        }
+        m_logger->debug("Created ray tracing pipeline library '{}'", name);
+    }
+
+    start_warm_up();
+}
+
+void Asset_Repository::start_warm_up()
+{
+    stop_warm_up();
+    if (!m_shader_cache.is_enabled())
+    {
+        return;
+    }
+
+    auto warm_up = std::make_unique<Shader_Warm_Up>();
+    for (const auto& [shader_library, source] : m_shader_sources)
+    {
+        for (auto i = 0ull; i < shader_library->shaders.size(); ++i)
+        {
+            if (!shader_library->shaders[i].blob)
+            {
+                warm_up->jobs.push_back({ .source = source, .define_list_index = i });
+            }
+        }
+    }
+    if (warm_up->jobs.empty())
+    {
+        return;
+    }
+
+    // Libraries that already switched variants are the most likely to request another one, they go first.
+    ankerl::unordered_dense::set<std::string> used_libraries;
+    for (const auto* variants : { &m_used_variants, &m_session_variants })
+    {
+        for (const auto& variant : *variants)
+        {
+            used_libraries.insert(variant.substr(0, variant.find('/')));
+        }
+    }
+    std::ranges::stable_partition(warm_up->jobs, [&](const Shader_Warm_Up::Job& job)
+    {
+        return used_libraries.contains(job.source->name + "." + job.source->shader_type_string);
+    });
+
+    // Only fills the shader cache, the blobs are created when the variant is requested.
+    warm_up->include_dirs = get_shader_include_dirs();
+    warm_up->task = std::make_unique<enki::TaskSet>(static_cast<uint32_t>(warm_up->jobs.size()),
+        [this, warm_up = warm_up.get()](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            for (auto i = range.start; i < range.end; ++i)
+            {
+                if (warm_up->is_cancelled.load(std::memory_order_relaxed))
                 {
-                    shader = shader_lib->shaders[0].blob;
-                    variant_name = shader_lib->shaders[0].name;
+                    return;
                 }
-                return std::make_pair(m_shader_library_ptrs[name], variant_name);
+                const auto& job = warm_up->jobs[i];
+                (void) compile_permutation(*job.source, job.define_list_index, warm_up->include_dirs, thread_idx, false);
             }
+        });
+    warm_up->task->m_Priority = enki::TASK_PRIORITY_LOW;
+    m_task_scheduler.AddTaskSetToPipe(warm_up->task.get());
+    m_logger->info("Warming up {} deferred shader variants in the background.", warm_up->jobs.size());
+    m_warm_up = std::move(warm_up);
+}
+
+void Asset_Repository::stop_warm_up()
+{
+    if (!m_warm_up)
+    {
+        return;
+    }
+    m_warm_up->is_cancelled.store(true, std::memory_order_relaxed);
+    m_task_scheduler.WaitforTask(m_warm_up->task.get());
+    m_warm_up.reset();
+}
+
+const std::vector<Named_Shader>* Asset_Repository::get_reloaded_shaders(
+    const Shader_Reload& reload,
+    const std::string& name) const
+{
+    const auto it = m_shader_library_ptrs.find(Name(name));
+    if (it == m_shader_library_ptrs.end())
+    {
+        return nullptr;
+    }
+    if (const auto index = reload.source_indices.find(it->second); index != reload.source_indices.end())
+    {
+        return &reload.shaders[index->second];
+    }
+    return &it->second->shaders;
+}
+
+void Asset_Repository::retire_pipeline(rhi::Pipeline* pipeline)
+{
+    if (pipeline)
+    {
+        m_retired_pipelines.push_back({ .pipeline = pipeline, .frame = m_current_garbage_frame });
+    }
+}
+
+std::pair<std::string, Graphics_Pipeline_Library> Asset_Repository::build_graphics_pipeline_library(
+    const std::string& json_path,
+    const Graphics_Pipeline_Description& description,
+    const Shader_Reload& reload) const
+{
+    // TODO: add permutations?
+    bool is_mesh_shading = false;
+
+    rhi::Shader_Blob* ts = nullptr;
+    rhi::Shader_Blob* ms = nullptr;
+    rhi::Shader_Blob* vs = nullptr;
+    rhi::Shader_Blob* ps = nullptr;
+    std::array<uint64_t, 4> shader_hashes = {}; // ts, ms, vs, ps
+    const auto& blend_state_info = description.blend_state_info;
+    const auto primitive_topology = description.primitive_topology;
+    const auto& rasterizer_state_info = description.rasterizer_state_info;
+    const auto& depth_stencil_info = description.depth_stencil_info;
+    const auto& color_attachments = description.color_attachments;
+    const auto color_attachment_count = description.color_attachment_count;
+    const auto depth_stencil_format = description.depth_stencil_format;
+
+    auto set_shader = [&](auto& shader, uint64_t& shader_hash, const Pipeline_Shader_Description& shader_description)
+    {
+        if (shader_description.library.empty())
+        {
+            return std::make_pair(static_cast<Shader_Library*>(nullptr), std::string());
+        }
+        const auto& name = shader_description.library;
+        auto variant_name = shader_description.variant;
+        const auto* shaders = get_reloaded_shaders(reload, name);
+        if (!shaders || shaders->empty())
+        {
+            m_logger->error("Shader library '{}' does not exist.", name);
+            return std::make_pair(static_cast<Shader_Library*>(nullptr), std::string());
         }
-        return std::make_pair(static_cast<Shader_Library*>(nullptr), std::string());
+        const auto* named_shader = variant_name.empty()
+            ? &(*shaders)[0]
+            : find_shader(*shaders, variant_name);
+        if (named_shader)
+        {
+            shader = named_shader->blob;
+            shader_hash = named_shader->bytecode_hash;
+            variant_name = named_shader->name;
+        }
+        return std::make_pair(m_shader_library_ptrs.at(Name(name)), variant_name);
     };
 
-    auto [ts_lib, ts_variant] = set_shader(ts, "ts");
-    auto [ms_lib, ms_variant] = set_shader(ms, "ms");
-    auto [vs_lib, vs_variant] = set_shader(vs, "vs");
-    auto [ps_lib, ps_variant] = set_shader(ps, "ps");
-
-    blend_state_info.independent_blend_enable = pipeline_json.contains("independent_blend_enable")
-            ? pipeline_json["independent_blend_enable"].get<bool>()
-            : false;
-
-    if (pipeline_json.contains("color_attachments"))
-    {
-        for (const auto& color_attachment_json : pipeline_json["color_attachments"])
-        {
-            auto& ca_blend = blend_state_info.color_attachments[color_attachment_count];
-            ca_blend.blend_enable = color_attachment_json.contains("blend_enable")
-                ? color_attachment_json["blend_enable"].get<bool>()
-                : false;
-            ca_blend.logic_op_enable = color_attachment_json.contains("logic_op_enable")
-                ? color_attachment_json["logic_op_enable"].get<bool>()
-                : false;
-            ca_blend.color_src_blend = color_attachment_json.contains("color_src_blend")
-                ? rhi::blend_factor_from_string(color_attachment_json["color_src_blend"].get<std::string>())
-                : rhi::Blend_Factor::Zero;
-            ca_blend.color_dst_blend = color_attachment_json.contains("color_dst_blend")
-                ? rhi::blend_factor_from_string(color_attachment_json["color_dst_blend"].get<std::string>())
-                : rhi::Blend_Factor::Zero;
-            ca_blend.color_blend_op = color_attachment_json.contains("color_blend_op")
-                ? rhi::blend_op_from_string(color_attachment_json["color_blend_op"].get<std::string>())
-                : rhi::Blend_Op::Add;
-            ca_blend.alpha_src_blend = color_attachment_json.contains("alpha_src_blend")
-                ? rhi::blend_factor_from_string(color_attachment_json["alpha_src_blend"].get<std::string>())
-                : rhi::Blend_Factor::Zero;
-            ca_blend.alpha_dst_blend = color_attachment_json.contains("alpha_dst_blend")
-                ? rhi::blend_factor_from_string(color_attachment_json["alpha_dst_blend"].get<std::string>())
-                : rhi::Blend_Factor::Zero;
-            ca_blend.alpha_blend_op = color_attachment_json.contains("alpha_blend_op")
-                ? rhi::blend_op_from_string(color_attachment_json["alpha_blend_op"].get<std::string>())
-                : rhi::Blend_Op::Add;
-            ca_blend.logic_op = color_attachment_json.contains("logic_op")
-                ? rhi::logic_op_from_string(color_attachment_json["logic_op"].get<std::string>())
-                : rhi::Logic_Op::Clear;
-            ca_blend.color_write_mask = color_attachment_json.contains("color_write_mask")
-                ? rhi::color_component_from_string(color_attachment_json["color_write_mask"].get<std::string>())
-                : rhi::Color_Component::Enable_All;
-
-            auto& ca_format = color_attachments[color_attachment_count];
-            ca_format = color_attachment_json.contains("format")
-                ? rhi::get_image_format_info(color_attachment_json["format"].get<std::string>()).format
-                : rhi::Image_Format::Undefined;
-
-            color_attachment_count += 1;
-        }
-    }
-
-    if (pipeline_json.contains("depth_stencil"))
-    {
-        auto& depth_stencil_json = pipeline_json["depth_stencil"];
-
-        depth_stencil_format = depth_stencil_json.contains("format")
-            ? rhi::get_image_format_info(depth_stencil_json["format"].get<std::string>()).format
-            : rhi::Image_Format::Undefined;
-
-        depth_stencil_info.depth_enable = depth_stencil_json.contains("depth_enable")
-            ? depth_stencil_json["depth_enable"].get<bool>()
-            : false;
-        depth_stencil_info.depth_write_enable = depth_stencil_json.contains("depth_write_enable")
-            ? depth_stencil_json["depth_write_enable"].get<bool>()
-            : false;
-        depth_stencil_info.comparison_func = depth_stencil_json.contains("comparison_func")
-            ? rhi::comparison_func_from_string(depth_stencil_json["comparison_func"].get<std::string>())
-            : rhi::Comparison_Func::None;
-        depth_stencil_info.stencil_enable = depth_stencil_json.contains("stencil_enable")
-            ? depth_stencil_json["stencil_enable"].get<bool>()
-            : false;
-
-        auto set_stencil_info = [&](auto& stencil_face_info, const std::string_view stencil_info_str)
-        {
-            if (!depth_stencil_json.contains(stencil_info_str))
-                return;
-            auto& stencil_json = depth_stencil_json[stencil_info_str];
-            stencil_face_info.fail = depth_stencil_json.contains("fail")
-                ? rhi::stencil_op_from_string(stencil_json["fail"].get<std::string>())
-                : rhi::Stencil_Op::Keep;
-            stencil_face_info.depth_fail = depth_stencil_json.contains("depth_fail")
-                ? rhi::stencil_op_from_string(stencil_json["depth_fail"].get<std::string>())
-                : rhi::Stencil_Op::Keep;
-            stencil_face_info.pass = depth_stencil_json.contains("pass")
-                ? rhi::stencil_op_from_string(stencil_json["pass"].get<std::string>())
-                : rhi::Stencil_Op::Keep;
-            stencil_face_info.comparison_func = depth_stencil_json.contains("comparison_func")
-                ? rhi::comparison_func_from_string(depth_stencil_json["comparison_func"].get<std::string>())
-                : rhi::Comparison_Func::None;
-            stencil_face_info.stencil_read_mask = depth_stencil_json.contains("stencil_read_mask")
-                ? uint8_t(stencil_json["stencil_read_mask"].get<uint32_t>())
-                : 0;
-            stencil_face_info.stencil_write_mask = depth_stencil_json.contains("stencil_write_mask")
-                ? uint8_t(stencil_json["stencil_write_mask"].get<uint32_t>())
-                : 0;
-        };
-        set_stencil_info(depth_stencil_info.stencil_front_face, "stencil_front_face");
-        set_stencil_info(depth_stencil_info.stencil_back_face, "stencil_back_face");
-
-        depth_stencil_info.depth_bounds_test_mode = depth_stencil_json.contains("depth_bounds_test_mode")
-            ? rhi::depth_bounds_test_mode_from_string(depth_stencil_json["depth_bounds_test_mode"].get<std::string>())
-            : rhi::Depth_Bounds_Test_Mode::Disabled;
-        depth_stencil_info.depth_bounds_min = depth_stencil_json.contains("depth_bounds_min")
-            ? depth_stencil_json["depth_bounds_min"].get<float>()
-            : 0.f;
-        depth_stencil_info.depth_bounds_max = depth_stencil_json.contains("depth_bounds_max")
-            ? depth_stencil_json["depth_bounds_max"].get<float>()
-            : 0.f;
-    }
-
-    if (pipeline_json.contains("rasterizer_state"))
-    {
-        auto& rasterizer_json = pipeline_json["rasterizer_state"];;
-        rasterizer_state_info.fill_mode = rasterizer_json.contains("wireframe")
-            ? static_cast<rhi::Fill_Mode>(rasterizer_json["wireframe"].get<bool>())
-            : rhi::Fill_Mode::Solid;
-        rasterizer_state_info.cull_mode = rasterizer_json.contains("cull_mode")
-            ? rhi::cull_mode_from_string(rasterizer_json["cull_mode"].get<std::string>())
-            : rhi::Cull_Mode::None;
-        rasterizer_state_info.winding_order = rasterizer_json.contains("front_face_cw")
-            ? static_cast<rhi::Winding_Order>(rasterizer_json["front_face_cw"].get<bool>())
-            : rhi::Winding_Order::Front_Face_CCW;
-        rasterizer_state_info.depth_bias = rasterizer_json.contains("depth_bias")
-            ? rasterizer_json["depth_bias"].get<float>()
-            : 0.f;
-        rasterizer_state_info.depth_bias_clamp = rasterizer_json.contains("depth_bias_clamp")
-            ? rasterizer_json["depth_bias_clamp"].get<float>()
-            : 0.f;
-        rasterizer_state_info.depth_bias_slope_scale = rasterizer_json.contains("depth_bias_slope_scale")
-            ? rasterizer_json["depth_bias_slope_scale"].get<float>()
-            : 0.f;
-        rasterizer_state_info.depth_clip_enable = rasterizer_json.contains("depth_clip_enable")
-            ? rasterizer_json["depth_clip_enable"].get<bool>()
-            : true;
-    }
-
-    primitive_topology = pipeline_json.contains("primitive_topology")
-        ? rhi::primitive_topology_from_string(pipeline_json["primitive_topology"].get<std::string>())
-        : rhi::Primitive_Topology_Type::Triangle;
+    auto [ts_lib, ts_variant] = set_shader(ts, shader_hashes[0], description.ts);
+    auto [ms_lib, ms_variant] = set_shader(ms, shader_hashes[1], description.ms);
+    auto [vs_lib, vs_variant] = set_shader(vs, shader_hashes[2], description.vs);
+    auto [ps_lib, ps_variant] = set_shader(ps, shader_hashes[3], description.ps);
+    const auto pipeline_key = Pipeline_Cache::compute_key(shader_hashes, description.source_hash);
 
     rhi::Pipeline* pipeline = nullptr;
     if (is_mesh_shading)
@@ -625,11 +1175,11 @@ void Asset_Repository::compile_graphics_pipeline_library(const std::string_view&
             .color_attachment_formats = color_attachments,
             .depth_stencil_format = depth_stencil_format
         };
-        auto pipeline_result = m_graphics_device->create_pipeline(create_info);
+        auto pipeline_result = m_pipeline_cache->create_pipeline(pipeline_key, create_info);
         pipeline = pipeline_result.value_or(nullptr);
         if (!pipeline_result.has_value())
         {
-            m_logger->error("Failed to create graphics pipeline '{}'.", std::string(json_path));
+            m_logger->error("Failed to create graphics pipeline '{}'.", json_path);
             switch (pipeline_result.error())
             {
             case rhi::Result::Error_Out_Of_Memory:
@@ -660,11 +1210,11 @@ void Asset_Repository::compile_graphics_pipeline_library(const std::string_view&
             .color_attachment_formats = color_attachments,
             .depth_stencil_format = depth_stencil_format
         };
-        auto pipeline_result = m_graphics_device->create_pipeline(create_info);
+        auto pipeline_result = m_pipeline_cache->create_pipeline(pipeline_key, create_info);
         pipeline = pipeline_result.value_or(nullptr);
         if (!pipeline_result.has_value())
         {
-            m_logger->error("Failed to create graphics pipeline '{}'.", std::string(json_path));
+            m_logger->error("Failed to create graphics pipeline '{}'.", json_path);
             switch (pipeline_result.error())
             {
             case rhi::Result::Error_Out_Of_Memory:
@@ -682,35 +1232,18 @@ void Asset_Repository::compile_graphics_pipeline_library(const std::string_view&
         }
     }
 
-    auto name = pipeline_json["name"].get<std::string>();
-    if (!m_pipeline_library_ptrs.contains(name))
-    {
-        m_pipeline_library_ptrs[name] = &*m_pipeline_libraries.emplace();
-    }
-
-    auto& pipeline_library = *m_pipeline_library_ptrs[name];
-
-    // Bookkeeping
-    auto register_pipeline_to_shader_lib = [&pipeline_library](Shader_Library* shader_library)
-    {
-        if (shader_library)
-            shader_library->referenced_pipeline_libraries.push_back(&pipeline_library);
-    };
-
+    Graphics_Pipeline_Library pipeline_library = {};
     pipeline_library.pipeline = pipeline;
+    pipeline_library.json_path = json_path;
 
     pipeline_library.ts = ts_lib;
     pipeline_library.ts_variant = ts_variant;
-    register_pipeline_to_shader_lib(ts_lib);
     pipeline_library.ms = ms_lib;
     pipeline_library.ms_variant = ms_variant;
-    register_pipeline_to_shader_lib(ms_lib);
     pipeline_library.vs = vs_lib;
     pipeline_library.vs_variant = vs_variant;
-    register_pipeline_to_shader_lib(vs_lib);
     pipeline_library.ps = ps_lib;
     pipeline_library.ps_variant = ps_variant;
-    register_pipeline_to_shader_lib(ps_lib);
     pipeline_library.blend_state_info = blend_state_info;
     pipeline_library.primitive_topology = primitive_topology;
     pipeline_library.rasterizer_state_info = rasterizer_state_info;
@@ -719,176 +1252,53 @@ void Asset_Repository::compile_graphics_pipeline_library(const std::string_view&
     pipeline_library.color_attachment_count = color_attachment_count;
     pipeline_library.depth_stencil_format = depth_stencil_format;
 
-    m_logger->debug("Created graphics pipeline library '{}'", name);
+    return std::make_pair(description.name, std::move(pipeline_library));
 }
 
-void Asset_Repository::compile_ray_tracing_pipeline(const std::string_view& json_path)
+std::pair<std::string, Ray_Tracing_Pipeline_Library> Asset_Repository::build_ray_tracing_pipeline_library(
+    const std::string& json_path,
+    const Ray_Tracing_Pipeline_Description& description,
+    const Shader_Reload& reload) const
 {
-    // parse the json file
-    auto pipeline_json = nlohmann::json::parse(std::ifstream(std::string(json_path)));
-
-    auto translate_shader_type = [this](rhi::dxc::Shader_Type type)
-        {
-            switch (type)
-            {
-            case rhi::dxc::Shader_Type::Ray_Gen:
-                return rhi::Ray_Tracing_Shader_Type::Ray_Gen;
-            case rhi::dxc::Shader_Type::Ray_Any_Hit:
-                return rhi::Ray_Tracing_Shader_Type::Ray_Any_Hit;
-            case rhi::dxc::Shader_Type::Ray_Closest_Hit:
-                return rhi::Ray_Tracing_Shader_Type::Ray_Closest_Hit;
-            case rhi::dxc::Shader_Type::Ray_Miss:
-                return rhi::Ray_Tracing_Shader_Type::Ray_Miss;
-            case rhi::dxc::Shader_Type::Ray_Intersection:
-                return rhi::Ray_Tracing_Shader_Type::Ray_Intersection;
-            case rhi::dxc::Shader_Type::Ray_Callable:
-                return rhi::Ray_Tracing_Shader_Type::Ray_Callable;
-            default:
-                m_logger->warn("Invalid shader type for ray tracing pipeline.");
-                std::unreachable();
-            }
-        };
-
-    auto set_shader = [&](auto& shader_json, rhi::Ray_Tracing_Shader_Type& type, auto& shader)
-        {
-            std::string name = "";
-            std::string variant = "";
-            if (shader_json.contains("name"))
-            {
-                name = shader_json["name"].get<std::string>();
-            }
-            else
-            {
-                m_logger->warn("Shader missing name.");
-            }
-            if (shader_json.contains("type"))
-            {
-                type = translate_shader_type(shader_type_from_string(shader_json["type"].get<std::string>()));
-            }
-            else
-            {
-                m_logger->warn("Shader missing type.");
-            }
-            if (shader_json.contains("variant"))
-            {
-                variant = shader_json["variant"].get<std::string>();
-            }
-
-            if (!m_shader_library_ptrs.contains(name))
-            {
-                m_logger->error("Shader library '{}' does not exist.", name);
-                return std::make_pair(static_cast<Shader_Library*>(nullptr), std::string());
-            }
-
-            const auto shader_lib = m_shader_library_ptrs[name];
-            if (!variant.empty())
-            {
-                shader = shader_lib->get_shader(variant);
-            }
-            else
-            {
-                shader = shader_lib->shaders[0].blob;
-                variant = shader_lib->shaders[0].name;
-            }
-            return std::make_pair(m_shader_library_ptrs[name], variant);
-        };
-
-    auto name = pipeline_json["name"].get<std::string>();
-    if (!m_ray_tracing_pipeline_library_ptrs.contains(name))
-    {
-        m_ray_tracing_pipeline_library_ptrs[name] = &*m_ray_tracing_pipeline_libraries.emplace();
-    }
-
     std::vector<Ray_Tracing_Shader_Ref> shader_refs;
     std::vector<rhi::Ray_Tracing_Shader> shaders;
-    if (pipeline_json.contains("shaders"))
-    {
-        shaders.reserve(pipeline_json.count("shaders"));
-        shader_refs.reserve(pipeline_json.count("shaders"));
-        for (const auto& shader_json : pipeline_json["shaders"])
-        {
-            auto& shader = shaders.emplace_back();
-            const auto& shader_ref = set_shader(shader_json, shader.type, shader.blob);
-            shader_refs.push_back({ .lib = shader_ref.first, .variant = shader_ref.second });
-        }
-    }
-
-    std::vector<uint32_t> ray_gen_shaders;
-    if (pipeline_json.contains("ray_gen"))
-    {
-        for (const auto& ray_gen_json : pipeline_json["ray_gen"])
-        {
-            ray_gen_shaders.push_back(static_cast<uint32_t>(ray_gen_json.get<int32_t>()));
-        }
-    }
-
-    std::vector<rhi::Ray_Tracing_Hit_Group> hit_groups;
-    if (pipeline_json.contains("hit_groups"))
+    std::vector<uint64_t> shader_hashes(description.shaders.size());
+    shaders.reserve(description.shaders.size());
+    shader_refs.reserve(description.shaders.size());
+    for (const auto& shader_description : description.shaders)
     {
-        for (const auto& hit_group_json : pipeline_json["hit_groups"])
+        auto& shader = shaders.emplace_back();
+        shader.type = shader_description.type;
+        shader.blob = nullptr;
+
+        const auto& name = shader_description.shader.library;
+        auto variant = shader_description.shader.variant;
+        const auto* named_shaders = get_reloaded_shaders(reload, name);
+        if (!named_shaders || named_shaders->empty())
         {
-            auto& hit_group = hit_groups.emplace_back();
-
-            auto hit_group_type = rhi::Ray_Tracing_Hit_Group_Type::Triangles;
-            if (hit_group_json.contains("type"))
-            {
-                auto type_string = hit_group_json["type"].get<std::string>();
-                if (type_string == "triangles")
-                {
-                    hit_group_type = rhi::Ray_Tracing_Hit_Group_Type::Triangles;
-                }
-                else if (type_string == "procedural")
-                {
-                    hit_group_type = rhi::Ray_Tracing_Hit_Group_Type::Procedural;
-                }
-                else
-                {
-                    m_logger->warn("Invalid ray tracing hit group type.");
-                }
-            }
-
-            hit_group = {
-                .type = hit_group_type,
-                .closest_hit = hit_group_json.contains("closest_hit")
-                    ? static_cast<uint32_t>(hit_group_json["closest_hit"].get<int32_t>())
-                    : rhi::RT_PIPELINE_NO_SHADER,
-                .any_hit = hit_group_json.contains("any_hit")
-                    ? static_cast<uint32_t>(hit_group_json["any_hit"].get<int32_t>())
-                    : rhi::RT_PIPELINE_NO_SHADER,
-                .intersection = hit_group_json.contains("intersection")
-                    ? static_cast<uint32_t>(hit_group_json["intersection"].get<int32_t>())
-                    : rhi::RT_PIPELINE_NO_SHADER
-            };
-        }
-    }
-
-    std::vector<uint32_t> miss_shaders;
-    if (pipeline_json.contains("miss"))
-    {
-        for (const auto& miss_json : pipeline_json["miss"])
-        {
-            miss_shaders.push_back(static_cast<uint32_t>(miss_json.get<int32_t>()));
+            m_logger->error("Shader library '{}' does not exist.", name);
+            shader_refs.push_back({ .lib = nullptr, .variant = std::string() });
+            continue;
         }
-    }
-
-    std::vector<uint32_t> callable_shaders;
-    if (pipeline_json.contains("callable"))
-    {
-        for (const auto& callable_json : pipeline_json["callable"])
+        const auto* named_shader = variant.empty()
+            ? &(*named_shaders)[0]
+            : find_shader(*named_shaders, variant);
+        if (named_shader)
         {
-            callable_shaders.push_back(static_cast<uint32_t>(callable_json.get<int32_t>()));
+            shader.blob = named_shader->blob;
+            shader_hashes[shaders.size() - 1] = named_shader->bytecode_hash;
+            variant = named_shader->name;
         }
+        shader_refs.push_back({ .lib = m_shader_library_ptrs.at(Name(name)), .variant = variant });
     }
 
-    uint32_t max_recursion_depth = pipeline_json.contains("max_recursion_depth")
-        ? static_cast<uint32_t>(pipeline_json["max_recursion_depth"].get<int32_t>())
-        : 1u;
-    uint32_t max_payload_size = pipeline_json.contains("max_payload_size")
-        ? static_cast<uint32_t>(pipeline_json["max_payload_size"].get<int32_t>())
-        : 32u;
-    uint32_t max_attribute_size = pipeline_json.contains("max_attribute_size")
-        ? static_cast<uint32_t>(pipeline_json["max_attribute_size"].get<int32_t>())
-        : 16u;
+    auto hit_groups = description.hit_groups;
+    auto ray_gen_shaders = description.ray_gen_libraries;
+    auto miss_shaders = description.miss_libraries;
+    auto callable_shaders = description.callable_libraries;
+    const auto max_recursion_depth = description.max_recursion_depth;
+    const auto max_payload_size = description.max_payload_size;
+    const auto max_attribute_size = description.max_attribute_size;
 
     rhi::Ray_Tracing_Pipeline_Create_Info create_info = {
         .shaders = shaders,
@@ -900,11 +1310,12 @@ void Asset_Repository::compile_ray_tracing_pipeline(const std::string_view& json
         .max_payload_size = max_payload_size,
         .max_attribute_size = max_attribute_size
     };
-    auto pipeline_result = m_graphics_device->create_pipeline(create_info);
+    const auto pipeline_key = Pipeline_Cache::compute_key(shader_hashes, description.source_hash);
+    auto pipeline_result = m_pipeline_cache->create_pipeline(pipeline_key, create_info);
     auto pipeline = pipeline_result.value_or(nullptr);
     if (!pipeline_result.has_value())
     {
-        m_logger->error("Failed to create ray tracing pipeline '{}'.", std::string(json_path));
+        m_logger->error("Failed to create ray tracing pipeline '{}'.", json_path);
         switch (pipeline_result.error())
         {
         case rhi::Result::Error_Out_Of_Memory:
@@ -921,8 +1332,7 @@ void Asset_Repository::compile_ray_tracing_pipeline(const std::string_view& json
         }
     }
 
-    auto& pipeline_library = *m_ray_tracing_pipeline_library_ptrs[name];
-
+    Ray_Tracing_Pipeline_Library pipeline_library = {};
     pipeline_library.shaders = shader_refs;
     pipeline_library.hit_groups = hit_groups;
     pipeline_library.ray_gen_libraries = ray_gen_shaders;
@@ -933,23 +1343,12 @@ void Asset_Repository::compile_ray_tracing_pipeline(const std::string_view& json
     pipeline_library.max_attribute_size = max_attribute_size;
 
     pipeline_library.pipeline = pipeline;
+    pipeline_library.json_path = json_path;
 
-    // Bookkeeping
-    auto register_pipeline_to_shader_lib = [&pipeline_library](Shader_Library* shader_library)
-        {
-            if (shader_library)
-                shader_library->referenced_ray_tracing_pipeline_libraries.push_back(&pipeline_library);
-        };
-
-    for (auto& shader_ref : pipeline_library.shaders)
-    {
-        register_pipeline_to_shader_lib(shader_ref.lib);
-    }
-
-    m_logger->debug("Created ray tracing pipeline library '{}'", name);
+    return std::make_pair(description.name, std::move(pipeline_library));
 }
 
-void Asset_Repository::create_shader_and_compute_libraries()
+std::vector<std::wstring> Asset_Repository::get_shader_include_dirs() const
 {
     std::vector<std::wstring> shader_include_dirs;
     shader_include_dirs.reserve(m_paths.shader_include_paths.size() + 1);
@@ -959,6 +1358,163 @@ void Asset_Repository::create_shader_and_compute_libraries()
         shader_include_dirs.emplace_back(
             shader_include_dirs[0] + std::wstring(shader_include_path.begin(), shader_include_path.end()));
     }
+    return shader_include_dirs;
+}
+
+void Asset_Repository::create_file_watches()
+{
+    std::vector<std::filesystem::path> directories;
+    directories.emplace_back(std::filesystem::weakly_canonical(m_paths.shaders));
+    directories.emplace_back(std::filesystem::weakly_canonical(m_paths.pipelines));
+    for (const auto& include_dir : get_shader_include_dirs())
+    {
+        directories.emplace_back(std::filesystem::weakly_canonical(include_dir));
+    }
+
+    // Directories inside of another watched directory are already covered by its recursive watch.
+    std::ranges::sort(directories, {}, [](const std::filesystem::path& path) { return path.native().size(); });
+    for (const auto& directory : directories)
+    {
+        const auto is_covered = std::ranges::any_of(m_watched_directories, [&](const Watched_Directory& watched)
+        {
+            const auto relative = directory.lexically_relative(watched.path);
+            return !relative.empty() && *relative.begin() != "..";
+        });
+        if (is_covered || !std::filesystem::is_directory(directory))
+        {
+            continue;
+        }
+        auto watch = File_Watch::create(directory);
+        if (!watch)
+        {
+            m_logger->error("Failed to watch '{}' for shader and pipeline changes: {}",
+                directory.string(), watch.error().message());
+            continue;
+        }
+        m_logger->info("Watching '{}' for shader and pipeline changes.", directory.string());
+        m_watched_directories.push_back({ .path = directory, .watch = std::move(*watch) });
+    }
+}
+
+bool Asset_Repository::poll_file_changes()
+{
+    auto is_relevant = [](const std::filesystem::path& path)
+    {
+        const auto extension = path.extension();
+        return extension == ".hlsl" || extension == ".hlsli" || extension == ".h" || extension == ".json";
+    };
+
+    for (auto& [directory, watch] : m_watched_directories)
+    {
+        for (const auto& notification : watch->poll_for_changes())
+        {
+            if (notification.type == File_Notification_Type::Invalid)
+            {
+                continue;
+            }
+            if (is_relevant(notification.path))
+            {
+                m_changed_files.insert(std::filesystem::weakly_canonical(directory / notification.path).string());
+            }
+            if (!notification.old_path.empty() && is_relevant(notification.old_path))
+            {
+                m_changed_files.insert(std::filesystem::weakly_canonical(directory / notification.old_path).string());
+            }
+        }
+    }
+    return !m_changed_files.empty();
+}
+
+void Asset_Repository::recompile_changed_shaders()
+{
+    if (is_reload_in_progress())
+    {
+        return;
+    }
+
+    const auto changed_files = std::move(m_changed_files);
+    m_changed_files = {};
+
+    // Collect every shader library including one of the changed files, as well as new HLSL files.
+    std::vector<std::string> hlsl_paths;
+    ankerl::unordered_dense::set<std::string> known_hlsl_paths;
+    for (const auto& [name, shader_library] : m_shader_library_ptrs)
+    {
+        known_hlsl_paths.insert(std::filesystem::weakly_canonical(shader_library->hlsl_path).string());
+        if (std::ranges::any_of(shader_library->dependencies,
+            [&](const std::string& dependency) { return changed_files.contains(dependency); }))
+        {
+            hlsl_paths.push_back(shader_library->hlsl_path);
+        }
+    }
+    std::vector<std::string> new_json_paths;
+    for (const auto& changed_file : changed_files)
+    {
+        const auto path = std::filesystem::path(changed_file);
+        if (!std::filesystem::exists(path))
+        {
+            continue;
+        }
+        if (path.extension() == ".hlsl" && !known_hlsl_paths.contains(changed_file))
+        {
+            hlsl_paths.push_back(changed_file);
+        }
+        else if (path.extension() == ".json")
+        {
+            new_json_paths.push_back(changed_file);
+        }
+    }
+    std::ranges::sort(hlsl_paths);
+    hlsl_paths.erase(std::ranges::unique(hlsl_paths).begin(), hlsl_paths.end());
+
+    // Pipelines are recreated if one of their shaders or their description changed.
+    ankerl::unordered_dense::set<std::string> graphics_json_paths;
+    ankerl::unordered_dense::set<std::string> ray_tracing_json_paths;
+    for (const auto& [name, shader_library] : m_shader_library_ptrs)
+    {
+        if (!std::ranges::binary_search(hlsl_paths, shader_library->hlsl_path))
+        {
+            continue;
+        }
+        for (const auto* pipeline_library : shader_library->referenced_pipeline_libraries)
+        {
+            graphics_json_paths.insert(std::filesystem::weakly_canonical(pipeline_library->json_path).string());
+        }
+        for (const auto* pipeline_library : shader_library->referenced_ray_tracing_pipeline_libraries)
+        {
+            ray_tracing_json_paths.insert(std::filesystem::weakly_canonical(pipeline_library->json_path).string());
+        }
+    }
+    for (const auto& json_path : new_json_paths)
+    {
+        // Same classification as the full creation, which also goes by the path.
+        if (json_path.contains("ray_tracing"))
+        {
+            ray_tracing_json_paths.insert(json_path);
+        }
+        else
+        {
+            graphics_json_paths.insert(json_path);
+        }
+    }
+
+    for (const auto& hlsl_path : hlsl_paths)
+    {
+        m_logger->info("Recompiling shader library '{}'", hlsl_path);
+    }
+    for (const auto& json_path : graphics_json_paths)
+    {
+        m_logger->info("Recreating graphics pipeline library '{}'", json_path);
+    }
+    for (const auto& json_path : ray_tracing_json_paths)
+    {
+        m_logger->info("Recreating ray tracing pipeline library '{}'", json_path);
+    }
+    start_reload(hlsl_paths, graphics_json_paths.extract(), ray_tracing_json_paths.extract());
+}
+
+std::vector<std::string> Asset_Repository::get_hlsl_paths() const
+{
     ankerl::unordered_dense::set<std::string> shader_set;
     for (const auto& shader_path : std::filesystem::recursive_directory_iterator(std::filesystem::path(m_paths.shaders)))
     {
@@ -970,65 +1526,102 @@ void Asset_Repository::create_shader_and_compute_libraries()
             shader_set.insert(full_path);
         }
     }
+    std::vector<std::string> hlsl_paths;
+    hlsl_paths.reserve(shader_set.size());
     for (const auto& shader : shader_set)
     {
-        m_logger->debug("Processing shader {}", shader);
         auto hlsl_path = std::string(shader) + ".hlsl";
 
         if (!std::filesystem::exists(hlsl_path))
         {
             continue;
         }
-        compile_shader_library(hlsl_path, shader_include_dirs);
+        hlsl_paths.push_back(std::move(hlsl_path));
     }
+    return hlsl_paths;
 }
 
-void Asset_Repository::create_graphics_pipeline_libraries()
+std::vector<std::string> Asset_Repository::get_pipeline_json_paths(const bool ray_tracing) const
 {
-    ankerl::unordered_dense::set<std::string> graphics_pipeline_library_set;
-    for (const auto& graphics_pipeline_library_path : std::filesystem::recursive_directory_iterator(std::filesystem::path(m_paths.pipelines)))
+    ankerl::unordered_dense::set<std::string> pipeline_library_set;
+    for (const auto& pipeline_library_path : std::filesystem::recursive_directory_iterator(std::filesystem::path(m_paths.pipelines)))
     {
-        const auto& path = graphics_pipeline_library_path.path();
+        const auto& path = pipeline_library_path.path();
         auto extension = path.extension();
         if (extension == ".json")
         {
             auto full_path = (path.parent_path() / path.filename()).string();
-            if (full_path.contains("ray_tracing"))
+            if (full_path.contains("ray_tracing") != ray_tracing)
             {
                 continue;
             }
-            graphics_pipeline_library_set.insert(full_path);
+            pipeline_library_set.insert(full_path);
         }
     }
-    for (const auto& graphics_pipeline_library : graphics_pipeline_library_set)
+    return pipeline_library_set.extract();
+}
+
+void Asset_Repository::load_session_variants()
+{
+    const auto path = std::filesystem::path(m_paths.shader_cache) / SHADER_SESSION_FILE_NAME;
+    std::ifstream file(path);
+    if (!file)
+    {
+        return;
+    }
+    const auto session_json = nlohmann::json::parse(file, nullptr, false);
+    if (session_json.is_discarded() || !session_json.contains("variants") || !session_json["variants"].is_array())
+    {
+        m_logger->warn("Ignoring invalid shader session file '{}'.", path.string());
+        return;
+    }
+    for (const auto& variant : session_json["variants"])
     {
-        m_logger->debug("Processing graphics pipeline library '{}'", graphics_pipeline_library);
-        compile_graphics_pipeline_library(graphics_pipeline_library);
+        m_session_variants.insert(variant.get<std::string>());
     }
+    m_logger->info("{} shader variants were used in the last session.", m_session_variants.size());
 }
 
-void Asset_Repository::create_ray_tracing_pipeline_libraries()
+void Asset_Repository::save_session_variants() const
 {
-    ankerl::unordered_dense::set<std::string> ray_tracing_pipeline_library_set;
-    for (const auto& ray_tracing_pipeline_library_path : std::filesystem::recursive_directory_iterator(std::filesystem::path(m_paths.pipelines)))
+    if (!m_shader_cache.is_enabled())
     {
-        const auto& path = ray_tracing_pipeline_library_path.path();
-        auto extension = path.extension();
-        if (extension == ".json")
-        {
-            auto full_path = (path.parent_path() / path.filename()).string();
-            if (!full_path.contains("ray_tracing"))
-            {
-                continue;
-            }
-            ray_tracing_pipeline_library_set.insert(full_path);
-        }
+        return;
     }
-    for (const auto& ray_tracing_pipeline_library : ray_tracing_pipeline_library_set)
+    std::vector<std::string> variants(m_used_variants.begin(), m_used_variants.end());
+    std::ranges::sort(variants);
+    const nlohmann::json session_json = {
+        { "version", 1 },
+        { "variants", variants }
+    };
+
+    const auto path = std::filesystem::path(m_paths.shader_cache) / SHADER_SESSION_FILE_NAME;
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file)
     {
-        m_logger->debug("Processing ray tracing pipeline library '{}'", ray_tracing_pipeline_library);
-        compile_ray_tracing_pipeline(ray_tracing_pipeline_library);
+        m_logger->warn("Failed to write shader session file '{}'.", path.string());
+        return;
     }
+    file << session_json.dump(4);
+}
+
+void Asset_Repository::register_file(String_Map<Asset_File*>& files, const std::filesystem::path& path,
+    const Mapped_File_Options& options)
+{
+    const auto identifier = path.filename().string();
+    if (!files.contains(identifier))
+    {
+        files[identifier] = &*m_files.emplace(Asset_File {});
+    }
+    auto& file = *files.at(identifier);
+    if (file.data)
+    {
+        m_mapped_file_usage.remove(file.size);
+        file.unmap();
+    }
+    file = {};
+    file.path = path.string();
+    file.options = options;
 }
 
 void Asset_Repository::register_textures()
@@ -1046,8 +1639,13 @@ void Asset_Repository::register_textures()
 
 void Asset_Repository::register_texture(const std::filesystem::path& path)
 {
+    // Textures are read front to back when they are uploaded, large ones benefit from huge pages.
+    constexpr static Mapped_File_Options options = {
+        .access_pattern = Mapped_File_Access_Pattern::Sequential,
+        .huge_pages = true
+    };
     Mapped_File mapped_file = {};
-    mapped_file.map(path.string().c_str());
+    mapped_file.map(path.string().c_str(), options);
     if (!mapped_file.data)
     {
         m_logger->error("Failed to open file '{}'", path.string());
@@ -1061,13 +1659,8 @@ void Asset_Repository::register_texture(const std::filesystem::path& path)
         return;
     }
 
-    const auto texture_identifier = path.filename().string();
-    if (!m_texture_ptrs.contains(texture_identifier))
-    {
-        m_texture_ptrs[texture_identifier] = &*m_files.emplace();
-    }
-    auto& texture = *m_texture_ptrs.at(texture_identifier);
-    texture = mapped_file;
+    mapped_file.unmap();
+    register_file(m_texture_ptrs, path, options);
     m_logger->debug("Registered texture '{}'", path.string());
 }
 
@@ -1101,13 +1694,43 @@ void Asset_Repository::register_model(const std::filesystem::path& path)
         return;
     }
 
-    const auto model_identifier = path.filename().string();
-    if (!m_model_ptrs.contains(model_identifier))
+    mapped_file.unmap();
+    register_file(m_model_ptrs, path, {});
+    m_logger->debug("Registered model '{}'", path.string());
+}
+
+void Asset_Repository::register_animations()
+{
+    auto directory = std::filesystem::path(m_paths.models);
+    for (auto& directory_entry : std::filesystem::recursive_directory_iterator(directory))
     {
-        m_model_ptrs[model_identifier] = &*m_files.emplace();
+        if (directory_entry.path().extension() == serialization::ANIMATION_FILE_EXTENSION)
+        {
+            m_logger->debug("Registering animation '{}'", directory_entry.path().string());
+            register_animation(directory_entry.path());
+        }
     }
-    auto& model = *m_model_ptrs.at(model_identifier);
-    model = mapped_file;
-    m_logger->debug("Registered model '{}'", path.string());
+}
+
+void Asset_Repository::register_animation(const std::filesystem::path& path)
+{
+    Mapped_File mapped_file = {};
+    mapped_file.map(path.string().c_str());
+    if (!mapped_file.data)
+    {
+        m_logger->error("Failed to open file '{}'", path.string());
+        return;
+    }
+
+    if (auto* file_header = static_cast<serialization::Animation_Header*>(mapped_file.data); !file_header->validate())
+    {
+        m_logger->error("Failed to validate animation '{}'", path.string());
+        mapped_file.unmap();
+        return;
+    }
+
+    mapped_file.unmap();
+    register_file(m_animation_ptrs, path, {});
+    m_logger->debug("Registered animation '{}'", path.string());
 }
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <filesystem>
+#include <mutex>
 #include <ankerl/unordered_dense.h>
 #include <plf_colony.h>
 
@@ -7,7 +8,13 @@
 #include "renderer/asset/compute_library.hpp"
 #include "renderer/asset/graphics_pipeline_library.hpp"
 #include "renderer/logger.hpp"
+#include "renderer/memory_usage.hpp"
+#include "renderer/name.hpp"
 #include "renderer/asset/pipeline.hpp"
+#include "renderer/asset/pipeline_cache.hpp"
+#include "renderer/asset/pipeline_description.hpp"
+#include "renderer/asset/shader_cache.hpp"
+#include "renderer/filesystem/file_watch.hpp"
 #include "renderer/filesystem/mapped_file.hpp"
 
 namespace rhi
@@ -15,6 +22,11 @@ namespace rhi
     class Graphics_Device;
 }
 
+namespace enki
+{
+    class TaskScheduler;
+}
+
 namespace ren
 {
 struct Asset_Repository_Paths
@@ -23,6 +35,8 @@ struct Asset_Repository_Paths
     std::string pipelines;
     std::vector<std::string> shader_include_paths;
     std::string models;
+    std::string shader_cache;
+    std::string pipeline_cache;
 };
 
 class Application;
@@ -30,33 +44,121 @@ class Application;
 class Asset_Repository
 {
 public:
+    // Shaders are compiled on the workers of `task_scheduler`. Reloads also create their shader blobs and pipelines
+    // on a worker, the repository serializes its own device calls instead of requiring a locked device.
+    // Pipelines are created through `pipeline_cache_device`, which defaults to forwarding to `graphics_device`.
     Asset_Repository(std::shared_ptr<Logger> logger, rhi::Graphics_Device* graphics_device,
-        Asset_Repository_Paths&& paths);
+        enki::TaskScheduler& task_scheduler,
+        Asset_Repository_Paths&& paths,
+        std::unique_ptr<Pipeline_Cache_Device> pipeline_cache_device = nullptr);
     ~Asset_Repository();
 
-    [[nodiscard]] rhi::Shader_Blob* get_shader_blob(const std::string_view& name, const std::string_view& variant) const;
-    [[nodiscard]] rhi::Shader_Blob* get_shader_blob(const std::string_view& name) const;
-    [[nodiscard]] Compute_Pipeline get_compute_pipeline(const std::string_view& name) const;
-    [[nodiscard]] Graphics_Pipeline get_graphics_pipeline(const std::string_view& name) const;
-    [[nodiscard]] Ray_Tracing_Pipeline get_ray_tracing_pipeline(const std::string_view& name) const;
-    [[nodiscard]] Mapped_File* get_model(const std::string_view& name) const;
-    [[nodiscard]] Mapped_File* get_texture(const std::string_view& name) const;
-    [[nodiscard]] Mapped_File* get_texture_safe(const std::string_view& name) const;
+    // Compiles the variant on the calling thread if it was not compiled up front.
+    [[nodiscard]] rhi::Shader_Blob* get_shader_blob(Name name, Name variant);
+    [[nodiscard]] rhi::Shader_Blob* get_shader_blob(Name name) const;
+    [[nodiscard]] Compute_Pipeline get_compute_pipeline(Name name) const;
+    [[nodiscard]] Graphics_Pipeline get_graphics_pipeline(Name name) const;
+    [[nodiscard]] Ray_Tracing_Pipeline get_ray_tracing_pipeline(Name name) const;
+    // Asset files are mapped on use and unmapped by `garbage_collect` once they are the least recently used
+    // while the mapped bytes exceed the budget. The returned pointers stay valid, only their data is remapped.
+    // Must be called on the main thread.
+    [[nodiscard]] Mapped_File* get_model(const std::string_view& name);
+    [[nodiscard]] Mapped_File* get_texture(const std::string_view& name);
+    [[nodiscard]] Mapped_File* get_texture_safe(const std::string_view& name);
+    [[nodiscard]] Mapped_File* get_animation_safe(const std::string_view& name);
     [[nodiscard]] std::vector<std::string> get_model_files() const;
-
+    // Pinned files stay mapped, e.g. while workers read them.
+    void pin_file(Mapped_File* file);
+    void unpin_file(Mapped_File* file);
+    void set_mapped_file_budget(std::size_t bytes) noexcept { m_mapped_file_budget = bytes; }
+    [[nodiscard]] std::size_t get_mapped_file_budget() const noexcept { return m_mapped_file_budget; }
+    [[nodiscard]] const Memory_Usage& get_mapped_file_usage() const noexcept { return m_mapped_file_usage; }
+
+    // Starts recompiling all shaders and pipelines in the background.
     void recompile_shaders();
 
-private:
-    void compile_shader_library(
-        std::string_view hlsl_path,
-        const std::vector<std::wstring>& include_dirs);
+    // Polls the watched shader and pipeline directories. Returns true if anything has to be recompiled.
+    [[nodiscard]] bool poll_file_changes();
+    // Starts recompiling only the shader libraries that include a changed file and the pipelines depending on them.
+    void recompile_changed_shaders();
+
+    [[nodiscard]] bool is_reload_in_progress() const;
+    // Swaps in the results of a finished reload. Must be called between frames, replaced pipelines are
+    // destroyed by `garbage_collect` once no frame in flight can use them anymore. Returns true if anything was swapped.
+    bool apply_finished_reload();
+    void wait_for_reload();
+    void garbage_collect(uint64_t frame);
 
-    void compile_graphics_pipeline_library(const std::string_view& json_path);
-    void compile_ray_tracing_pipeline(const std::string_view& json_path);
+    // Called by `Compute_Pipeline::set_variant` on the first request of a variant.
+    // Creates the pipeline if the variant was not compiled up front and records the variant for the next session.
+    void request_compute_variant(Compute_Library& compute_library, Compute_Pipeline_Wrapper& wrapper);
 
-    void create_shader_and_compute_libraries();
-    void create_graphics_pipeline_libraries();
-    void create_ray_tracing_pipeline_libraries();
+private:
+    struct Asset_File : Mapped_File
+    {
+        std::string path;
+        Mapped_File_Options options;
+        uint64_t last_use_frame;
+        uint32_t pin_count;
+    };
+
+    struct Shader_Library_Source;
+    struct Shader_Reload;
+    struct Shader_Warm_Up;
+
+    Shader_Library_Source parse_shader_library(std::string_view hlsl_path);
+    // Loads the permutation from the shader cache or compiles it with the compiler of `thread_idx`.
+    // If `load_cached` is false a cached permutation is not read and an empty entry is returned instead.
+    Shader_Cache_Entry compile_permutation(
+        const Shader_Library_Source& source,
+        std::size_t define_list_index,
+        const std::vector<std::wstring>& include_dirs,
+        uint32_t thread_idx,
+        bool load_cached,
+        bool* is_cache_hit = nullptr);
+    void create_shader_blob(const Shader_Cache_Entry& compiled_shader, Named_Shader& shader) const;
+    rhi::Shader_Blob* request_shader_variant(Shader_Library& shader_library, std::size_t variant_index);
+
+    void start_reload(
+        const std::vector<std::string>& hlsl_paths,
+        std::vector<std::string>&& graphics_json_paths,
+        std::vector<std::string>&& ray_tracing_json_paths);
+    // Compiles all permutations of all sources in parallel and merges them back in the order of the sources.
+    void compile_reload(Shader_Reload& reload);
+    // Creates shader blobs and pipelines on the reload worker, one device call at a time.
+    void create_reload_objects(Shader_Reload& reload);
+    void commit_reload(Shader_Reload& reload);
+    // Compiles the deferred variants of the committed libraries into the shader cache at low priority.
+    void start_warm_up();
+    void stop_warm_up();
+    // Shaders of a library as they will be after `reload` is committed.
+    [[nodiscard]] const std::vector<Named_Shader>* get_reloaded_shaders(
+        const Shader_Reload& reload,
+        const std::string& name) const;
+    void retire_pipeline(rhi::Pipeline* pipeline);
+
+    [[nodiscard]] std::pair<std::string, Graphics_Pipeline_Library> build_graphics_pipeline_library(
+        const std::string& json_path,
+        const Graphics_Pipeline_Description& description,
+        const Shader_Reload& reload) const;
+    [[nodiscard]] std::pair<std::string, Ray_Tracing_Pipeline_Library> build_ray_tracing_pipeline_library(
+        const std::string& json_path,
+        const Ray_Tracing_Pipeline_Description& description,
+        const Shader_Reload& reload) const;
+
+    [[nodiscard]] std::vector<std::wstring> get_shader_include_dirs() const;
+    void create_file_watches();
+
+    [[nodiscard]] std::vector<std::string> get_hlsl_paths() const;
+    [[nodiscard]] std::vector<std::string> get_pipeline_json_paths(bool ray_tracing) const;
+
+    void load_session_variants();
+    void save_session_variants() const;
+
+    // Validated files are registered unmapped, they are mapped on first use.
+    void register_file(String_Map<Asset_File*>& files, const std::filesystem::path& path, const Mapped_File_Options& options);
+    Asset_File* use_file(Asset_File* file);
+    void evict_mapped_files();
 
     void register_textures();
     void register_texture(const std::filesystem::path& path);
@@ -64,33 +166,72 @@ private:
     void register_models();
     void register_model(const std::filesystem::path& path);
 
+    void register_animations();
+    void register_animation(const std::filesystem::path& path);
+
 private:
     std::shared_ptr<Logger> m_logger;
     rhi::Graphics_Device* m_graphics_device;
+    enki::TaskScheduler& m_task_scheduler;
+    // Held for each shader blob and pipeline the repository creates or destroys, the device is not locked
+    // and reload workers create them while the frame is recorded.
+    mutable std::mutex m_device_object_mutex;
     Asset_Repository_Paths m_paths;
 
     class Shader_Compiler;
-    std::unique_ptr<Shader_Compiler> m_shader_compiler;
+    std::vector<std::unique_ptr<Shader_Compiler>> m_shader_compilers; // One per task thread, created on demand
+    Shader_Cache m_shader_cache;
+    Pipeline_Description_Cache m_pipeline_description_cache;
+    std::unique_ptr<Pipeline_Cache> m_pipeline_cache;
+
+    // Sources of the committed libraries, deferred variants are compiled from them.
+    // Shared with the warm-up, which may still run when a reload replaces them.
+    ankerl::unordered_dense::map<const Shader_Library*, std::shared_ptr<const Shader_Library_Source>> m_shader_sources;
+    ankerl::unordered_dense::set<std::string> m_used_variants; // 'library/variant' requested in this session
+    ankerl::unordered_dense::set<std::string> m_session_variants; // 'library/variant' requested in the last session
+    std::unique_ptr<Shader_Warm_Up> m_warm_up;
+
+    std::unique_ptr<Shader_Reload> m_reload;
+    struct Retired_Pipeline
+    {
+        rhi::Pipeline* pipeline;
+        uint64_t frame;
+    };
+    std::vector<Retired_Pipeline> m_retired_pipelines;
+    uint64_t m_current_garbage_frame;
+
+    struct Watched_Directory
+    {
+        std::filesystem::path path;
+        std::unique_ptr<File_Watch> watch;
+    };
+    std::vector<Watched_Directory> m_watched_directories;
+    ankerl::unordered_dense::set<std::string> m_changed_files; // Canonical paths
 
     template<typename T>
     using String_Map = ankerl::unordered_dense::map<std::string, T>;
 
     // ankerl is fast but has unstable pointers on insert
     // Because of that the maps are not directly storing the data
-    String_Map<Shader_Library*> m_shader_library_ptrs = {};
+    // Shaders and pipelines are looked up every frame, so they are keyed by interned names.
+    Name_Map<Shader_Library*> m_shader_library_ptrs = {};
     plf::colony<Shader_Library> m_shader_libraries = {};
 
-    String_Map<Compute_Library*> m_compute_library_ptrs = {};
+    Name_Map<Compute_Library*> m_compute_library_ptrs = {};
     plf::colony<Compute_Library> m_compute_libraries = {};
 
-    String_Map<Graphics_Pipeline_Library*> m_pipeline_library_ptrs = {};
+    Name_Map<Graphics_Pipeline_Library*> m_pipeline_library_ptrs = {};
     plf::colony<Graphics_Pipeline_Library> m_pipeline_libraries = {};
 
-    String_Map<Ray_Tracing_Pipeline_Library*> m_ray_tracing_pipeline_library_ptrs = {};
+    Name_Map<Ray_Tracing_Pipeline_Library*> m_ray_tracing_pipeline_library_ptrs = {};
     plf::colony<Ray_Tracing_Pipeline_Library> m_ray_tracing_pipeline_libraries = {};
 
-    String_Map<Mapped_File*> m_model_ptrs = {};
-    String_Map<Mapped_File*> m_texture_ptrs = {};
-    plf::colony<Mapped_File> m_files = {};
+    String_Map<Asset_File*> m_model_ptrs = {};
+    String_Map<Asset_File*> m_texture_ptrs = {};
+    String_Map<Asset_File*> m_animation_ptrs = {};
+    plf::colony<Asset_File> m_files = {};
+    Memory_Usage m_mapped_file_usage = {};
+    std::size_t m_mapped_file_budget = 2048ull * 1024 * 1024;
+    uint64_t m_frame = 0; // Of the last `garbage_collect`, stamped into the files used since
 };
 }
@@ -1,22 +1,33 @@
 #include "renderer/asset/compute_library.hpp"
+#include "renderer/asset/pipeline_cache.hpp"
 #include "renderer/asset/shader_library.hpp"
 
 #include <rhi/graphics_device.hpp>
 
 namespace ren
 {
-void Compute_Library::create_pipelines(rhi::Graphics_Device* device, Shader_Library* shader_library)
+void Compute_Library::create_pipelines(rhi::Graphics_Device* device, Pipeline_Cache& pipeline_cache, Shader_Library* shader_library)
 {
     destroy_pipelines(device);
-    for (const auto& [name, blob] : shader_library->shaders)
+    for (const auto& [name, blob, bytecode_hash] : shader_library->shaders)
     {
         auto& pipeline = *pipelines.emplace();
-        pipeline.name = name;
+        pipeline.name = Name(name);
+        pipeline.pipeline = nullptr;
+        pipeline_ptrs.push_back(&pipeline);
+    }
+
+    for (auto i = 0ull; i < pipeline_ptrs.size(); ++i)
+    {
+        if (!shader_library->shaders[i].blob)
+        {
+            continue;
+        }
         rhi::Compute_Pipeline_Create_Info create_info = {
-            blob
+            shader_library->shaders[i].blob
         };
-        pipeline.pipeline = device->create_pipeline(create_info).value_or(nullptr);
-        pipeline_ptrs.push_back(&pipeline);
+        const auto key = Pipeline_Cache::compute_key({ &shader_library->shaders[i].bytecode_hash, 1 });
+        pipeline_ptrs[i]->pipeline = pipeline_cache.create_pipeline(key, create_info).value_or(nullptr);
     }
 }
 
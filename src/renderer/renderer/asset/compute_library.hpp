@@ -4,6 +4,8 @@
 #include <vector>
 #include <string>
 
+#include "renderer/name.hpp"
+
 namespace rhi
 {
 struct Pipeline;
@@ -12,20 +14,26 @@ class Graphics_Device;
 
 namespace ren
 {
+class Asset_Repository;
+class Pipeline_Cache;
 struct Shader_Library;
 
 struct Compute_Pipeline_Wrapper
 {
-    rhi::Pipeline* pipeline;
-    std::string name;
+    rhi::Pipeline* pipeline; // Null until the variant is requested
+    Name name;
+    bool is_requested = false;
 };
 
 struct Compute_Library
 {
     plf::colony<Compute_Pipeline_Wrapper> pipelines;
     std::vector<Compute_Pipeline_Wrapper*> pipeline_ptrs;
+    Asset_Repository* asset_repository = nullptr; // Compiles variants on first request
+    Shader_Library* shader_library = nullptr;
 
-    void create_pipelines(rhi::Graphics_Device* device, Shader_Library* shader_library);
+    // Pipelines are only created for compiled variants.
+    void create_pipelines(rhi::Graphics_Device* device, Pipeline_Cache& pipeline_cache, Shader_Library* shader_library);
     void destroy_pipelines(rhi::Graphics_Device* device);
 };
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <rhi/resource.hpp>
 #include <string>
+#include <vector>
 
 namespace ren
 {
@@ -29,6 +30,7 @@ struct Graphics_Pipeline_Library
     std::array<rhi::Image_Format, rhi::PIPELINE_COLOR_ATTACHMENTS_MAX> color_attachments{};
     uint32_t color_attachment_count;
     rhi::Image_Format depth_stencil_format;
+    std::string json_path;
 
     rhi::Pipeline* pipeline;
 };
@@ -50,6 +52,7 @@ struct Ray_Tracing_Pipeline_Library
     uint32_t max_recursion_depth;
     uint32_t max_payload_size;
     uint32_t max_attribute_size;
+    std::string json_path;
 
     rhi::Pipeline* pipeline;
 };
@@ -1,6 +1,7 @@
 #include "renderer/asset/pipeline.hpp"
 
 #include "graphics_pipeline_library.hpp"
+#include "renderer/asset/asset_repository.hpp"
 #include "renderer/asset/compute_library.hpp"
 #include "renderer/asset/graphics_pipeline_library.hpp"
 
@@ -16,12 +17,17 @@ Compute_Pipeline::operator rhi::Pipeline*() const
     return m_active_pipeline->pipeline;
 }
 
-Compute_Pipeline& Compute_Pipeline::set_variant(std::string_view name)
+Compute_Pipeline& Compute_Pipeline::set_variant(const Name name)
 {
     for (auto& pipeline : m_compute_library->pipelines)
     {
         if (pipeline.name == name)
         {
+            // The first request compiles the variant if it was not compiled up front and records it for the next session.
+            if (!pipeline.is_requested && m_compute_library->asset_repository)
+            {
+                m_compute_library->asset_repository->request_compute_variant(*m_compute_library, pipeline);
+            }
             m_active_pipeline = &pipeline;
             break;
         }
@@ -29,24 +35,25 @@ Compute_Pipeline& Compute_Pipeline::set_variant(std::string_view name)
     return *this;
 }
 
+// A variant that failed to compile has no pipeline, one thread per group keeps the callers' divisions valid.
 uint32_t Compute_Pipeline::get_group_size_x() const noexcept
 {
-    if (!m_active_pipeline)
-        return 0;
+    if (!m_active_pipeline || !m_active_pipeline->pipeline)
+        return 1;
     return m_active_pipeline->pipeline->compute_shading_info.cs->groups_x;
 }
 
 uint32_t Compute_Pipeline::get_group_size_y() const noexcept
 {
-    if (!m_active_pipeline)
-        return 0;
+    if (!m_active_pipeline || !m_active_pipeline->pipeline)
+        return 1;
     return m_active_pipeline->pipeline->compute_shading_info.cs->groups_y;
 }
 
 uint32_t Compute_Pipeline::get_group_size_z() const noexcept
 {
-    if (!m_active_pipeline)
-        return 0;
+    if (!m_active_pipeline || !m_active_pipeline->pipeline)
+        return 1;
     return m_active_pipeline->pipeline->compute_shading_info.cs->groups_z;
 }
 
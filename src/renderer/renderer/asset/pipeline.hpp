@@ -1,6 +1,8 @@
 #pragma once
 #include <string_view>
 
+#include "renderer/name.hpp"
+
 namespace rhi
 {
 struct Pipeline;
@@ -20,7 +22,7 @@ public:
     explicit Compute_Pipeline(Compute_Library* compute_library);
     operator rhi::Pipeline*() const; //NOLINT
 
-    Compute_Pipeline& set_variant(std::string_view name);
+    Compute_Pipeline& set_variant(Name name);
 
     uint32_t get_group_size_x() const noexcept;
     uint32_t get_group_size_y() const noexcept;
@@ -0,0 +1,334 @@
+#include "renderer/asset/pipeline_cache.hpp"
+
+#include <xxhash.h>
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <random>
+
+namespace ren
+{
+namespace
+{
+// Bump whenever the file layout changes.
+constexpr static uint32_t PIPELINE_CACHE_VERSION = 1;
+constexpr static uint32_t PIPELINE_CACHE_MAGIC = 0x43535052; // 'RPSC'
+
+struct Pipeline_Cache_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t graphics_api;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t reserved;
+    uint64_t driver_version;
+    uint64_t key_count;
+    uint64_t blob_size;
+};
+}
+
+Rhi_Pipeline_Cache_Device::Rhi_Pipeline_Cache_Device(rhi::Graphics_Device* graphics_device)
+    : m_graphics_device(graphics_device)
+{}
+
+Pipeline_Cache_Device_Identity Rhi_Pipeline_Cache_Device::get_identity() const
+{
+    return {
+        .graphics_api = m_graphics_device->get_graphics_api(),
+        .vendor_id = 0,
+        .device_id = 0,
+        .driver_version = 0
+    };
+}
+
+bool Rhi_Pipeline_Cache_Device::has_native_cache() const
+{
+    return false;
+}
+
+bool Rhi_Pipeline_Cache_Device::load_blob(const std::vector<uint8_t>& blob)
+{
+    return blob.empty();
+}
+
+std::vector<uint8_t> Rhi_Pipeline_Cache_Device::serialize_blob() const
+{
+    return {};
+}
+
+Pipeline_Result Rhi_Pipeline_Cache_Device::create_pipeline(uint64_t key, const rhi::Compute_Pipeline_Create_Info& create_info)
+{
+    return m_graphics_device->create_pipeline(create_info);
+}
+
+Pipeline_Result Rhi_Pipeline_Cache_Device::create_pipeline(uint64_t key, const rhi::Graphics_Pipeline_Create_Info& create_info)
+{
+    return m_graphics_device->create_pipeline(create_info);
+}
+
+Pipeline_Result Rhi_Pipeline_Cache_Device::create_pipeline(uint64_t key, const rhi::Mesh_Shading_Pipeline_Create_Info& create_info)
+{
+    return m_graphics_device->create_pipeline(create_info);
+}
+
+Pipeline_Result Rhi_Pipeline_Cache_Device::create_pipeline(uint64_t key, const rhi::Ray_Tracing_Pipeline_Create_Info& create_info)
+{
+    return m_graphics_device->create_pipeline(create_info);
+}
+
+Recording_Pipeline_Cache_Device::Recording_Pipeline_Cache_Device(const Pipeline_Cache_Device_Identity& identity)
+    : m_identity(identity)
+{}
+
+Pipeline_Cache_Device_Identity Recording_Pipeline_Cache_Device::get_identity() const
+{
+    return m_identity;
+}
+
+bool Recording_Pipeline_Cache_Device::has_native_cache() const
+{
+    return true;
+}
+
+bool Recording_Pipeline_Cache_Device::load_blob(const std::vector<uint8_t>& blob)
+{
+    if (blob.size() % sizeof(uint64_t) != 0)
+    {
+        return false;
+    }
+    std::scoped_lock lock(m_mutex);
+    for (auto offset = 0ull; offset < blob.size(); offset += sizeof(uint64_t))
+    {
+        uint64_t key = 0;
+        memcpy(&key, blob.data() + offset, sizeof(uint64_t));
+        m_cached_keys.insert(key);
+    }
+    return true;
+}
+
+std::vector<uint8_t> Recording_Pipeline_Cache_Device::serialize_blob() const
+{
+    std::scoped_lock lock(m_mutex);
+    // Like the keys of the cache file, the blob only keeps the pipelines requested this session.
+    const ankerl::unordered_dense::set<uint64_t> requested_keys(m_requested_keys.begin(), m_requested_keys.end());
+    std::vector<uint8_t> blob(requested_keys.size() * sizeof(uint64_t));
+    memcpy(blob.data(), requested_keys.values().data(), blob.size());
+    return blob;
+}
+
+Pipeline_Result Recording_Pipeline_Cache_Device::create_pipeline(uint64_t key, const rhi::Compute_Pipeline_Create_Info& create_info)
+{
+    return record(key);
+}
+
+Pipeline_Result Recording_Pipeline_Cache_Device::create_pipeline(uint64_t key, const rhi::Graphics_Pipeline_Create_Info& create_info)
+{
+    return record(key);
+}
+
+Pipeline_Result Recording_Pipeline_Cache_Device::create_pipeline(uint64_t key, const rhi::Mesh_Shading_Pipeline_Create_Info& create_info)
+{
+    return record(key);
+}
+
+Pipeline_Result Recording_Pipeline_Cache_Device::create_pipeline(uint64_t key, const rhi::Ray_Tracing_Pipeline_Create_Info& create_info)
+{
+    return record(key);
+}
+
+uint32_t Recording_Pipeline_Cache_Device::get_hit_count() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_hit_count;
+}
+
+uint32_t Recording_Pipeline_Cache_Device::get_miss_count() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_miss_count;
+}
+
+std::vector<uint64_t> Recording_Pipeline_Cache_Device::get_requested_keys() const
+{
+    std::scoped_lock lock(m_mutex);
+    return m_requested_keys;
+}
+
+Pipeline_Result Recording_Pipeline_Cache_Device::record(uint64_t key)
+{
+    std::scoped_lock lock(m_mutex);
+    m_requested_keys.push_back(key);
+    if (m_cached_keys.contains(key))
+    {
+        m_hit_count += 1;
+    }
+    else
+    {
+        m_miss_count += 1;
+        m_cached_keys.insert(key);
+    }
+    return nullptr;
+}
+
+Pipeline_Cache::Pipeline_Cache(std::shared_ptr<Logger> logger, std::unique_ptr<Pipeline_Cache_Device> device,
+    const std::filesystem::path& directory)
+    : m_logger(std::move(logger))
+    , m_device(std::move(device))
+    , m_directory(directory)
+    , m_is_enabled(true)
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error)
+    {
+        m_logger->warn("Failed to create pipeline cache directory '{}', pipeline caching is disabled.", m_directory.string());
+        m_is_enabled = false;
+    }
+}
+
+void Pipeline_Cache::load()
+{
+    if (!m_is_enabled)
+    {
+        return;
+    }
+
+    const auto path = get_file_path();
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        m_logger->info("No pipeline cache for this device and driver yet.");
+        return;
+    }
+
+    const auto identity = m_device->get_identity();
+    Pipeline_Cache_Header header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file
+        || header.magic != PIPELINE_CACHE_MAGIC
+        || header.version != PIPELINE_CACHE_VERSION
+        || header.graphics_api != static_cast<uint32_t>(identity.graphics_api)
+        || header.vendor_id != identity.vendor_id
+        || header.device_id != identity.device_id
+        || header.driver_version != identity.driver_version)
+    {
+        m_logger->warn("Discarding pipeline cache '{}', it was written for another device or driver.", path.string());
+        return;
+    }
+
+    std::vector<uint64_t> keys(header.key_count);
+    std::vector<uint8_t> blob(header.blob_size);
+    file.read(reinterpret_cast<char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(uint64_t)));
+    file.read(reinterpret_cast<char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    if (!file)
+    {
+        m_logger->warn("Discarding truncated pipeline cache '{}'.", path.string());
+        return;
+    }
+    if (!m_device->load_blob(blob))
+    {
+        m_logger->warn("Discarding pipeline cache '{}', the backend rejected it.", path.string());
+        return;
+    }
+    m_loaded_keys.insert(keys.begin(), keys.end());
+    m_logger->info("Loaded pipeline cache with {} pipelines.", keys.size());
+}
+
+void Pipeline_Cache::save() const
+{
+    if (!m_is_enabled)
+    {
+        return;
+    }
+
+    std::vector<uint64_t> keys;
+    {
+        std::scoped_lock lock(m_mutex);
+        keys = m_keys.values();
+    }
+    const auto blob = m_device->serialize_blob();
+    const auto identity = m_device->get_identity();
+    const Pipeline_Cache_Header header = {
+        .magic = PIPELINE_CACHE_MAGIC,
+        .version = PIPELINE_CACHE_VERSION,
+        .graphics_api = static_cast<uint32_t>(identity.graphics_api),
+        .vendor_id = identity.vendor_id,
+        .device_id = identity.device_id,
+        .reserved = 0,
+        .driver_version = identity.driver_version,
+        .key_count = keys.size(),
+        .blob_size = blob.size()
+    };
+
+    const auto path = get_file_path();
+    auto temporary_path = path;
+    temporary_path += "." + std::to_string(std::random_device()()) + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            m_logger->warn("Failed to write pipeline cache '{}'.", temporary_path.string());
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(uint64_t)));
+        file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary_path, error);
+    }
+}
+
+uint64_t Pipeline_Cache::compute_key(std::span<const uint64_t> shader_hashes, uint64_t description_hash)
+{
+    auto* state = XXH3_createState();
+    XXH3_64bits_reset(state);
+    XXH3_64bits_update(state, &PIPELINE_CACHE_VERSION, sizeof(PIPELINE_CACHE_VERSION));
+    XXH3_64bits_update(state, &description_hash, sizeof(description_hash));
+    XXH3_64bits_update(state, shader_hashes.data(), shader_hashes.size_bytes());
+    const auto result = XXH3_64bits_digest(state);
+    XXH3_freeState(state);
+    return result;
+}
+
+Pipeline_Cache_Device& Pipeline_Cache::get_device() const
+{
+    return *m_device;
+}
+
+uint32_t Pipeline_Cache::get_hit_count() const
+{
+    return m_hit_count.load(std::memory_order_relaxed);
+}
+
+uint32_t Pipeline_Cache::get_miss_count() const
+{
+    return m_miss_count.load(std::memory_order_relaxed);
+}
+
+void Pipeline_Cache::record(uint64_t key)
+{
+    if (m_loaded_keys.contains(key))
+    {
+        m_hit_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        m_miss_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::scoped_lock lock(m_mutex);
+    m_keys.insert(key);
+}
+
+std::filesystem::path Pipeline_Cache::get_file_path() const
+{
+    const auto identity = m_device->get_identity();
+    return m_directory / std::format("{}_{:08x}_{:08x}_{:016x}.pso",
+        static_cast<uint32_t>(identity.graphics_api), identity.vendor_id, identity.device_id, identity.driver_version);
+}
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <rhi/graphics_device.hpp>
+
+#include <ankerl/unordered_dense.h>
+
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "renderer/logger.hpp"
+
+namespace ren
+{
+// Everything a native pipeline cache blob is only valid for.
+struct Pipeline_Cache_Device_Identity
+{
+    rhi::Graphics_API graphics_api;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint64_t driver_version;
+};
+
+using Pipeline_Result = std::expected<rhi::Pipeline*, rhi::Result>;
+
+// Backend of the pipeline cache. Pipelines are created through it, so the backend can look them up
+// in its native cache by `key`, which identifies the pipeline description and shader bytecode across runs.
+class Pipeline_Cache_Device
+{
+public:
+    virtual ~Pipeline_Cache_Device() = default;
+
+    [[nodiscard]] virtual Pipeline_Cache_Device_Identity get_identity() const = 0;
+    // Without a native cache, every pipeline is compiled by the driver and the blob stays empty.
+    [[nodiscard]] virtual bool has_native_cache() const = 0;
+    // Returns false if the backend rejects the blob written by the last run.
+    virtual bool load_blob(const std::vector<uint8_t>& blob) = 0;
+    [[nodiscard]] virtual std::vector<uint8_t> serialize_blob() const = 0;
+
+    // Must be thread safe if pipelines are created on several threads.
+    virtual Pipeline_Result create_pipeline(uint64_t key, const rhi::Compute_Pipeline_Create_Info& create_info) = 0;
+    virtual Pipeline_Result create_pipeline(uint64_t key, const rhi::Graphics_Pipeline_Create_Info& create_info) = 0;
+    virtual Pipeline_Result create_pipeline(uint64_t key, const rhi::Mesh_Shading_Pipeline_Create_Info& create_info) = 0;
+    virtual Pipeline_Result create_pipeline(uint64_t key, const rhi::Ray_Tracing_Pipeline_Create_Info& create_info) = 0;
+};
+
+// Forwards to the `rhi` device. `rhi` exposes neither a native pipeline cache nor the adapter identity yet,
+// so only the graphics API is part of the identity and the blob stays empty.
+class Rhi_Pipeline_Cache_Device final : public Pipeline_Cache_Device
+{
+public:
+    explicit Rhi_Pipeline_Cache_Device(rhi::Graphics_Device* graphics_device);
+
+    [[nodiscard]] Pipeline_Cache_Device_Identity get_identity() const override;
+    [[nodiscard]] bool has_native_cache() const override;
+    bool load_blob(const std::vector<uint8_t>& blob) override;
+    [[nodiscard]] std::vector<uint8_t> serialize_blob() const override;
+
+    Pipeline_Result create_pipeline(uint64_t key, const rhi::Compute_Pipeline_Create_Info& create_info) override;
+    Pipeline_Result create_pipeline(uint64_t key, const rhi::Graphics_Pipeline_Create_Info& create_info) override;
+    Pipeline_Result create_pipeline(uint64_t key, const rhi::Mesh_Shading_Pipeline_Create_Info& create_info) override;
+    Pipeline_Result create_pipeline(uint64_t key, const rhi::Ray_Tracing_Pipeline_Create_Info& create_info) override;
+
+private:
+    rhi::Graphics_Device* m_graphics_device;
+};
+
+// Stand-in for machines without a GPU. Simulates a driver cache by remembering the keys it has seen,
+// records every request and creates no pipelines.
+class Recording_Pipeline_Cache_Device final : public Pipeline_Cache_Device
+{
+public:
+    explicit Recording_Pipeline_Cache_Device(const Pipeline_Cache_Device_Identity& identity);
+
+    [[nodiscard]] Pipeline_Cache_Device_Identity get_identity() const override;
+    [[nodiscard]] bool has_native_cache() const override;
+    bool load_blob(const std::vector<uint8_t>& blob) override;
+    [[nodiscard]] std::vector<uint8_t> serialize_blob() const override;
+
+    Pipeline_Result create_pipeline(uint64_t key, const rhi::Compute_Pipeline_Create_Info& create_info) override;
+    Pipeline_Result create_pipeline(uint64_t key, const rhi::Graphics_Pipeline_Create_Info& create_info) override;
+    Pipeline_Result create_pipeline(uint64_t key, const rhi::Mesh_Shading_Pipeline_Create_Info& create_info) override;
+    Pipeline_Result create_pipeline(uint64_t key, const rhi::Ray_Tracing_Pipeline_Create_Info& create_info) override;
+
+    [[nodiscard]] uint32_t get_hit_count() const;
+    [[nodiscard]] uint32_t get_miss_count() const;
+    [[nodiscard]] std::vector<uint64_t> get_requested_keys() const;
+
+private:
+    Pipeline_Result record(uint64_t key);
+
+private:
+    Pipeline_Cache_Device_Identity m_identity;
+    mutable std::mutex m_mutex;
+    ankerl::unordered_dense::set<uint64_t> m_cached_keys;
+    std::vector<uint64_t> m_requested_keys;
+    uint32_t m_hit_count = 0;
+    uint32_t m_miss_count = 0;
+};
+
+// Persists the backend cache blob per device and driver, together with the keys it contains.
+// A blob written for another device or driver is discarded. Only the pipelines requested in a session
+// are written, pipelines that are no longer used drop out of the cache.
+class Pipeline_Cache
+{
+public:
+    Pipeline_Cache(std::shared_ptr<Logger> logger, std::unique_ptr<Pipeline_Cache_Device> device,
+        const std::filesystem::path& directory);
+
+    void load();
+    void save() const;
+
+    // Combines the bytecode hashes of all shaders with the hash of the pipeline description.
+    [[nodiscard]] static uint64_t compute_key(std::span<const uint64_t> shader_hashes, uint64_t description_hash = 0);
+
+    // Thread safe if the device is.
+    template<typename Create_Info>
+    Pipeline_Result create_pipeline(uint64_t key, const Create_Info& create_info)
+    {
+        record(key);
+        return m_device->create_pipeline(key, create_info);
+    }
+
+    [[nodiscard]] Pipeline_Cache_Device& get_device() const;
+    [[nodiscard]] uint32_t get_hit_count() const;
+    [[nodiscard]] uint32_t get_miss_count() const;
+
+private:
+    void record(uint64_t key);
+    [[nodiscard]] std::filesystem::path get_file_path() const;
+
+private:
+    std::shared_ptr<Logger> m_logger;
+    std::unique_ptr<Pipeline_Cache_Device> m_device;
+    std::filesystem::path m_directory;
+    bool m_is_enabled;
+
+    ankerl::unordered_dense::set<uint64_t> m_loaded_keys; // Read only after `load`
+    mutable std::mutex m_mutex;
+    ankerl::unordered_dense::set<uint64_t> m_keys; // Requested this session
+    std::atomic<uint32_t> m_hit_count = 0;
+    std::atomic<uint32_t> m_miss_count = 0;
+};
+}
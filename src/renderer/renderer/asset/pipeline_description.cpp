@@ -0,0 +1,700 @@
+#include "renderer/asset/pipeline_description.hpp"
+#include "renderer/filesystem/file_util.hpp"
+
+#include <nlohmann/json.hpp>
+#include <xxhash.h>
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <random>
+#include <string_view>
+#include <type_traits>
+
+namespace ren
+{
+namespace
+{
+// Bump whenever the description structs or the `rhi` state structs change.
+constexpr static uint32_t PIPELINE_DESCRIPTION_CACHE_VERSION = 1;
+constexpr static uint32_t PIPELINE_DESCRIPTION_CACHE_MAGIC = 0x43504452; // 'RDPC'
+
+struct Pipeline_Description_Cache_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t kind;
+    uint32_t reserved;
+    int64_t source_write_time;
+    uint64_t source_size;
+    uint64_t source_hash;
+    uint64_t payload_size;
+};
+
+class Binary_Writer
+{
+public:
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto offset = m_data.size();
+        m_data.resize(offset + sizeof(T));
+        memcpy(m_data.data() + offset, &value, sizeof(T));
+    }
+
+    void write(const std::string& value)
+    {
+        write(static_cast<uint32_t>(value.size()));
+        m_data.insert(m_data.end(), value.begin(), value.end());
+    }
+
+    template<typename T>
+    void write(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(static_cast<uint32_t>(values.size()));
+        const auto offset = m_data.size();
+        m_data.resize(offset + values.size() * sizeof(T));
+        memcpy(m_data.data() + offset, values.data(), values.size() * sizeof(T));
+    }
+
+    [[nodiscard]] const std::vector<uint8_t>& get_data() const
+    {
+        return m_data;
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+};
+
+// Every read is bounds checked, a truncated or corrupt payload fails instead of reading garbage.
+class Binary_Reader
+{
+public:
+    explicit Binary_Reader(const std::vector<uint8_t>& data)
+        : m_data(data)
+        , m_offset(0)
+    {}
+
+    template<typename T>
+    bool read(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (m_offset + sizeof(T) > m_data.size())
+            return false;
+        memcpy(&value, m_data.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        uint32_t size = 0;
+        if (!read(size) || m_offset + size > m_data.size())
+            return false;
+        value.assign(reinterpret_cast<const char*>(m_data.data() + m_offset), size);
+        m_offset += size;
+        return true;
+    }
+
+    template<typename T>
+    bool read(std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        uint32_t count = 0;
+        if (!read(count) || m_offset + std::size_t(count) * sizeof(T) > m_data.size())
+            return false;
+        values.resize(count);
+        memcpy(values.data(), m_data.data() + m_offset, std::size_t(count) * sizeof(T));
+        m_offset += std::size_t(count) * sizeof(T);
+        return true;
+    }
+
+    [[nodiscard]] bool is_at_end() const
+    {
+        return m_offset == m_data.size();
+    }
+
+private:
+    const std::vector<uint8_t>& m_data;
+    std::size_t m_offset;
+};
+
+void serialize(Binary_Writer& writer, const Graphics_Pipeline_Description& description)
+{
+    writer.write(description.name);
+    for (const auto* shader : { &description.ts, &description.ms, &description.vs, &description.ps })
+    {
+        writer.write(shader->library);
+        writer.write(shader->variant);
+    }
+    writer.write(description.blend_state_info);
+    writer.write(description.primitive_topology);
+    writer.write(description.rasterizer_state_info);
+    writer.write(description.depth_stencil_info);
+    writer.write(description.color_attachments);
+    writer.write(description.color_attachment_count);
+    writer.write(description.depth_stencil_format);
+}
+
+bool deserialize(Binary_Reader& reader, Graphics_Pipeline_Description& description)
+{
+    auto result = reader.read(description.name);
+    for (auto* shader : { &description.ts, &description.ms, &description.vs, &description.ps })
+    {
+        result = result && reader.read(shader->library) && reader.read(shader->variant);
+    }
+    return result
+        && reader.read(description.blend_state_info)
+        && reader.read(description.primitive_topology)
+        && reader.read(description.rasterizer_state_info)
+        && reader.read(description.depth_stencil_info)
+        && reader.read(description.color_attachments)
+        && reader.read(description.color_attachment_count)
+        && reader.read(description.depth_stencil_format)
+        && reader.is_at_end();
+}
+
+void serialize(Binary_Writer& writer, const Ray_Tracing_Pipeline_Description& description)
+{
+    writer.write(description.name);
+    writer.write(static_cast<uint32_t>(description.shaders.size()));
+    for (const auto& shader : description.shaders)
+    {
+        writer.write(shader.shader.library);
+        writer.write(shader.shader.variant);
+        writer.write(shader.type);
+    }
+    writer.write(description.hit_groups);
+    writer.write(description.ray_gen_libraries);
+    writer.write(description.miss_libraries);
+    writer.write(description.callable_libraries);
+    writer.write(description.max_recursion_depth);
+    writer.write(description.max_payload_size);
+    writer.write(description.max_attribute_size);
+}
+
+bool deserialize(Binary_Reader& reader, Ray_Tracing_Pipeline_Description& description)
+{
+    uint32_t shader_count = 0;
+    if (!reader.read(description.name) || !reader.read(shader_count))
+    {
+        return false;
+    }
+    description.shaders.resize(shader_count);
+    for (auto& shader : description.shaders)
+    {
+        if (!reader.read(shader.shader.library) || !reader.read(shader.shader.variant) || !reader.read(shader.type))
+        {
+            return false;
+        }
+    }
+    return reader.read(description.hit_groups)
+        && reader.read(description.ray_gen_libraries)
+        && reader.read(description.miss_libraries)
+        && reader.read(description.callable_libraries)
+        && reader.read(description.max_recursion_depth)
+        && reader.read(description.max_payload_size)
+        && reader.read(description.max_attribute_size)
+        && reader.is_at_end();
+}
+
+bool read_entry(
+    const std::filesystem::path& path,
+    const uint32_t kind,
+    Pipeline_Description_Cache_Header& header,
+    std::vector<uint8_t>& payload)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file
+        || header.magic != PIPELINE_DESCRIPTION_CACHE_MAGIC
+        || header.version != PIPELINE_DESCRIPTION_CACHE_VERSION
+        || header.kind != kind)
+    {
+        return false;
+    }
+    payload.resize(header.payload_size);
+    file.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    return static_cast<bool>(file);
+}
+
+bool write_entry(
+    const std::filesystem::path& path,
+    const Pipeline_Description_Cache_Header& header,
+    const std::vector<uint8_t>& payload)
+{
+    auto temporary_path = path;
+    temporary_path += "." + std::to_string(std::random_device()()) + ".tmp";
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    return true;
+}
+
+std::optional<rhi::Ray_Tracing_Shader_Type> ray_tracing_shader_type_from_string(std::string_view type)
+{
+    if (type == "rgen")
+        return rhi::Ray_Tracing_Shader_Type::Ray_Gen;
+    if (type == "rahit")
+        return rhi::Ray_Tracing_Shader_Type::Ray_Any_Hit;
+    if (type == "rchit")
+        return rhi::Ray_Tracing_Shader_Type::Ray_Closest_Hit;
+    if (type == "rmiss")
+        return rhi::Ray_Tracing_Shader_Type::Ray_Miss;
+    if (type == "rint")
+        return rhi::Ray_Tracing_Shader_Type::Ray_Intersection;
+    if (type == "rcall")
+        return rhi::Ray_Tracing_Shader_Type::Ray_Callable;
+    return std::nullopt;
+}
+}
+
+std::optional<Graphics_Pipeline_Description> parse_graphics_pipeline_description(
+    const std::string& json_text, const std::string& json_path, Logger& logger)
+{
+    auto pipeline_json = nlohmann::json::parse(json_text, nullptr, false);
+    if (pipeline_json.is_discarded() || !pipeline_json.is_object())
+    {
+        logger.error("Graphics pipeline '{}': Invalid JSON.", json_path);
+        return std::nullopt;
+    }
+    if (!pipeline_json.contains("name") || !pipeline_json["name"].is_string())
+    {
+        logger.error("Graphics pipeline '{}': No name.", json_path);
+        return std::nullopt;
+    }
+
+    Graphics_Pipeline_Description description = {};
+    description.name = pipeline_json["name"].get<std::string>();
+
+    auto set_shader = [&](Pipeline_Shader_Description& shader, const std::string_view type)
+    {
+        if (pipeline_json.contains(type) && pipeline_json[type].contains("name"))
+        {
+            shader.library = pipeline_json[type]["name"].get<std::string>();
+            shader.variant = pipeline_json[type].contains("variant")
+                ? pipeline_json[type]["variant"].get<std::string>()
+                : "";
+        }
+    };
+    set_shader(description.ts, "ts");
+    set_shader(description.ms, "ms");
+    set_shader(description.vs, "vs");
+    set_shader(description.ps, "ps");
+
+    auto& blend_state_info = description.blend_state_info;
+    blend_state_info.independent_blend_enable = pipeline_json.contains("independent_blend_enable")
+            ? pipeline_json["independent_blend_enable"].get<bool>()
+            : false;
+
+    if (pipeline_json.contains("color_attachments"))
+    {
+        if (pipeline_json["color_attachments"].size() > rhi::PIPELINE_COLOR_ATTACHMENTS_MAX)
+        {
+            logger.error("Graphics pipeline '{}': Too many color attachments.", json_path);
+            return std::nullopt;
+        }
+        for (const auto& color_attachment_json : pipeline_json["color_attachments"])
+        {
+            auto& ca_blend = blend_state_info.color_attachments[description.color_attachment_count];
+            ca_blend.blend_enable = color_attachment_json.contains("blend_enable")
+                ? color_attachment_json["blend_enable"].get<bool>()
+                : false;
+            ca_blend.logic_op_enable = color_attachment_json.contains("logic_op_enable")
+                ? color_attachment_json["logic_op_enable"].get<bool>()
+                : false;
+            ca_blend.color_src_blend = color_attachment_json.contains("color_src_blend")
+                ? rhi::blend_factor_from_string(color_attachment_json["color_src_blend"].get<std::string>())
+                : rhi::Blend_Factor::Zero;
+            ca_blend.color_dst_blend = color_attachment_json.contains("color_dst_blend")
+                ? rhi::blend_factor_from_string(color_attachment_json["color_dst_blend"].get<std::string>())
+                : rhi::Blend_Factor::Zero;
+            ca_blend.color_blend_op = color_attachment_json.contains("color_blend_op")
+                ? rhi::blend_op_from_string(color_attachment_json["color_blend_op"].get<std::string>())
+                : rhi::Blend_Op::Add;
+            ca_blend.alpha_src_blend = color_attachment_json.contains("alpha_src_blend")
+                ? rhi::blend_factor_from_string(color_attachment_json["alpha_src_blend"].get<std::string>())
+                : rhi::Blend_Factor::Zero;
+            ca_blend.alpha_dst_blend = color_attachment_json.contains("alpha_dst_blend")
+                ? rhi::blend_factor_from_string(color_attachment_json["alpha_dst_blend"].get<std::string>())
+                : rhi::Blend_Factor::Zero;
+            ca_blend.alpha_blend_op = color_attachment_json.contains("alpha_blend_op")
+                ? rhi::blend_op_from_string(color_attachment_json["alpha_blend_op"].get<std::string>())
+                : rhi::Blend_Op::Add;
+            ca_blend.logic_op = color_attachment_json.contains("logic_op")
+                ? rhi::logic_op_from_string(color_attachment_json["logic_op"].get<std::string>())
+                : rhi::Logic_Op::Clear;
+            ca_blend.color_write_mask = color_attachment_json.contains("color_write_mask")
+                ? rhi::color_component_from_string(color_attachment_json["color_write_mask"].get<std::string>())
+                : rhi::Color_Component::Enable_All;
+
+            auto& ca_format = description.color_attachments[description.color_attachment_count];
+            ca_format = color_attachment_json.contains("format")
+                ? rhi::get_image_format_info(color_attachment_json["format"].get<std::string>()).format
+                : rhi::Image_Format::Undefined;
+
+            description.color_attachment_count += 1;
+        }
+    }
+
+    if (pipeline_json.contains("depth_stencil"))
+    {
+        auto& depth_stencil_json = pipeline_json["depth_stencil"];
+        auto& depth_stencil_info = description.depth_stencil_info;
+
+        description.depth_stencil_format = depth_stencil_json.contains("format")
+            ? rhi::get_image_format_info(depth_stencil_json["format"].get<std::string>()).format
+            : rhi::Image_Format::Undefined;
+
+        depth_stencil_info.depth_enable = depth_stencil_json.contains("depth_enable")
+            ? depth_stencil_json["depth_enable"].get<bool>()
+            : false;
+        depth_stencil_info.depth_write_enable = depth_stencil_json.contains("depth_write_enable")
+            ? depth_stencil_json["depth_write_enable"].get<bool>()
+            : false;
+        depth_stencil_info.comparison_func = depth_stencil_json.contains("comparison_func")
+            ? rhi::comparison_func_from_string(depth_stencil_json["comparison_func"].get<std::string>())
+            : rhi::Comparison_Func::None;
+        depth_stencil_info.stencil_enable = depth_stencil_json.contains("stencil_enable")
+            ? depth_stencil_json["stencil_enable"].get<bool>()
+            : false;
+
+        auto set_stencil_info = [&](auto& stencil_face_info, const std::string_view stencil_info_str)
+        {
+            if (!depth_stencil_json.contains(stencil_info_str))
+                return;
+            auto& stencil_json = depth_stencil_json[stencil_info_str];
+            stencil_face_info.fail = depth_stencil_json.contains("fail")
+                ? rhi::stencil_op_from_string(stencil_json["fail"].get<std::string>())
+                : rhi::Stencil_Op::Keep;
+            stencil_face_info.depth_fail = depth_stencil_json.contains("depth_fail")
+                ? rhi::stencil_op_from_string(stencil_json["depth_fail"].get<std::string>())
+                : rhi::Stencil_Op::Keep;
+            stencil_face_info.pass = depth_stencil_json.contains("pass")
+                ? rhi::stencil_op_from_string(stencil_json["pass"].get<std::string>())
+                : rhi::Stencil_Op::Keep;
+            stencil_face_info.comparison_func = depth_stencil_json.contains("comparison_func")
+                ? rhi::comparison_func_from_string(depth_stencil_json["comparison_func"].get<std::string>())
+                : rhi::Comparison_Func::None;
+            stencil_face_info.stencil_read_mask = depth_stencil_json.contains("stencil_read_mask")
+                ? uint8_t(stencil_json["stencil_read_mask"].get<uint32_t>())
+                : 0;
+            stencil_face_info.stencil_write_mask = depth_stencil_json.contains("stencil_write_mask")
+                ? uint8_t(stencil_json["stencil_write_mask"].get<uint32_t>())
+                : 0;
+        };
+        set_stencil_info(depth_stencil_info.stencil_front_face, "stencil_front_face");
+        set_stencil_info(depth_stencil_info.stencil_back_face, "stencil_back_face");
+
+        depth_stencil_info.depth_bounds_test_mode = depth_stencil_json.contains("depth_bounds_test_mode")
+            ? rhi::depth_bounds_test_mode_from_string(depth_stencil_json["depth_bounds_test_mode"].get<std::string>())
+            : rhi::Depth_Bounds_Test_Mode::Disabled;
+        depth_stencil_info.depth_bounds_min = depth_stencil_json.contains("depth_bounds_min")
+            ? depth_stencil_json["depth_bounds_min"].get<float>()
+            : 0.f;
+        depth_stencil_info.depth_bounds_max = depth_stencil_json.contains("depth_bounds_max")
+            ? depth_stencil_json["depth_bounds_max"].get<float>()
+            : 0.f;
+    }
+
+    if (pipeline_json.contains("rasterizer_state"))
+    {
+        auto& rasterizer_json = pipeline_json["rasterizer_state"];
+        auto& rasterizer_state_info = description.rasterizer_state_info;
+        rasterizer_state_info.fill_mode = rasterizer_json.contains("wireframe")
+            ? static_cast<rhi::Fill_Mode>(rasterizer_json["wireframe"].get<bool>())
+            : rhi::Fill_Mode::Solid;
+        rasterizer_state_info.cull_mode = rasterizer_json.contains("cull_mode")
+            ? rhi::cull_mode_from_string(rasterizer_json["cull_mode"].get<std::string>())
+            : rhi::Cull_Mode::None;
+        rasterizer_state_info.winding_order = rasterizer_json.contains("front_face_cw")
+            ? static_cast<rhi::Winding_Order>(rasterizer_json["front_face_cw"].get<bool>())
+            : rhi::Winding_Order::Front_Face_CCW;
+        rasterizer_state_info.depth_bias = rasterizer_json.contains("depth_bias")
+            ? rasterizer_json["depth_bias"].get<float>()
+            : 0.f;
+        rasterizer_state_info.depth_bias_clamp = rasterizer_json.contains("depth_bias_clamp")
+            ? rasterizer_json["depth_bias_clamp"].get<float>()
+            : 0.f;
+        rasterizer_state_info.depth_bias_slope_scale = rasterizer_json.contains("depth_bias_slope_scale")
+            ? rasterizer_json["depth_bias_slope_scale"].get<float>()
+            : 0.f;
+        rasterizer_state_info.depth_clip_enable = rasterizer_json.contains("depth_clip_enable")
+            ? rasterizer_json["depth_clip_enable"].get<bool>()
+            : true;
+    }
+
+    description.primitive_topology = pipeline_json.contains("primitive_topology")
+        ? rhi::primitive_topology_from_string(pipeline_json["primitive_topology"].get<std::string>())
+        : rhi::Primitive_Topology_Type::Triangle;
+
+    return description;
+}
+
+std::optional<Ray_Tracing_Pipeline_Description> parse_ray_tracing_pipeline_description(
+    const std::string& json_text, const std::string& json_path, Logger& logger)
+{
+    auto pipeline_json = nlohmann::json::parse(json_text, nullptr, false);
+    if (pipeline_json.is_discarded() || !pipeline_json.is_object())
+    {
+        logger.error("Ray tracing pipeline '{}': Invalid JSON.", json_path);
+        return std::nullopt;
+    }
+    if (!pipeline_json.contains("name") || !pipeline_json["name"].is_string())
+    {
+        logger.error("Ray tracing pipeline '{}': No name.", json_path);
+        return std::nullopt;
+    }
+
+    Ray_Tracing_Pipeline_Description description = {};
+    description.name = pipeline_json["name"].get<std::string>();
+
+    if (pipeline_json.contains("shaders"))
+    {
+        description.shaders.reserve(pipeline_json["shaders"].size());
+        for (const auto& shader_json : pipeline_json["shaders"])
+        {
+            auto& shader = description.shaders.emplace_back();
+            if (shader_json.contains("name"))
+            {
+                shader.shader.library = shader_json["name"].get<std::string>();
+            }
+            else
+            {
+                logger.warn("Shader missing name.");
+            }
+            const auto type = shader_json.contains("type")
+                ? ray_tracing_shader_type_from_string(shader_json["type"].get<std::string>())
+                : std::nullopt;
+            if (!type.has_value())
+            {
+                logger.error("Ray tracing pipeline '{}': Invalid shader type for '{}'.", json_path, shader.shader.library);
+                return std::nullopt;
+            }
+            shader.type = type.value();
+            if (shader_json.contains("variant"))
+            {
+                shader.shader.variant = shader_json["variant"].get<std::string>();
+            }
+        }
+    }
+    const auto shader_count = static_cast<uint32_t>(description.shaders.size());
+
+    auto read_shader_indices = [&](const char* key, std::vector<uint32_t>& indices)
+    {
+        if (!pipeline_json.contains(key))
+        {
+            return true;
+        }
+        for (const auto& index_json : pipeline_json[key])
+        {
+            const auto index = static_cast<uint32_t>(index_json.get<int32_t>());
+            if (index >= shader_count)
+            {
+                logger.error("Ray tracing pipeline '{}': Shader index {} in '{}' is out of range.", json_path, index, key);
+                return false;
+            }
+            indices.push_back(index);
+        }
+        return true;
+    };
+    if (!read_shader_indices("ray_gen", description.ray_gen_libraries)
+        || !read_shader_indices("miss", description.miss_libraries)
+        || !read_shader_indices("callable", description.callable_libraries))
+    {
+        return std::nullopt;
+    }
+
+    if (pipeline_json.contains("hit_groups"))
+    {
+        for (const auto& hit_group_json : pipeline_json["hit_groups"])
+        {
+            auto hit_group_type = rhi::Ray_Tracing_Hit_Group_Type::Triangles;
+            if (hit_group_json.contains("type"))
+            {
+                auto type_string = hit_group_json["type"].get<std::string>();
+                if (type_string == "triangles")
+                {
+                    hit_group_type = rhi::Ray_Tracing_Hit_Group_Type::Triangles;
+                }
+                else if (type_string == "procedural")
+                {
+                    hit_group_type = rhi::Ray_Tracing_Hit_Group_Type::Procedural;
+                }
+                else
+                {
+                    logger.warn("Invalid ray tracing hit group type.");
+                }
+            }
+
+            auto read_hit_shader = [&](const char* key)
+            {
+                return hit_group_json.contains(key)
+                    ? static_cast<uint32_t>(hit_group_json[key].get<int32_t>())
+                    : rhi::RT_PIPELINE_NO_SHADER;
+            };
+            const rhi::Ray_Tracing_Hit_Group hit_group = {
+                .type = hit_group_type,
+                .closest_hit = read_hit_shader("closest_hit"),
+                .any_hit = read_hit_shader("any_hit"),
+                .intersection = read_hit_shader("intersection")
+            };
+            for (const auto index : { hit_group.closest_hit, hit_group.any_hit, hit_group.intersection })
+            {
+                if (index != rhi::RT_PIPELINE_NO_SHADER && index >= shader_count)
+                {
+                    logger.error("Ray tracing pipeline '{}': Hit group shader index {} is out of range.", json_path, index);
+                    return std::nullopt;
+                }
+            }
+            description.hit_groups.push_back(hit_group);
+        }
+    }
+
+    description.max_recursion_depth = pipeline_json.contains("max_recursion_depth")
+        ? static_cast<uint32_t>(pipeline_json["max_recursion_depth"].get<int32_t>())
+        : 1u;
+    description.max_payload_size = pipeline_json.contains("max_payload_size")
+        ? static_cast<uint32_t>(pipeline_json["max_payload_size"].get<int32_t>())
+        : 32u;
+    description.max_attribute_size = pipeline_json.contains("max_attribute_size")
+        ? static_cast<uint32_t>(pipeline_json["max_attribute_size"].get<int32_t>())
+        : 16u;
+
+    return description;
+}
+
+Pipeline_Description_Cache::Pipeline_Description_Cache(std::shared_ptr<Logger> logger, const std::filesystem::path& directory)
+    : m_logger(std::move(logger))
+    , m_directory(directory)
+    , m_is_enabled(true)
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error)
+    {
+        m_logger->warn("Failed to create pipeline cache directory '{}', pipeline descriptions are not cached.", m_directory.string());
+        m_is_enabled = false;
+    }
+}
+
+std::optional<Graphics_Pipeline_Description> Pipeline_Description_Cache::load_graphics(const std::filesystem::path& json_path) const
+{
+    return load<Graphics_Pipeline_Description>(json_path, Kind::Graphics, parse_graphics_pipeline_description);
+}
+
+std::optional<Ray_Tracing_Pipeline_Description> Pipeline_Description_Cache::load_ray_tracing(const std::filesystem::path& json_path) const
+{
+    return load<Ray_Tracing_Pipeline_Description>(json_path, Kind::Ray_Tracing, parse_ray_tracing_pipeline_description);
+}
+
+template<typename T, typename Parse_Fn>
+std::optional<T> Pipeline_Description_Cache::load(const std::filesystem::path& json_path, Kind kind, Parse_Fn&& parse) const
+{
+    std::error_code error;
+    const auto source_write_time = static_cast<int64_t>(
+        std::filesystem::last_write_time(json_path, error).time_since_epoch().count());
+    const auto source_size = error ? 0 : std::filesystem::file_size(json_path, error);
+    if (error)
+    {
+        m_logger->error("Failed to open pipeline description '{}'.", json_path.string());
+        return std::nullopt;
+    }
+
+    const auto entry_path = get_entry_path(json_path);
+    Pipeline_Description_Cache_Header header = {};
+    std::vector<uint8_t> payload;
+    const auto has_entry = m_is_enabled && read_entry(entry_path, static_cast<uint32_t>(kind), header, payload);
+    auto try_deserialize = [&](const uint64_t source_hash) -> std::optional<T>
+    {
+        T description = {};
+        Binary_Reader reader(payload);
+        if (!deserialize(reader, description))
+        {
+            return std::nullopt;
+        }
+        description.source_hash = source_hash;
+        return description;
+    };
+
+    // Unchanged file, the JSON is not even read.
+    if (has_entry && header.source_write_time == source_write_time && header.source_size == source_size)
+    {
+        if (auto description = try_deserialize(header.source_hash); description.has_value())
+        {
+            return description;
+        }
+    }
+
+    const auto json_data = load_file_binary_unsafe(json_path.string().c_str());
+    const auto json_text = std::string(json_data.begin(), json_data.end());
+    const auto source_hash = XXH3_64bits(json_text.data(), json_text.size());
+    const auto cached_hash = header.source_hash;
+    header = {
+        .magic = PIPELINE_DESCRIPTION_CACHE_MAGIC,
+        .version = PIPELINE_DESCRIPTION_CACHE_VERSION,
+        .kind = static_cast<uint32_t>(kind),
+        .reserved = 0,
+        .source_write_time = source_write_time,
+        .source_size = source_size,
+        .source_hash = source_hash,
+        .payload_size = 0
+    };
+
+    // Only the timestamp changed, e.g. after a checkout. The entry is rewritten to skip the hash next time.
+    if (has_entry && cached_hash == source_hash)
+    {
+        if (auto description = try_deserialize(source_hash); description.has_value())
+        {
+            header.payload_size = payload.size();
+            write_entry(entry_path, header, payload);
+            return description;
+        }
+    }
+
+    m_logger->debug("Parsing pipeline description '{}'", json_path.string());
+    auto description = parse(json_text, json_path.string(), *m_logger);
+    if (!description.has_value())
+    {
+        return description;
+    }
+    description->source_hash = source_hash;
+    if (!m_is_enabled)
+    {
+        return description;
+    }
+    Binary_Writer writer;
+    serialize(writer, description.value());
+    header.payload_size = writer.get_data().size();
+    if (!write_entry(entry_path, header, writer.get_data()))
+    {
+        m_logger->warn("Failed to write pipeline cache entry '{}'.", entry_path.string());
+    }
+    return description;
+}
+
+std::filesystem::path Pipeline_Description_Cache::get_entry_path(const std::filesystem::path& json_path) const
+{
+    const auto canonical_path = std::filesystem::weakly_canonical(json_path).string();
+    return m_directory / std::format("{:016x}.pipeline", XXH3_64bits(canonical_path.data(), canonical_path.size()));
+}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <rhi/resource.hpp>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "renderer/logger.hpp"
+
+namespace ren
+{
+struct Pipeline_Shader_Description
+{
+    std::string library; // Empty if the stage is unused
+    std::string variant; // Empty selects the default variant
+};
+
+// Pipeline JSON translated into the `rhi` create info state, the shaders are still referenced by name.
+struct Graphics_Pipeline_Description
+{
+    std::string name;
+    uint64_t source_hash; // Hash of the JSON, not serialized
+    Pipeline_Shader_Description ts;
+    Pipeline_Shader_Description ms;
+    Pipeline_Shader_Description vs;
+    Pipeline_Shader_Description ps;
+    rhi::Pipeline_Blend_State_Info blend_state_info{};
+    rhi::Primitive_Topology_Type primitive_topology{};
+    rhi::Pipeline_Rasterization_State_Info rasterizer_state_info{};
+    rhi::Pipeline_Depth_Stencil_State_Info depth_stencil_info{};
+    std::array<rhi::Image_Format, rhi::PIPELINE_COLOR_ATTACHMENTS_MAX> color_attachments{};
+    uint32_t color_attachment_count = 0;
+    rhi::Image_Format depth_stencil_format{};
+};
+
+struct Ray_Tracing_Pipeline_Shader_Description
+{
+    Pipeline_Shader_Description shader;
+    rhi::Ray_Tracing_Shader_Type type;
+};
+
+struct Ray_Tracing_Pipeline_Description
+{
+    std::string name;
+    uint64_t source_hash; // Hash of the JSON, not serialized
+    std::vector<Ray_Tracing_Pipeline_Shader_Description> shaders;
+    std::vector<rhi::Ray_Tracing_Hit_Group> hit_groups;
+    std::vector<uint32_t> ray_gen_libraries;
+    std::vector<uint32_t> miss_libraries;
+    std::vector<uint32_t> callable_libraries;
+    uint32_t max_recursion_depth;
+    uint32_t max_payload_size;
+    uint32_t max_attribute_size;
+};
+
+// Both return std::nullopt and log the reason if the description is invalid.
+[[nodiscard]] std::optional<Graphics_Pipeline_Description> parse_graphics_pipeline_description(
+    const std::string& json_text, const std::string& json_path, Logger& logger);
+[[nodiscard]] std::optional<Ray_Tracing_Pipeline_Description> parse_ray_tracing_pipeline_description(
+    const std::string& json_text, const std::string& json_path, Logger& logger);
+
+// Binary cache of parsed pipeline descriptions.
+// The JSON is only read again if its timestamp or size changed, and only parsed again if its hash changed.
+class Pipeline_Description_Cache
+{
+public:
+    Pipeline_Description_Cache(std::shared_ptr<Logger> logger, const std::filesystem::path& directory);
+
+    [[nodiscard]] std::optional<Graphics_Pipeline_Description> load_graphics(const std::filesystem::path& json_path) const;
+    [[nodiscard]] std::optional<Ray_Tracing_Pipeline_Description> load_ray_tracing(const std::filesystem::path& json_path) const;
+
+private:
+    enum class Kind : uint32_t
+    {
+        Graphics,
+        Ray_Tracing
+    };
+
+    template<typename T, typename Parse_Fn>
+    [[nodiscard]] std::optional<T> load(const std::filesystem::path& json_path, Kind kind, Parse_Fn&& parse) const;
+    [[nodiscard]] std::filesystem::path get_entry_path(const std::filesystem::path& json_path) const;
+
+private:
+    std::shared_ptr<Logger> m_logger;
+    std::filesystem::path m_directory;
+    bool m_is_enabled;
+};
+}
@@ -0,0 +1,270 @@
+#include "renderer/asset/shader_cache.hpp"
+#include "renderer/filesystem/file_util.hpp"
+
+#include <rhi_dxc_lib/shader_compiler.hpp>
+#include <xxhash.h>
+
+#include <ankerl/unordered_dense.h>
+#include <format>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace ren
+{
+namespace
+{
+// Bump whenever the DXC submodule, the compile flags or the entry layout changes.
+constexpr static uint32_t SHADER_CACHE_VERSION = 1;
+constexpr static uint32_t SHADER_CACHE_MAGIC = 0x43485352; // 'RSHC'
+
+struct Shader_Cache_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t groups_x;
+    uint32_t groups_y;
+    uint32_t groups_z;
+    uint32_t dxil_size;
+    uint32_t spirv_size;
+    uint32_t reserved;
+};
+
+std::string_view extract_include_name(std::string_view line)
+{
+    const auto directive_pos = line.find("#include");
+    if (directive_pos == std::string_view::npos)
+    {
+        return {};
+    }
+    const auto start = line.find_first_of("\"<", directive_pos);
+    if (start == std::string_view::npos)
+    {
+        return {};
+    }
+    const auto end = line.find_first_of("\">", start + 1);
+    if (end == std::string_view::npos)
+    {
+        return {};
+    }
+    return line.substr(start + 1, end - start - 1);
+}
+
+void hash_source_recursive(
+    XXH3_state_t* state,
+    const std::filesystem::path& path,
+    const std::vector<std::filesystem::path>& include_dirs,
+    ankerl::unordered_dense::set<std::string>& visited)
+{
+    auto canonical_path = std::filesystem::weakly_canonical(path).string();
+    if (visited.contains(canonical_path))
+    {
+        return;
+    }
+    visited.insert(std::move(canonical_path));
+
+    const auto text = load_file_as_string_unsafe(path.string().c_str());
+    XXH3_64bits_update(state, text.data(), text.size());
+
+    std::size_t line_start = 0;
+    while (line_start < text.size())
+    {
+        auto line_end = text.find('\n', line_start);
+        if (line_end == std::string::npos)
+        {
+            line_end = text.size();
+        }
+        const auto include_name = extract_include_name(std::string_view(text).substr(line_start, line_end - line_start));
+        line_start = line_end + 1;
+        if (include_name.empty())
+        {
+            continue;
+        }
+
+        std::filesystem::path include_path = path.parent_path() / include_name;
+        for (auto i = 0ull; i < include_dirs.size() && !std::filesystem::exists(include_path); ++i)
+        {
+            include_path = include_dirs[i] / include_name;
+        }
+        if (std::filesystem::exists(include_path))
+        {
+            hash_source_recursive(state, include_path, include_dirs, visited);
+        }
+        else
+        {
+            XXH3_64bits_update(state, include_name.data(), include_name.size());
+        }
+    }
+}
+
+template<typename T>
+void hash_value(XXH3_state_t* state, const T& value)
+{
+    XXH3_64bits_update(state, &value, sizeof(T));
+}
+
+void hash_wstring(XXH3_state_t* state, const std::wstring& value)
+{
+    hash_value(state, value.size());
+    XXH3_64bits_update(state, value.data(), value.size() * sizeof(wchar_t));
+}
+}
+
+Shader_Cache::Shader_Cache(std::shared_ptr<Logger> logger, const std::filesystem::path& directory)
+    : m_logger(std::move(logger))
+    , m_directory(directory)
+    , m_is_enabled(true)
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error)
+    {
+        m_logger->warn("Failed to create shader cache directory '{}', shader caching is disabled.", m_directory.string());
+        m_is_enabled = false;
+    }
+}
+
+uint64_t Shader_Cache::hash_source(
+    const std::filesystem::path& path,
+    const std::vector<std::filesystem::path>& include_dirs,
+    std::vector<std::string>* dependencies) const
+{
+    auto* state = XXH3_createState();
+    XXH3_64bits_reset(state);
+    ankerl::unordered_dense::set<std::string> visited;
+    hash_source_recursive(state, path, include_dirs, visited);
+    const auto result = XXH3_64bits_digest(state);
+    XXH3_freeState(state);
+    if (dependencies)
+    {
+        *dependencies = visited.extract();
+    }
+    return result;
+}
+
+uint64_t Shader_Cache::compute_key(
+    uint64_t source_hash,
+    const rhi::dxc::Shader_Compiler_Settings& settings,
+    const rhi::dxc::Shader_Compile_Info& compile_info)
+{
+    auto* state = XXH3_createState();
+    XXH3_64bits_reset(state);
+    hash_value(state, SHADER_CACHE_VERSION);
+    hash_value(state, source_hash);
+    hash_wstring(state, compile_info.entrypoint);
+    hash_value(state, compile_info.matrix_majorness);
+    hash_value(state, compile_info.shader_type);
+    hash_value(state, compile_info.version);
+    hash_value(state, compile_info.embed_debug);
+    hash_value(state, settings.defines.size());
+    for (const auto& define : settings.defines)
+    {
+        hash_wstring(state, define);
+    }
+    const auto result = XXH3_64bits_digest(state);
+    XXH3_freeState(state);
+    return result;
+}
+
+bool Shader_Cache::is_enabled() const
+{
+    return m_is_enabled;
+}
+
+bool Shader_Cache::contains(uint64_t key) const
+{
+    std::error_code error;
+    return m_is_enabled && std::filesystem::exists(get_entry_path(key), error);
+}
+
+std::optional<Shader_Cache_Entry> Shader_Cache::load(uint64_t key) const
+{
+    if (!m_is_enabled)
+    {
+        return std::nullopt;
+    }
+
+    std::ifstream file(get_entry_path(key), std::ios::binary);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+
+    Shader_Cache_Header header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file
+        || header.magic != SHADER_CACHE_MAGIC
+        || header.version != SHADER_CACHE_VERSION
+        || header.key != key)
+    {
+        m_logger->warn("Ignoring invalid shader cache entry '{:016x}'.", key);
+        return std::nullopt;
+    }
+
+    Shader_Cache_Entry entry = {
+        .dxil = std::vector<uint8_t>(header.dxil_size),
+        .spirv = std::vector<uint8_t>(header.spirv_size),
+        .groups_x = header.groups_x,
+        .groups_y = header.groups_y,
+        .groups_z = header.groups_z
+    };
+    file.read(reinterpret_cast<char*>(entry.dxil.data()), static_cast<std::streamsize>(entry.dxil.size()));
+    file.read(reinterpret_cast<char*>(entry.spirv.data()), static_cast<std::streamsize>(entry.spirv.size()));
+    if (!file)
+    {
+        m_logger->warn("Ignoring truncated shader cache entry '{:016x}'.", key);
+        return std::nullopt;
+    }
+    return entry;
+}
+
+void Shader_Cache::store(uint64_t key, const Shader_Cache_Entry& entry) const
+{
+    if (!m_is_enabled)
+    {
+        return;
+    }
+
+    const auto entry_path = get_entry_path(key);
+    auto temporary_path = entry_path;
+    temporary_path += "." + std::to_string(std::random_device()()) + ".tmp";
+
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            m_logger->warn("Failed to write shader cache entry '{}'.", temporary_path.string());
+            return;
+        }
+        const Shader_Cache_Header header = {
+            .magic = SHADER_CACHE_MAGIC,
+            .version = SHADER_CACHE_VERSION,
+            .key = key,
+            .groups_x = entry.groups_x,
+            .groups_y = entry.groups_y,
+            .groups_z = entry.groups_z,
+            .dxil_size = static_cast<uint32_t>(entry.dxil.size()),
+            .spirv_size = static_cast<uint32_t>(entry.spirv.size()),
+            .reserved = 0
+        };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entry.dxil.data()), static_cast<std::streamsize>(entry.dxil.size()));
+        file.write(reinterpret_cast<const char*>(entry.spirv.data()), static_cast<std::streamsize>(entry.spirv.size()));
+    }
+
+    // Another process may have written the same entry in the meantime, the contents are identical then.
+    std::error_code error;
+    std::filesystem::rename(temporary_path, entry_path, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary_path, error);
+    }
+}
+
+std::filesystem::path Shader_Cache::get_entry_path(uint64_t key) const
+{
+    return m_directory / std::format("{:016x}.shader", key);
+}
+}
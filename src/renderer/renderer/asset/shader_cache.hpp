@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "renderer/logger.hpp"
+
+namespace rhi::dxc
+{
+struct Shader_Compiler_Settings;
+struct Shader_Compile_Info;
+}
+
+namespace ren
+{
+struct Shader_Cache_Entry
+{
+    std::vector<uint8_t> dxil;
+    std::vector<uint8_t> spirv;
+    uint32_t groups_x;
+    uint32_t groups_y;
+    uint32_t groups_z;
+};
+
+// Content addressed cache of compiled shaders on disk.
+// Entries are written to a temporary file first and then renamed, so processes can share the directory.
+class Shader_Cache
+{
+public:
+    Shader_Cache(std::shared_ptr<Logger> logger, const std::filesystem::path& directory);
+
+    // Hashes the file and everything it includes. Includes are resolved relative to the including file first,
+    // then in `include_dirs`. Includes that can't be found only contribute their name.
+    // If `dependencies` is set, the canonical paths of the file and all resolved includes are written to it.
+    [[nodiscard]] uint64_t hash_source(
+        const std::filesystem::path& path,
+        const std::vector<std::filesystem::path>& include_dirs,
+        std::vector<std::string>* dependencies = nullptr) const;
+
+    [[nodiscard]] static uint64_t compute_key(
+        uint64_t source_hash,
+        const rhi::dxc::Shader_Compiler_Settings& settings,
+        const rhi::dxc::Shader_Compile_Info& compile_info);
+
+    [[nodiscard]] bool is_enabled() const;
+    [[nodiscard]] bool contains(uint64_t key) const;
+    [[nodiscard]] std::optional<Shader_Cache_Entry> load(uint64_t key) const;
+    void store(uint64_t key, const Shader_Cache_Entry& entry) const;
+
+private:
+    [[nodiscard]] std::filesystem::path get_entry_path(uint64_t key) const;
+
+private:
+    std::shared_ptr<Logger> m_logger;
+    std::filesystem::path m_directory;
+    bool m_is_enabled;
+};
+}
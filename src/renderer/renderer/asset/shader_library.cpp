@@ -4,7 +4,7 @@ namespace ren
 {
 rhi::Shader_Blob* Shader_Library::get_shader(const std::string_view& name) const
 {
-    for (const auto& [shader_name, shader] : shaders)
+    for (const auto& [shader_name, shader, bytecode_hash] : shaders)
     {
         if (shader_name == name)
         {
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -17,16 +18,19 @@ struct Compute_Library;
 struct Named_Shader
 {
     std::string name;
-    rhi::Shader_Blob* blob;
+    rhi::Shader_Blob* blob; // Null until the variant is compiled
+    uint64_t bytecode_hash;
 };
 
 struct Shader_Library
 {
-    std::vector<Named_Shader> shaders;
+    std::string name; // Lookup name, e.g. 'fft.cs'
+    std::vector<Named_Shader> shaders; // All declared variants, only the requested ones are compiled
     std::vector<Graphics_Pipeline_Library*> referenced_pipeline_libraries;
     std::vector<Ray_Tracing_Pipeline_Library*> referenced_ray_tracing_pipeline_libraries;
     Compute_Library* referenced_compute_library;
     std::string hlsl_path;
+    std::vector<std::string> dependencies; // Canonical paths of the HLSL file and everything it includes
 
     // TODO: If there are a lot of shaders this should be a map and not a vector with linear search. However, right now this suffices
     [[nodiscard]] rhi::Shader_Blob* get_shader(const std::string_view& name) const;
@@ -1,10 +1,148 @@
 #include "renderer/filesystem/file_watch.hpp"
 
 #include <array>
+#include <cerrno>
+
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 namespace ren
 {
+// A path that keeps changing is still reported after this many debounce windows.
+constexpr static auto MAX_DEBOUNCE_WINDOWS = 10;
+
+File_Watch::File_Watch(const std::filesystem::path& path, const std::chrono::milliseconds debounce)
+    : m_path(path)
+    , m_debounce(debounce)
+    , m_snapshot(take_snapshot())
+{}
+
+std::vector<File_Watch_Notification> File_Watch::poll_for_changes()
+{
+    std::vector<File_Watch_Notification> events;
+    if (!read_changes(events))
+    {
+        rescan(events);
+    }
+    const auto now = Clock::now();
+    for (auto& event : events)
+    {
+        coalesce(std::move(event), now);
+    }
+
+    std::vector<File_Watch_Notification> notifications;
+    std::vector<std::string> settled_paths;
+    for (auto& [path, pending] : m_pending)
+    {
+        if (now - pending.last_event >= m_debounce || now - pending.first_event >= MAX_DEBOUNCE_WINDOWS * m_debounce)
+        {
+            notifications.push_back(std::move(pending.notification));
+            settled_paths.push_back(path);
+        }
+    }
+    for (const auto& path : settled_paths)
+    {
+        m_pending.erase(path);
+    }
+    return notifications;
+}
+
+File_Watch::Snapshot File_Watch::take_snapshot() const
+{
+    Snapshot snapshot;
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(
+            m_path, std::filesystem::directory_options::skip_permission_denied, error);
+        !error && it != std::filesystem::recursive_directory_iterator();
+        it.increment(error))
+    {
+        if (!it->is_regular_file(error))
+        {
+            continue;
+        }
+        snapshot[it->path().lexically_relative(m_path).generic_string()] = {
+            .write_time = it->last_write_time(error),
+            .size = it->file_size(error)
+        };
+    }
+    return snapshot;
+}
+
+void File_Watch::rescan(std::vector<File_Watch_Notification>& notifications)
+{
+    // The snapshot is not updated by regular events, so files changed since the last rescan are reported again.
+    // That only costs a redundant reload and keeps regular polling free of filesystem queries.
+    auto snapshot = take_snapshot();
+    for (const auto& [path, entry] : snapshot)
+    {
+        const auto it = m_snapshot.find(path);
+        if (it == m_snapshot.end())
+        {
+            notifications.push_back({ .type = File_Notification_Type::Create, .old_path = {}, .path = path });
+        }
+        else if (it->second.write_time != entry.write_time || it->second.size != entry.size)
+        {
+            notifications.push_back({ .type = File_Notification_Type::Modify, .old_path = {}, .path = path });
+        }
+    }
+    for (const auto& [path, entry] : m_snapshot)
+    {
+        if (!snapshot.contains(path))
+        {
+            notifications.push_back({ .type = File_Notification_Type::Remove, .old_path = {}, .path = path });
+        }
+    }
+    m_snapshot = std::move(snapshot);
+}
+
+void File_Watch::coalesce(File_Watch_Notification&& notification, const Clock::time_point now)
+{
+    if (notification.type == File_Notification_Type::Invalid)
+    {
+        return;
+    }
+    if (notification.type == File_Notification_Type::Rename)
+    {
+        // Pending changes of the old path move with the file, a file created in this window is reported as created.
+        const auto old_it = m_pending.find(notification.old_path.generic_string());
+        if (old_it != m_pending.end())
+        {
+            if (old_it->second.notification.type == File_Notification_Type::Create)
+            {
+                notification.type = File_Notification_Type::Create;
+                notification.old_path.clear();
+            }
+            m_pending.erase(old_it);
+        }
+    }
+    const auto [it, is_new] = m_pending.try_emplace(notification.path.generic_string());
+    auto& pending = it->second;
+    pending.last_event = now;
+    if (is_new)
+    {
+        pending.first_event = now;
+        pending.notification = std::move(notification);
+        return;
+    }
+    // A file that was created or renamed and then written is still reported as created or renamed.
+    const auto type = pending.notification.type;
+    if (notification.type == File_Notification_Type::Modify
+        && (type == File_Notification_Type::Create || type == File_Notification_Type::Rename))
+    {
+        return;
+    }
+    pending.notification.type = notification.type;
+    if (!notification.old_path.empty())
+    {
+        pending.notification.old_path = std::move(notification.old_path);
+    }
+}
+
+#ifdef _WIN32
 constexpr static auto FILTERS =
     FILE_NOTIFY_CHANGE_FILE_NAME  | FILE_NOTIFY_CHANGE_DIR_NAME |
     FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION;
@@ -31,7 +169,8 @@ File_Notification_Type translate_notification_type(DWORD action)
 class File_Watch_Win32 final : public File_Watch
 {
 public:
-    File_Watch_Win32(const std::filesystem::path& path)
+    File_Watch_Win32(const std::filesystem::path& path, const std::chrono::milliseconds debounce)
+        : File_Watch(path, debounce)
     {
         auto path_str = path.string();
 
@@ -62,52 +201,236 @@ public:
         }
     }
 
-    virtual std::vector<File_Watch_Notification> poll_for_changes() override
+protected:
+    bool read_changes(std::vector<File_Watch_Notification>& notifications) override
     {
-        if (m_dir_handle == INVALID_HANDLE_VALUE) return {};
+        if (m_dir_handle == INVALID_HANDLE_VALUE) return true;
 
-        if (WaitForSingleObject(m_overlapped.hEvent, 0) == WAIT_OBJECT_0)
+        if (WaitForSingleObject(m_overlapped.hEvent, 0) != WAIT_OBJECT_0)
         {
-            DWORD bytes_returned = 0;
-            bool success = GetOverlappedResult(m_dir_handle, &m_overlapped, &bytes_returned, true);
-            if (success && bytes_returned > 0)
-            {
-                std::vector<File_Watch_Notification> notifications;
-                FILE_NOTIFY_INFORMATION* notify_info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(m_buffer.data());
-                std::filesystem::path old_path;
-                bool process_next = true;
-                while (process_next) {
-                    process_next = notify_info->NextEntryOffset != 0;
-                    if (notify_info->Action != FILE_ACTION_RENAMED_OLD_NAME)
-                    {
-                        notifications.push_back({
-                            .type = translate_notification_type(notify_info->Action),
-                            .old_path = notify_info->Action == FILE_ACTION_RENAMED_NEW_NAME ? old_path : "",
-                            .path = std::wstring(notify_info->FileName, notify_info->FileNameLength / sizeof(wchar_t)) });
-                    }
-                    else
-                    {
-                        old_path = std::wstring(notify_info->FileName, notify_info->FileNameLength / sizeof(wchar_t));
-                    }
-                    notify_info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(reinterpret_cast<BYTE*>(notify_info)
-                        + notify_info->NextEntryOffset);
-                };
-                ReadDirectoryChangesW(m_dir_handle, m_buffer.data(), m_buffer.size(),
-                    true, FILTERS, nullptr, &m_overlapped, nullptr);
-                return notifications;
-            }
+            return true;
+        }
+        DWORD bytes_returned = 0;
+        const bool success = GetOverlappedResult(m_dir_handle, &m_overlapped, &bytes_returned, true);
+        // No bytes are returned if the events did not fit into the buffer.
+        const auto is_complete = success && bytes_returned > 0;
+        if (is_complete)
+        {
+            FILE_NOTIFY_INFORMATION* notify_info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(m_buffer.data());
+            std::filesystem::path old_path;
+            bool process_next = true;
+            while (process_next) {
+                process_next = notify_info->NextEntryOffset != 0;
+                if (notify_info->Action != FILE_ACTION_RENAMED_OLD_NAME)
+                {
+                    notifications.push_back({
+                        .type = translate_notification_type(notify_info->Action),
+                        .old_path = notify_info->Action == FILE_ACTION_RENAMED_NEW_NAME ? old_path : "",
+                        .path = std::wstring(notify_info->FileName, notify_info->FileNameLength / sizeof(wchar_t)) });
+                }
+                else
+                {
+                    old_path = std::wstring(notify_info->FileName, notify_info->FileNameLength / sizeof(wchar_t));
+                }
+                notify_info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(reinterpret_cast<BYTE*>(notify_info)
+                    + notify_info->NextEntryOffset);
+            };
         }
-        return {};
+        ReadDirectoryChangesW(m_dir_handle, m_buffer.data(), m_buffer.size(),
+            true, FILTERS, nullptr, &m_overlapped, nullptr);
+        return is_complete;
     }
 
 private:
     HANDLE m_dir_handle = NULL;
     OVERLAPPED m_overlapped = {};
-    alignas(DWORD) std::array<uint8_t, 8192> m_buffer = {};
+    // 64 KiB is the limit for watches on network shares.
+    alignas(DWORD) std::array<uint8_t, 65536> m_buffer = {};
+};
+
+std::expected<std::unique_ptr<File_Watch>, std::error_code> File_Watch::create(const std::filesystem::path& path,
+    const std::chrono::milliseconds debounce)
+{
+    return std::make_unique<File_Watch_Win32>(path, debounce);
+}
+#else
+constexpr static uint32_t INOTIFY_MASK =
+    IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE |
+    IN_MOVED_FROM | IN_MOVED_TO | IN_EXCL_UNLINK;
+
+// inotify is not recursive, every directory of the tree gets its own watch.
+class File_Watch_Inotify final : public File_Watch
+{
+public:
+    // Takes ownership of the inotify instance `fd`.
+    File_Watch_Inotify(const std::filesystem::path& path, const std::chrono::milliseconds debounce, const int fd)
+        : File_Watch(path, debounce)
+        , m_fd(fd)
+    {
+        add_watches({}, nullptr);
+    }
+
+    ~File_Watch_Inotify() override
+    {
+        close(m_fd);
+    }
+
+protected:
+    bool read_changes(std::vector<File_Watch_Notification>& notifications) override
+    {
+        auto is_complete = true;
+        ankerl::unordered_dense::map<uint32_t, std::filesystem::path> moved_from;
+        while (true)
+        {
+            const auto length = read(m_fd, m_buffer.data(), m_buffer.size());
+            if (length <= 0)
+            {
+                break;
+            }
+            for (auto offset = 0ll; offset < length;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(m_buffer.data() + offset);
+                offset += static_cast<long long>(sizeof(inotify_event) + event->len);
+                is_complete &= process_event(*event, moved_from, notifications);
+            }
+        }
+        // The other half of these moves is outside of the watched tree.
+        for (auto& [cookie, path] : moved_from)
+        {
+            notifications.push_back({ .type = File_Notification_Type::Remove, .old_path = {}, .path = std::move(path) });
+        }
+        return is_complete;
+    }
+
+private:
+    bool process_event(
+        const inotify_event& event,
+        ankerl::unordered_dense::map<uint32_t, std::filesystem::path>& moved_from,
+        std::vector<File_Watch_Notification>& notifications)
+    {
+        if (event.mask & IN_Q_OVERFLOW)
+        {
+            return false;
+        }
+        if (event.mask & IN_IGNORED)
+        {
+            m_directories.erase(event.wd);
+            return true;
+        }
+        const auto directory = m_directories.find(event.wd);
+        if (directory == m_directories.end())
+        {
+            return true;
+        }
+        const auto path = event.len > 0 ? directory->second / event.name : directory->second;
+
+        if (event.mask & IN_ISDIR)
+        {
+            if (event.mask & (IN_CREATE | IN_MOVED_TO))
+            {
+                // Files may have been written before the watch was added.
+                add_watches(path, &notifications);
+            }
+            else if (event.mask & IN_MOVED_FROM)
+            {
+                // The watches below the directory still carry its old path, the rescan reports its files as removed.
+                remove_watches(path);
+                return false;
+            }
+            return true;
+        }
+
+        if (event.mask & IN_CREATE)
+        {
+            notifications.push_back({ .type = File_Notification_Type::Create, .old_path = {}, .path = path });
+        }
+        else if (event.mask & (IN_MODIFY | IN_CLOSE_WRITE))
+        {
+            notifications.push_back({ .type = File_Notification_Type::Modify, .old_path = {}, .path = path });
+        }
+        else if (event.mask & IN_DELETE)
+        {
+            notifications.push_back({ .type = File_Notification_Type::Remove, .old_path = {}, .path = path });
+        }
+        else if (event.mask & IN_MOVED_FROM)
+        {
+            moved_from[event.cookie] = path;
+        }
+        else if (event.mask & IN_MOVED_TO)
+        {
+            if (const auto it = moved_from.find(event.cookie); it != moved_from.end())
+            {
+                notifications.push_back({ .type = File_Notification_Type::Rename, .old_path = it->second, .path = path });
+                moved_from.erase(it);
+            }
+            else
+            {
+                notifications.push_back({ .type = File_Notification_Type::Create, .old_path = {}, .path = path });
+            }
+        }
+        return true;
+    }
+
+    // Watches `relative_directory` and everything below it. If `created` is set, the files found are reported as created.
+    void add_watches(const std::filesystem::path& relative_directory, std::vector<File_Watch_Notification>* created)
+    {
+        const auto directory = get_path() / relative_directory;
+        const auto wd = inotify_add_watch(m_fd, directory.c_str(), INOTIFY_MASK | IN_ONLYDIR);
+        if (wd < 0)
+        {
+            return;
+        }
+        m_directories[wd] = relative_directory;
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            const auto relative_path = relative_directory / entry.path().filename();
+            if (entry.is_directory(error))
+            {
+                add_watches(relative_path, created);
+            }
+            else if (created && entry.is_regular_file(error))
+            {
+                created->push_back({ .type = File_Notification_Type::Create, .old_path = {}, .path = relative_path });
+            }
+        }
+    }
+
+    void remove_watches(const std::filesystem::path& relative_directory)
+    {
+        std::vector<int> removed;
+        for (const auto& [wd, path] : m_directories)
+        {
+            const auto relative = path.lexically_relative(relative_directory);
+            if (!relative.empty() && *relative.begin() != "..")
+            {
+                removed.push_back(wd);
+            }
+        }
+        for (const auto wd : removed)
+        {
+            inotify_rm_watch(m_fd, wd);
+            m_directories.erase(wd);
+        }
+    }
+
+private:
+    int m_fd;
+    ankerl::unordered_dense::map<int, std::filesystem::path> m_directories; // Relative to the watched directory
+    alignas(inotify_event) std::array<char, 65536> m_buffer = {};
 };
 
-std::unique_ptr<File_Watch> File_Watch::create(const std::filesystem::path& path)
+std::expected<std::unique_ptr<File_Watch>, std::error_code> File_Watch::create(const std::filesystem::path& path,
+    const std::chrono::milliseconds debounce)
 {
-    return std::make_unique<File_Watch_Win32>(path);
+    // Fails once the per user limit of inotify instances is reached.
+    const auto fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        return std::unexpected(std::error_code(errno, std::generic_category()));
+    }
+    return std::make_unique<File_Watch_Inotify>(path, debounce, fd);
 }
+#endif
 }
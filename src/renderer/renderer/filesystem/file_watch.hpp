@@ -1,7 +1,13 @@
 #pragma once
 
+#include <ankerl/unordered_dense.h>
+
+#include <chrono>
+#include <expected>
 #include <filesystem>
 #include <memory>
+#include <string>
+#include <system_error>
 #include <vector>
 
 namespace ren
@@ -19,15 +25,58 @@ struct File_Watch_Notification
 {
     File_Notification_Type type;
     std::filesystem::path old_path;
-    std::filesystem::path path;
+    std::filesystem::path path; // Relative to the watched directory
 };
 
+// Recursively watches a directory. Bursts of events for the same path, like an editor saving through
+// a temporary file or the baker writing a file in chunks, are coalesced into one notification
+// that is only returned once the path did not change for the debounce window.
 class File_Watch
 {
 public:
-    static std::unique_ptr<File_Watch> create(const std::filesystem::path& path);
+    constexpr static auto DEFAULT_DEBOUNCE = std::chrono::milliseconds(100);
+
+    // Fails if the backend can't start watching.
+    static std::expected<std::unique_ptr<File_Watch>, std::error_code> create(const std::filesystem::path& path,
+        std::chrono::milliseconds debounce = DEFAULT_DEBOUNCE);
     virtual ~File_Watch() = default;
 
-    virtual std::vector<File_Watch_Notification> poll_for_changes() = 0;
+    std::vector<File_Watch_Notification> poll_for_changes();
+
+protected:
+    File_Watch(const std::filesystem::path& path, std::chrono::milliseconds debounce);
+
+    // Appends the events since the last call. Returns false if the backend lost events,
+    // the changes are then recovered by rescanning the directory.
+    virtual bool read_changes(std::vector<File_Watch_Notification>& notifications) = 0;
+
+    [[nodiscard]] const std::filesystem::path& get_path() const { return m_path; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending_Notification
+    {
+        File_Watch_Notification notification;
+        Clock::time_point first_event;
+        Clock::time_point last_event;
+    };
+
+    struct Snapshot_Entry
+    {
+        std::filesystem::file_time_type write_time;
+        std::uintmax_t size;
+    };
+    using Snapshot = ankerl::unordered_dense::map<std::string, Snapshot_Entry>;
+
+    [[nodiscard]] Snapshot take_snapshot() const;
+    void rescan(std::vector<File_Watch_Notification>& notifications);
+    void coalesce(File_Watch_Notification&& notification, Clock::time_point now);
+
+private:
+    std::filesystem::path m_path;
+    std::chrono::milliseconds m_debounce;
+    Snapshot m_snapshot; // State at creation or at the last rescan
+    ankerl::unordered_dense::map<std::string, Pending_Notification> m_pending;
 };
 }
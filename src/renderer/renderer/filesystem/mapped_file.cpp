@@ -1,21 +1,108 @@
 #include "renderer/filesystem/mapped_file.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
 #include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace ren
 {
-void Mapped_File::map(const char* path)
+namespace
 {
+std::size_t get_page_size()
+{
+#ifdef _WIN32
+    SYSTEM_INFO system_info = {};
+    GetSystemInfo(&system_info);
+    return system_info.dwPageSize;
+#else
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+void touch_pages(const void* data, const std::size_t size)
+{
+    const auto page_size = get_page_size();
+    const auto* bytes = static_cast<const volatile uint8_t*>(data);
+    for (auto offset = 0ull; offset < size; offset += page_size)
+    {
+        static_cast<void>(bytes[offset]);
+    }
+}
+
+#ifndef _WIN32
+// File backed transparent huge pages require the mapping to be aligned to the huge page size,
+// so a larger range is reserved and the file is mapped into its aligned part.
+void* map_huge_page_aligned(const int fd, const std::size_t size)
+{
+    const auto reservation_size = size + Mapped_File::HUGE_PAGE_MIN_SIZE;
+    auto* reservation = static_cast<uint8_t*>(
+        mmap(nullptr, reservation_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (reservation == MAP_FAILED)
+    {
+        return MAP_FAILED;
+    }
+    const auto aligned_address = (reinterpret_cast<uintptr_t>(reservation) + Mapped_File::HUGE_PAGE_MIN_SIZE - 1)
+        & ~(uintptr_t(Mapped_File::HUGE_PAGE_MIN_SIZE) - 1);
+    auto* aligned = reinterpret_cast<uint8_t*>(aligned_address);
+    if (mmap(aligned, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(reservation, reservation_size);
+        return MAP_FAILED;
+    }
+    const auto page_size = get_page_size();
+    auto* mapping_end = aligned + (size + page_size - 1) / page_size * page_size;
+    if (aligned > reservation)
+    {
+        munmap(reservation, aligned - reservation);
+    }
+    if (reservation + reservation_size > mapping_end)
+    {
+        munmap(mapping_end, reservation + reservation_size - mapping_end);
+    }
+    return aligned;
+}
+#endif
+}
+
+void Mapped_File::map(const char* path, const Mapped_File_Options& options)
+{
+    data = nullptr;
+    size = 0;
+    handle_file = nullptr;
+    handle_map = nullptr;
+
+#ifdef _WIN32
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (options.access_pattern == Mapped_File_Access_Pattern::Sequential)
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    else if (options.access_pattern == Mapped_File_Access_Pattern::Random)
+        flags |= FILE_FLAG_RANDOM_ACCESS;
     handle_file = CreateFile(
         path,
         GENERIC_READ,
-        0,
+        FILE_SHARE_READ,
         nullptr,
         OPEN_EXISTING,
-        FILE_ATTRIBUTE_NORMAL,
+        flags,
     nullptr);
+    LARGE_INTEGER file_size = {};
+    if (handle_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle_file, &file_size) || file_size.QuadPart == 0)
+    {
+        unmap();
+        return;
+    }
+    size = static_cast<std::size_t>(file_size.QuadPart);
     handle_map = CreateFileMapping(
         handle_file,
         nullptr,
@@ -23,18 +110,130 @@ void Mapped_File::map(const char* path)
         0,
         0,
         nullptr);
-    data = MapViewOfFile(
-        handle_map,
-        FILE_MAP_READ,
-        0, 0, 0);
+    // Views of file mappings can not use large pages, `huge_pages` has no effect here.
+    data = handle_map
+        ? MapViewOfFile(
+            handle_map,
+            FILE_MAP_READ,
+            0, 0, 0)
+        : nullptr;
+    if (!data)
+    {
+        unmap();
+        return;
+    }
+    if (options.populate)
+    {
+        prefetch();
+        touch_pages(data, size);
+    }
+#else
+    const auto fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat file_stat = {};
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        close(fd);
+        return;
+    }
+    size = static_cast<std::size_t>(file_stat.st_size);
+
+    const auto use_huge_pages = options.huge_pages && size >= HUGE_PAGE_MIN_SIZE;
+    void* mapping = MAP_FAILED;
+    if (use_huge_pages)
+    {
+        mapping = map_huge_page_aligned(fd, size);
+    }
+    if (mapping == MAP_FAILED)
+    {
+        // Huge pages are advised before populating, so they are populated separately below.
+        const auto populate_flag = options.populate && !use_huge_pages ? MAP_POPULATE : 0;
+        mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | populate_flag, fd, 0);
+    }
+    // The mapping keeps the file referenced.
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        size = 0;
+        return;
+    }
+    data = mapping;
+
+    if (options.access_pattern == Mapped_File_Access_Pattern::Sequential)
+        madvise(data, size, MADV_SEQUENTIAL);
+    else if (options.access_pattern == Mapped_File_Access_Pattern::Random)
+        madvise(data, size, MADV_RANDOM);
+#ifdef MADV_HUGEPAGE
+    if (use_huge_pages)
+    {
+        madvise(data, size, MADV_HUGEPAGE);
+    }
+#endif
+    if (options.populate && use_huge_pages)
+    {
+#ifdef MADV_POPULATE_READ
+        if (madvise(data, size, MADV_POPULATE_READ) != 0)
+#endif
+        {
+            touch_pages(data, size);
+        }
+    }
+#endif
 }
 
 void Mapped_File::unmap()
 {
-    CloseHandle(handle_map);
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+    if (handle_map)
+        CloseHandle(handle_map);
     handle_map = nullptr;
-    CloseHandle(handle_file);
+    if (handle_file && handle_file != INVALID_HANDLE_VALUE)
+        CloseHandle(handle_file);
     handle_file = nullptr;
+#else
+    if (data)
+        munmap(data, size);
+#endif
     data = nullptr;
+    size = 0;
+}
+
+void Mapped_File::prefetch(const std::size_t offset, const std::size_t prefetch_size) const
+{
+    if (!data || offset >= size)
+    {
+        return;
+    }
+    // Rounded out to whole pages, the kernel rejects unaligned ranges.
+    const auto page_size = get_page_size();
+    const auto begin = offset / page_size * page_size;
+    const auto end = std::min(size, offset + std::min(prefetch_size, size - offset));
+    auto* address = static_cast<uint8_t*>(data) + begin;
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range = {
+        .VirtualAddress = address,
+        .NumberOfBytes = end - begin
+    };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // Starts asynchronous readahead of the file pages.
+    madvise(address, end - begin, MADV_WILLNEED);
+#endif
+}
+
+void Mapped_File::populate(const std::size_t offset, const std::size_t populate_size) const
+{
+    if (!data || offset >= size)
+    {
+        return;
+    }
+    const auto range_size = std::min(populate_size, size - offset);
+    prefetch(offset, range_size);
+    touch_pages(static_cast<uint8_t*>(data) + offset, range_size);
 }
 }
@@ -1,14 +1,38 @@
 #pragma once
 
+#include <cstddef>
+
 namespace ren
 {
+enum class Mapped_File_Access_Pattern
+{
+    Normal,
+    Sequential, // Aggressive readahead, pages behind the read position may be dropped early
+    Random      // No readahead
+};
+
+struct Mapped_File_Options
+{
+    Mapped_File_Access_Pattern access_pattern = Mapped_File_Access_Pattern::Normal;
+    bool populate = false; // Reads the whole file while mapping, so no access faults afterwards
+    bool huge_pages = false; // Backs files of at least `HUGE_PAGE_MIN_SIZE` with transparent huge pages if supported
+};
+
 struct Mapped_File
 {
+    constexpr static std::size_t HUGE_PAGE_MIN_SIZE = 2ull * 1024 * 1024;
+
     void* data;
+    std::size_t size;
     void* handle_file;
     void* handle_map;
 
-    void map(const char* path);
+    void map(const char* path, const Mapped_File_Options& options = {});
     void unmap();
+
+    // Starts reading the range into memory and returns immediately, so the first access does not stall on IO.
+    void prefetch(std::size_t offset = 0, std::size_t prefetch_size = ~0ull) const;
+    // Reads the range into memory and returns once it is resident.
+    void populate(std::size_t offset = 0, std::size_t populate_size = ~0ull) const;
 };
 }
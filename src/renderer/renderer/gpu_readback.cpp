@@ -0,0 +1,80 @@
+#include "renderer/gpu_readback.hpp"
+#include "renderer/render_resource_blackboard.hpp"
+
+#include <rhi/graphics_device.hpp>
+
+namespace ren
+{
+// Keeps results of any type aligned when they are read in place.
+constexpr static auto READBACK_ALIGNMENT = 16ull;
+
+GPU_Readback_Context::GPU_Readback_Context(rhi::Graphics_Device* graphics_device, std::size_t frame_size)
+    : m_graphics_device(graphics_device)
+    , m_frame_size((frame_size + READBACK_ALIGNMENT - 1) & ~(READBACK_ALIGNMENT - 1))
+{
+    rhi::Buffer_Create_Info readback_buffer_create_info = {
+        .size = m_frame_size * REN_MAX_FRAMES_IN_FLIGHT,
+        .heap = rhi::Memory_Heap_Type::CPU_Readback,
+        .acceleration_structure_memory = false
+    };
+    m_readback_buffer = m_graphics_device->create_buffer(readback_buffer_create_info).value_or(nullptr);
+    m_graphics_device->name_resource(m_readback_buffer, "gpu_readback:readback_buffer");
+}
+
+GPU_Readback_Context::~GPU_Readback_Context()
+{
+    m_graphics_device->wait_idle();
+    m_graphics_device->destroy_buffer(m_readback_buffer);
+}
+
+GPU_Readback GPU_Readback_Context::enqueue_readback(rhi::Command_List* cmd, const Buffer& src,
+    std::size_t src_offset, std::size_t size)
+{
+    return enqueue_readback(cmd, static_cast<rhi::Buffer*>(src), src_offset, size);
+}
+
+GPU_Readback GPU_Readback_Context::enqueue_readback(rhi::Command_List* cmd, rhi::Buffer* src,
+    std::size_t src_offset, std::size_t size)
+{
+    if (m_frame_offset + size > m_frame_size)
+    {
+        // Resolves without data, so whoever waits on it doesn't wait forever.
+        return {
+            .frame = m_current_frame,
+            .offset = 0,
+            .size = 0
+        };
+    }
+
+    // The frames that used this region before completed, there is nothing to synchronize with.
+    GPU_Readback readback = {
+        .frame = m_current_frame,
+        .offset = (m_current_frame % REN_MAX_FRAMES_IN_FLIGHT) * m_frame_size + m_frame_offset,
+        .size = size
+    };
+    cmd->copy_buffer(src, src_offset, m_readback_buffer, readback.offset, size);
+    m_frame_offset = (m_frame_offset + size + READBACK_ALIGNMENT - 1) & ~(READBACK_ALIGNMENT - 1);
+    return readback;
+}
+
+bool GPU_Readback_Context::is_ready(const GPU_Readback& readback) const noexcept
+{
+    return readback.frame + REN_MAX_FRAMES_IN_FLIGHT <= m_current_frame;
+}
+
+const void* GPU_Readback_Context::get_data(const GPU_Readback& readback) const noexcept
+{
+    // Later frames record into the same region again.
+    if (readback.size == 0 || readback.frame + REN_MAX_FRAMES_IN_FLIGHT != m_current_frame)
+    {
+        return nullptr;
+    }
+    return static_cast<const char*>(m_readback_buffer->data) + readback.offset;
+}
+
+void GPU_Readback_Context::garbage_collect(const uint64_t frame)
+{
+    m_current_frame = frame;
+    m_frame_offset = 0;
+}
+}
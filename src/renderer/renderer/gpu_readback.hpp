@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rhi
+{
+class Graphics_Device;
+class Command_List;
+struct Buffer;
+}
+
+namespace ren
+{
+class Buffer;
+
+// Handle to the result of a readback. It becomes ready once the frame that recorded the copy completed.
+struct GPU_Readback
+{
+    uint64_t frame = ~0ull; // That recorded the copy
+    std::size_t offset = 0; // Into the readback buffer
+    std::size_t size = 0; // 0 if the readback memory of the frame was exhausted
+};
+
+// Every frame in flight owns a region of one persistently mapped readback buffer. Copies are recorded
+// into the region of the current frame, which is reused once the frame fence was waited on again.
+// Results are read in place, they stay valid for the frame in which the readback became ready.
+class GPU_Readback_Context
+{
+public:
+    constexpr static std::size_t DEFAULT_FRAME_SIZE = 1ull << 20; // 1 MiB
+
+    GPU_Readback_Context(rhi::Graphics_Device* graphics_device, std::size_t frame_size = DEFAULT_FRAME_SIZE);
+    ~GPU_Readback_Context();
+
+    GPU_Readback_Context(const GPU_Readback_Context&) = delete;
+    GPU_Readback_Context& operator=(const GPU_Readback_Context&) = delete;
+    GPU_Readback_Context(GPU_Readback_Context&&) = delete;
+    GPU_Readback_Context& operator=(GPU_Readback_Context&&) = delete;
+
+    // Records the copy into `cmd`, `src` must already be readable by copies.
+    [[nodiscard]] GPU_Readback enqueue_readback(rhi::Command_List* cmd, const Buffer& src, std::size_t src_offset,
+        std::size_t size);
+    [[nodiscard]] GPU_Readback enqueue_readback(rhi::Command_List* cmd, rhi::Buffer* src, std::size_t src_offset,
+        std::size_t size);
+
+    [[nodiscard]] bool is_ready(const GPU_Readback& readback) const noexcept;
+
+    // Returns nullptr if the readback isn't ready, failed, or its frame region was reused already.
+    [[nodiscard]] const void* get_data(const GPU_Readback& readback) const noexcept;
+
+    template<typename T>
+    [[nodiscard]] const T* get_data(const GPU_Readback& readback) const noexcept
+    {
+        return readback.size >= sizeof(T) ? static_cast<const T*>(get_data(readback)) : nullptr;
+    }
+
+    // Must be called once per frame, after the fence of the frame was waited on.
+    void garbage_collect(uint64_t frame);
+
+private:
+    rhi::Graphics_Device* m_graphics_device;
+    rhi::Buffer* m_readback_buffer = nullptr;
+    std::size_t m_frame_size;
+    std::size_t m_frame_offset = 0; // Allocated by the current frame
+    uint64_t m_current_frame = 0;
+};
+}
@@ -1,147 +1,341 @@
 #include "renderer/gpu_transfer.hpp"
 #include "renderer/render_resource_blackboard.hpp"
+#include "renderer/upload_copy.hpp"
+#include "renderer/asset/pipeline.hpp"
 
 #include <rhi/graphics_device.hpp>
+#include <shared/upload_shared_types.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <utility>
 
 namespace ren
 {
-constexpr static auto MIN_PER_FRAME_STAGING_BUFFER_SIZE = 1ull << 24; // 16 MiB
+// Uploads larger than this fraction of the ring would stall the ring for the frames they are in flight.
+constexpr static auto MAX_RING_ALLOCATION_FRACTION = 4ull;
+// Buffer writes that are not worth a copy of their own are coalesced, larger writes are copied directly.
+constexpr static auto MAX_PENDING_WRITE_SIZE = MIN_COPY_SIZE;
+// Deferred buffer uploads larger than the rest of the budget are staged in chunks of at least this size.
+constexpr static std::size_t MIN_DEFERRED_CHUNK_SIZE = 1ull << 20; // 1 MiB
+// Covers the texel and block sizes of every format.
+constexpr static auto IMAGE_REGION_ALIGNMENT = 16ull;
+// Transient buffers are created in powers of two from this size on, so reused buffers mostly fit.
+constexpr static std::size_t MIN_TRANSIENT_BUFFER_SIZE = 256;
+
+[[nodiscard]] constexpr uint32_t get_mip_size(const uint32_t size, const uint32_t mip) noexcept
+{
+    return std::max(size >> mip, 1u);
+}
 
-GPU_Transfer_Context::GPU_Transfer_Context(rhi::Graphics_Device* graphics_device)
+// Updated images keep their contents, they are read by shaders before and after the copy.
+rhi::Image_Barrier_Info get_copy_dst_barrier(rhi::Image* image, const bool discard)
+{
+    return {
+        .stage_before = discard ? rhi::Barrier_Pipeline_Stage::None : rhi::Barrier_Pipeline_Stage::All_Commands,
+        .stage_after = rhi::Barrier_Pipeline_Stage::Copy,
+        .access_before = discard ? rhi::Barrier_Access::None : rhi::Barrier_Access::Shader_Read,
+        .access_after = rhi::Barrier_Access::Transfer_Write,
+        .layout_before = discard ? rhi::Barrier_Image_Layout::Undefined : rhi::Barrier_Image_Layout::Shader_Read_Only,
+        .layout_after = rhi::Barrier_Image_Layout::Copy_Dst,
+        .queue_type_ownership_transfer_mode = rhi::Queue_Type_Ownership_Transfer_Mode::None,
+        .image = image,
+        .subresource_range = {
+            .first_mip_level = 0,
+            .mip_count = image->mip_levels,
+            .first_array_index = 0,
+            .array_size = image->array_size,
+            .first_plane = 0,
+            .plane_count = 1
+        },
+        .discard = discard
+    };
+}
+
+rhi::Image_Barrier_Info get_shader_read_barrier(rhi::Image* image,
+    const rhi::Queue_Type_Ownership_Transfer_Mode queue_type_ownership_transfer_mode)
+{
+    const auto is_acquire = queue_type_ownership_transfer_mode == rhi::Queue_Type_Ownership_Transfer_Mode::Acquire;
+    return {
+        .stage_before = is_acquire ? rhi::Barrier_Pipeline_Stage::None : rhi::Barrier_Pipeline_Stage::Copy,
+        .stage_after = rhi::Barrier_Pipeline_Stage::All_Commands,
+        .access_before = is_acquire ? rhi::Barrier_Access::None : rhi::Barrier_Access::Transfer_Write,
+        .access_after = rhi::Barrier_Access::Shader_Read,
+        .layout_before = rhi::Barrier_Image_Layout::Copy_Dst,
+        .layout_after = rhi::Barrier_Image_Layout::Shader_Read_Only,
+        .queue_type_ownership_transfer_mode = queue_type_ownership_transfer_mode,
+        .image = image,
+        .subresource_range = {
+            .first_mip_level = 0,
+            .mip_count = image->mip_levels,
+            .first_array_index = 0,
+            .array_size = image->array_size,
+            .first_plane = 0,
+            .plane_count = 1
+        },
+        .discard = false
+    };
+}
+
+GPU_Transfer_Context::GPU_Transfer_Context(rhi::Graphics_Device* graphics_device,
+    enki::TaskScheduler* task_scheduler, std::size_t ring_size)
     : m_graphics_device(graphics_device)
-{}
+    , m_task_scheduler(task_scheduler)
+{
+    rhi::Buffer_Create_Info staging_ring_create_info = {
+        .size = ring_size,
+        .heap = rhi::Memory_Heap_Type::CPU_Upload,
+        .acceleration_structure_memory = false
+    };
+    m_staging_ring = m_graphics_device->create_buffer(staging_ring_create_info).value_or(nullptr);
+    m_graphics_device->name_resource(m_staging_ring, "gpu_transfer:staging_ring");
+    m_copy_fence = m_graphics_device->create_fence(0).value_or(nullptr);
+}
 
 GPU_Transfer_Context::~GPU_Transfer_Context()
 {
     m_graphics_device->wait_idle();
-    for (auto& staging_buffer_vec : m_coherent_staging_buffers)
+    m_graphics_device->destroy_fence(m_copy_fence);
+    m_graphics_device->destroy_buffer(m_staging_ring);
+    for (auto& staging_buffers : m_dedicated_staging_buffers)
     {
-        for (auto staging_buffer : staging_buffer_vec)
+        for (auto staging_buffer : staging_buffers)
         {
-            m_graphics_device->destroy_buffer(staging_buffer.buffer);
+            m_graphics_device->destroy_buffer(staging_buffer);
+        }
+    }
+    for (auto& retirement : m_frame_retirements)
+    {
+        for (auto staging_buffer : retirement.dedicated_staging_buffers)
+        {
+            m_graphics_device->destroy_buffer(staging_buffer);
+        }
+    }
+    for (auto& transient_buffers : m_transient_buffers)
+    {
+        for (auto transient_buffer : transient_buffers)
+        {
+            m_graphics_device->destroy_buffer(transient_buffer);
         }
     }
 }
 
-void GPU_Transfer_Context::enqueue_immediate_upload(const Buffer& buffer, void* data, std::size_t size,
+void GPU_Transfer_Context::enqueue_immediate_upload(const Buffer& buffer, const void* data, std::size_t size,
     std::size_t dst_offset)
 {
     enqueue_immediate_upload(static_cast<rhi::Buffer*>(buffer), data, size, dst_offset);
 }
 
-void GPU_Transfer_Context::enqueue_immediate_upload(rhi::Buffer* dst, void* data, std::size_t size,
+void GPU_Transfer_Context::enqueue_immediate_upload(rhi::Buffer* dst, const void* data, std::size_t size,
     std::size_t dst_offset)
 {
-    const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
-
-    auto staging_buffer = get_next_staging_buffer(size);
+    if (size <= MAX_PENDING_WRITE_SIZE)
+    {
+        m_pending_writes.push_back({
+            .dst = dst,
+            .dst_offset = dst_offset,
+            .size = size,
+            .data_offset = m_pending_write_data.size() });
+        m_pending_write_data.insert(m_pending_write_data.end(),
+            static_cast<const std::byte*>(data), static_cast<const std::byte*>(data) + size);
+        m_frame_staged_bytes += size;
+        return;
+    }
 
-    memcpy(&static_cast<char*>(staging_buffer.buffer->data)[staging_buffer.offset], data, size);
+    stage_buffer(dst, data, size, dst_offset);
+}
 
-    m_buffer_staging_infos[frame_in_flight].push_back({
-        .src = staging_buffer.buffer,
-        .src_offset = staging_buffer.offset,
+uint64_t GPU_Transfer_Context::enqueue_deferred_upload(rhi::Buffer* dst, const void* data, std::size_t size,
+    std::size_t dst_offset, Upload_Priority priority)
+{
+    return defer_upload({
+        .upload = 0,
+        .size = size,
         .dst = dst,
         .dst_offset = dst_offset,
-        .size = size });
+        .data = data,
+        .image = {},
+        .regions = {}
+    }, priority);
 }
 
-void GPU_Transfer_Context::enqueue_immediate_upload(rhi::Image* image, void** data)
+void GPU_Transfer_Context::enqueue_scatter_upload(rhi::Buffer* dst, const void* data, std::size_t element_size,
+    std::span<const uint32_t> dst_indices)
 {
-    const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
+    const auto* elements = static_cast<const std::byte*>(data);
+    m_pending_writes.reserve(m_pending_writes.size() + dst_indices.size());
+    for (auto i = 0ull; i < dst_indices.size(); ++i)
+    {
+        m_pending_writes.push_back({
+            .dst = dst,
+            .dst_offset = dst_indices[i] * element_size,
+            .size = element_size,
+            .data_offset = m_pending_write_data.size() + i * element_size });
+    }
+    m_pending_write_data.insert(m_pending_write_data.end(), elements, elements + dst_indices.size() * element_size);
+    m_frame_staged_bytes += dst_indices.size() * element_size;
+}
 
-    const auto info = rhi::get_image_format_info(image->format);
-    std::size_t size = 0;
+Transient_Allocation GPU_Transfer_Context::allocate_transient(std::size_t size)
+{
+    const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
 
-    auto get_size = [&](uint32_t w, uint32_t h) {
-        if (info.is_block_compressed)
+    // Every allocation gets a buffer of its own, shaders address buffers by their bindless index only.
+    auto& transient_buffers = m_transient_buffers[frame_in_flight];
+    if (m_transient_buffer_index == transient_buffers.size())
+    {
+        transient_buffers.push_back(nullptr);
+    }
+    auto*& buffer = transient_buffers[m_transient_buffer_index];
+    m_transient_buffer_index += 1;
+    if (!buffer || buffer->size < size)
+    {
+        // The frame that used the buffer before completed.
+        if (buffer)
         {
-            w = (w + info.block_size_x - 1) / info.block_size_x;
-            h = (h + info.block_size_y - 1) / info.block_size_y;
+            m_graphics_device->destroy_buffer(buffer);
         }
-        return info.bytes * w * h;
+        rhi::Buffer_Create_Info transient_buffer_create_info = {
+            .size = std::bit_ceil(std::max(size, MIN_TRANSIENT_BUFFER_SIZE)),
+            .heap = rhi::Memory_Heap_Type::CPU_Upload,
+            .acceleration_structure_memory = false
+        };
+        buffer = m_graphics_device->create_buffer(transient_buffer_create_info).value_or(nullptr);
+        std::string buffer_name = "gpu_transfer:transient_buffer:frame" + std::to_string(frame_in_flight)
+            + ":buffer" + std::to_string(m_transient_buffer_index - 1);
+        m_graphics_device->name_resource(buffer, buffer_name.c_str());
+    }
+    m_transient_allocations.add(size);
+
+    return {
+        .data = buffer->data,
+        .bindless_index = buffer->buffer_view->bindless_index
     };
+}
+
+uint32_t GPU_Transfer_Context::upload_transient(const void* data, std::size_t size)
+{
+    const auto allocation = allocate_transient(size);
+    memcpy(allocation.data, data, size);
+    return allocation.bindless_index;
+}
 
-    for (auto i = 0; i < image->mip_levels; ++i)
+std::vector<Image_Upload_Region> get_mip_regions(const rhi::Image* image, void** data)
+{
+    std::vector<Image_Upload_Region> regions(image->mip_levels);
+    for (auto i = 0u; i < image->mip_levels; ++i)
     {
-        auto w = (image->width / (1 << i));
-        auto h = (image->height / (1 << i));
-        size += get_size(w, h);
+        regions[i] = { .data = data[i], .mip_level = i };
     }
+    return regions;
+}
+
+void GPU_Transfer_Context::enqueue_immediate_upload(rhi::Image* image, void** data)
+{
+    enqueue_immediate_upload(image, get_mip_regions(image, data));
+}
+
+void GPU_Transfer_Context::enqueue_immediate_upload(rhi::Image* image, std::span<const Image_Upload_Region> regions)
+{
+    const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
+
+    m_image_staging_infos[frame_in_flight].push_back(stage_image(image, regions));
+}
 
-    auto staging_buffer = get_next_staging_buffer(size, info.is_block_compressed ? info.bytes : 1ull);
-    auto mip_offset = 0ull;
+uint64_t GPU_Transfer_Context::enqueue_async_upload(rhi::Image* image, void** data, Upload_Priority priority)
+{
+    return enqueue_async_upload(image, get_mip_regions(image, data), priority);
+}
+
+uint64_t GPU_Transfer_Context::enqueue_async_upload(rhi::Image* image, std::span<const Image_Upload_Region> regions,
+    Upload_Priority priority)
+{
+    Deferred_Upload deferred_upload = {
+        .upload = 0,
+        .size = 0,
+        .dst = nullptr,
+        .dst_offset = 0,
+        .data = nullptr,
+        .image = {},
+        .regions = { regions.begin(), regions.end() }
+    };
+    deferred_upload.size = layout_image_copies(image, regions, deferred_upload.image);
+    return defer_upload(std::move(deferred_upload), priority);
+}
+
+bool GPU_Transfer_Context::is_upload_complete(const uint64_t upload) const noexcept
+{
+    return !m_incomplete_uploads.contains(upload);
+}
 
-    for (auto i = 0; i < image->mip_levels; ++i)
+void GPU_Transfer_Context::schedule_deferred_uploads()
+{
+    // Something is staged every frame, so uploads progress even if the budget is used up by immediate uploads.
+    auto staged_any = false;
+    for (auto& deferred_uploads : m_deferred_uploads)
     {
-        auto w = (image->width / (1 << i));
-        auto h = (image->height / (1 << i));
-        std::size_t current_size = get_size(w, h);
-        if (i > 0)
+        while (!deferred_uploads.empty())
         {
-            auto w_p = (image->width / (1 << (i - 1)));
-            auto h_p = (image->height / (1 << (i - 1)));
-            mip_offset += get_size(w_p, h_p);
+            auto& deferred_upload = deferred_uploads.front();
+            const auto remaining_budget = m_frame_upload_budget - std::min(m_frame_staged_bytes, m_frame_upload_budget);
+            auto stage_size = deferred_upload.size;
+            if (stage_size > remaining_budget)
+            {
+                // Lower priorities wait until everything before them is staged.
+                if (staged_any && (deferred_upload.image.dst || remaining_budget < MIN_DEFERRED_CHUNK_SIZE))
+                {
+                    return;
+                }
+                // Images are staged whole, buffers in chunks that fill the rest of the budget.
+                if (!deferred_upload.image.dst)
+                {
+                    stage_size = std::min(stage_size, std::max(remaining_budget, MIN_DEFERRED_CHUNK_SIZE));
+                }
+            }
+            if (stage_size < deferred_upload.size)
+            {
+                // The upload only completes with the frame of its last chunk, frames complete in order.
+                stage_buffer(deferred_upload.dst, deferred_upload.data, stage_size, deferred_upload.dst_offset);
+                deferred_upload.data = static_cast<const std::byte*>(deferred_upload.data) + stage_size;
+                deferred_upload.dst_offset += stage_size;
+                deferred_upload.size -= stage_size;
+                m_deferred_usage.bytes -= stage_size;
+                return;
+            }
+            m_deferred_usage.remove(deferred_upload.size);
+            stage_deferred_upload(deferred_upload);
+            deferred_uploads.pop_front();
+            staged_any = true;
         }
-        memcpy(&static_cast<char*>(staging_buffer.buffer->data)[staging_buffer.offset + mip_offset], data[i], current_size);
     }
-
-    m_image_staging_infos[frame_in_flight].push_back({
-        .src = staging_buffer.buffer,
-        .src_offset = staging_buffer.offset,
-        .dst = image });
 }
 
 void GPU_Transfer_Context::process_immediate_uploads_on_graphics_queue(
-    rhi::Command_List* cmd)
+    rhi::Command_List* cmd, const Compute_Pipeline& scatter_pipeline)
 {
     const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
 
+    const auto coalesced_writes = static_cast<uint32_t>(m_pending_writes.size());
+    const auto scatter_infos = coalesce_pending_writes(static_cast<rhi::Pipeline*>(scatter_pipeline) != nullptr);
+
     std::vector<rhi::Image_Barrier_Info> image_barriers_before;
     std::vector<rhi::Image_Barrier_Info> image_barriers_after;
     image_barriers_before.reserve(m_image_staging_infos[frame_in_flight].size());
-    image_barriers_after.reserve(m_image_staging_infos[frame_in_flight].size());
+    image_barriers_after.reserve(m_image_staging_infos[frame_in_flight].size() + m_acquired_images.size());
     for (const auto& image_staging_info : m_image_staging_infos[frame_in_flight])
     {
-        image_barriers_before.emplace_back( rhi::Image_Barrier_Info {
-            .stage_before = rhi::Barrier_Pipeline_Stage::None,
-            .stage_after = rhi::Barrier_Pipeline_Stage::Copy,
-            .access_before = rhi::Barrier_Access::None,
-            .access_after = rhi::Barrier_Access::Transfer_Write,
-            .layout_before = rhi::Barrier_Image_Layout::Undefined,
-            .layout_after = rhi::Barrier_Image_Layout::Copy_Dst,
-            .queue_type_ownership_transfer_mode = rhi::Queue_Type_Ownership_Transfer_Mode::None,
-            .image = image_staging_info.dst,
-            .subresource_range = {
-                .first_mip_level = 0,
-                .mip_count = image_staging_info.dst->mip_levels,
-                .first_array_index = 0,
-                .array_size = image_staging_info.dst->array_size,
-                .first_plane = 0,
-                .plane_count = 1
-            },
-            .discard = true
-        });
-        image_barriers_after.emplace_back( rhi::Image_Barrier_Info {
-            .stage_before = rhi::Barrier_Pipeline_Stage::Copy,
-            .stage_after = rhi::Barrier_Pipeline_Stage::All_Commands,
-            .access_before = rhi::Barrier_Access::Transfer_Write,
-            .access_after = rhi::Barrier_Access::Shader_Read,
-            .layout_before = rhi::Barrier_Image_Layout::Copy_Dst,
-            .layout_after = rhi::Barrier_Image_Layout::Shader_Read_Only,
-            .queue_type_ownership_transfer_mode = rhi::Queue_Type_Ownership_Transfer_Mode::None,
-            .image = image_staging_info.dst,
-            .subresource_range = {
-                .first_mip_level = 0,
-                .mip_count = image_staging_info.dst->mip_levels,
-                .first_array_index = 0,
-                .array_size = image_staging_info.dst->array_size,
-                .first_plane = 0,
-                .plane_count = 1
-            },
-            .discard = false
-        });
+        image_barriers_before.push_back(get_copy_dst_barrier(image_staging_info.dst, image_staging_info.is_discarded));
+        image_barriers_after.push_back(get_shader_read_barrier(image_staging_info.dst,
+            rhi::Queue_Type_Ownership_Transfer_Mode::None));
+    }
+    // The copy queue released these images, they are used from this frame on.
+    for (auto* image : m_acquired_images)
+    {
+        image_barriers_after.push_back(get_shader_read_barrier(image,
+            rhi::Queue_Type_Ownership_Transfer_Mode::Acquire));
     }
+    m_acquired_images.clear();
     if (image_barriers_before.size() > 0)
     {
         cmd->barrier({
@@ -149,47 +343,7 @@ void GPU_Transfer_Context::process_immediate_uploads_on_graphics_queue(
             });
     }
 
-    // TODO: this does not work for partial image copies.
-    for (const auto& image_staging_info : m_image_staging_infos[frame_in_flight])
-    {
-        std::size_t offset = 0;
-        for (auto i = 0; i < image_staging_info.dst->mip_levels; ++i)
-        {
-            const auto byte_size = rhi::get_image_format_info(image_staging_info.dst->format).bytes;
-            const auto width = image_staging_info.dst->width / (1 << i);
-            const auto height = image_staging_info.dst->height / (1 << i);
-
-            const auto info = rhi::get_image_format_info(image_staging_info.dst->format);
-            auto get_size = [&](uint32_t w, uint32_t h) {
-                if (info.is_block_compressed)
-                {
-                    w = (w + info.block_size_x - 1) / info.block_size_x;
-                    h = (h + info.block_size_y - 1) / info.block_size_y;
-                }
-                return info.bytes * w * h;
-                };
-
-            if (i > 0)
-            {
-                const auto w_p = (image_staging_info.dst->width / (1 << (i - 1)));
-                const auto h_p = (image_staging_info.dst->height / (1 << (i - 1)));
-                offset += get_size(w_p, h_p);
-            }
-
-            cmd->copy_buffer_to_image(
-                image_staging_info.src,
-                image_staging_info.src_offset + offset,
-                image_staging_info.dst,
-                {},
-                {
-                    .x = width,
-                    .y = height,
-                    .z = 1
-                },
-                i,
-                0);
-        }
-    }
+    record_image_copies(cmd, m_image_staging_infos[frame_in_flight]);
 
     for (const auto& buffer_staging_info : m_buffer_staging_infos[frame_in_flight])
     {
@@ -200,21 +354,111 @@ void GPU_Transfer_Context::process_immediate_uploads_on_graphics_queue(
             buffer_staging_info.dst_offset,
             buffer_staging_info.size);
     }
-    rhi::Memory_Barrier_Info mem_barrier = {
-        .stage_before = rhi::Barrier_Pipeline_Stage::Copy,
-        .stage_after = rhi::Barrier_Pipeline_Stage::All_Commands,
-        .access_before = rhi::Barrier_Access::Transfer_Write,
-        .access_after = rhi::Barrier_Access::Shader_Read
-    };
+
+    auto scatter_words = 0u;
+    if (!scatter_infos.empty())
+    {
+        // Scattered writes are applied after the copies, they may overlap.
+        rhi::Memory_Barrier_Info copy_barrier = {
+            .stage_before = rhi::Barrier_Pipeline_Stage::Copy,
+            .stage_after = rhi::Barrier_Pipeline_Stage::Compute_Shader,
+            .access_before = rhi::Barrier_Access::Transfer_Write,
+            .access_after = rhi::Barrier_Access::Unordered_Access_Write
+        };
+        cmd->barrier({ .memory_barriers = { &copy_barrier, 1 } });
+        cmd->set_pipeline(scatter_pipeline);
+        for (const auto& scatter_info : scatter_infos)
+        {
+            cmd->set_push_constants<Upload_Scatter_Push_Constants>({
+                .src_buffer = scatter_info.src->buffer_view->bindless_index,
+                .dst_buffer = scatter_info.dst->buffer_view->bindless_index,
+                .first_write = static_cast<uint32_t>(scatter_info.src_offset / SCATTER_WRITE_SIZE),
+                .write_count = scatter_info.write_count
+            }, rhi::Pipeline_Bind_Point::Compute);
+            cmd->dispatch((scatter_info.write_count + scatter_pipeline.get_group_size_x() - 1) / scatter_pipeline.get_group_size_x(), 1, 1);
+            scatter_words += scatter_info.write_count;
+        }
+    }
+
+    auto mem_barriers = std::to_array<rhi::Memory_Barrier_Info>({
+        {
+            .stage_before = rhi::Barrier_Pipeline_Stage::Copy,
+            .stage_after = rhi::Barrier_Pipeline_Stage::All_Commands,
+            .access_before = rhi::Barrier_Access::Transfer_Write,
+            .access_after = rhi::Barrier_Access::Shader_Read
+        },
+        {
+            .stage_before = rhi::Barrier_Pipeline_Stage::Compute_Shader,
+            .stage_after = rhi::Barrier_Pipeline_Stage::All_Commands,
+            .access_before = rhi::Barrier_Access::Unordered_Access_Write,
+            .access_after = rhi::Barrier_Access::Shader_Read
+        }
+    });
     rhi::Barrier_Info barrier = {
         .image_barriers = image_barriers_after,
-        .memory_barriers = { &mem_barrier, 1 },
+        .memory_barriers = { mem_barriers.data(), scatter_infos.empty() ? 1ull : 2ull },
     };
     cmd->barrier(barrier);
 
+    m_frame_ring_heads[frame_in_flight] = m_ring_head;
+    m_last_frame_statistics = {
+        .ring_size = m_staging_ring->size,
+        .ring_used = m_ring_head - m_ring_tail,
+        .ring_allocations = m_ring_allocations,
+        .dedicated_allocations = m_dedicated_allocations,
+        .dedicated_buffers = m_dedicated_buffers,
+        .coalesced_writes = coalesced_writes,
+        .buffer_copies = static_cast<uint32_t>(m_buffer_staging_infos[frame_in_flight].size()),
+        .scatter_words = scatter_words,
+        .staged_bytes = m_frame_staged_bytes,
+        .deferred_uploads = m_deferred_usage,
+        .transient_allocations = m_transient_allocations
+    };
+    m_transient_allocations = {};
+    m_transient_buffer_index = 0;
+    m_ring_allocations = {};
+    m_dedicated_allocations = {};
+    m_frame_staged_bytes = 0;
+
     m_current_frame += 1;
 }
 
+rhi::Submit_Fence_Info GPU_Transfer_Context::process_async_uploads_on_copy_queue(rhi::Command_List* cmd)
+{
+    const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
+
+    std::vector<rhi::Image_Barrier_Info> image_barriers_before;
+    std::vector<rhi::Image_Barrier_Info> image_barriers_after;
+    image_barriers_before.reserve(m_async_image_staging_infos.size());
+    image_barriers_after.reserve(m_async_image_staging_infos.size());
+    for (const auto& image_staging_info : m_async_image_staging_infos)
+    {
+        image_barriers_before.push_back(get_copy_dst_barrier(image_staging_info.dst, true));
+        // Must match the acquire barrier that is recorded on the graphics queue.
+        auto release_barrier = get_shader_read_barrier(image_staging_info.dst,
+            rhi::Queue_Type_Ownership_Transfer_Mode::Release);
+        release_barrier.stage_after = rhi::Barrier_Pipeline_Stage::None;
+        release_barrier.access_after = rhi::Barrier_Access::None;
+        image_barriers_after.push_back(release_barrier);
+        m_released_images[frame_in_flight].push_back(image_staging_info.dst);
+    }
+    cmd->barrier({
+        .image_barriers = image_barriers_before
+        });
+    record_image_copies(cmd, m_async_image_staging_infos);
+    cmd->barrier({
+        .image_barriers = image_barriers_after
+        });
+    m_async_image_staging_infos.clear();
+
+    m_copy_fence_value += 1;
+    m_frame_copy_values[frame_in_flight] = m_copy_fence_value;
+    return {
+        .fence = m_copy_fence,
+        .value = m_copy_fence_value
+    };
+}
+
 void GPU_Transfer_Context::garbage_collect()
 {
     if (m_current_frame < REN_MAX_FRAMES_IN_FLIGHT)
@@ -224,49 +468,335 @@ void GPU_Transfer_Context::garbage_collect()
 
     m_buffer_staging_infos[frame_in_flight].clear();
     m_image_staging_infos[frame_in_flight].clear();
-    for (auto& staging_buffer : m_coherent_staging_buffers[frame_in_flight])
+    // The graphics queue finished the frame, but it does not wait on the copy queue, whose batch of the frame
+    // may still be in flight. Frames are retired in order once their copy batch completed, without blocking.
+    m_frame_retirements.push_back({
+        .copy_value = std::exchange(m_frame_copy_values[frame_in_flight], 0),
+        .ring_head = m_frame_ring_heads[frame_in_flight],
+        .released_images = std::exchange(m_released_images[frame_in_flight], {}),
+        .uploads = std::exchange(m_frame_uploads[frame_in_flight], {}),
+        .dedicated_staging_buffers = std::exchange(m_dedicated_staging_buffers[frame_in_flight], {})
+    });
+
+    const auto completed_copy_value = m_copy_fence->get_completed_value();
+    while (!m_frame_retirements.empty() && m_frame_retirements.front().copy_value <= completed_copy_value)
     {
-        staging_buffer.offset = 0;
+        auto& retirement = m_frame_retirements.front();
+        m_acquired_images.insert(m_acquired_images.end(),
+            retirement.released_images.begin(), retirement.released_images.end());
+        for (const auto upload : retirement.uploads)
+        {
+            m_incomplete_uploads.erase(upload);
+        }
+        // Everything staged up to the end of the retired frame was copied.
+        m_ring_tail = retirement.ring_head;
+        for (auto staging_buffer : retirement.dedicated_staging_buffers)
+        {
+            m_dedicated_buffers.remove(staging_buffer->size);
+            m_graphics_device->destroy_buffer(staging_buffer);
+        }
+        m_frame_retirements.pop_front();
     }
 }
 
+GPU_Transfer_Statistics GPU_Transfer_Context::get_statistics() const noexcept
+{
+    return m_last_frame_statistics;
+}
+
 [[nodiscard]] constexpr uint64_t pow2_align_up(uint64_t x, uint64_t a) noexcept
 {
     return (x + (a - 1ull)) & ~(a - 1ull);
 }
 
 GPU_Transfer_Context::Staging_Buffer GPU_Transfer_Context::get_next_staging_buffer(std::size_t size, std::size_t alignment)
+{
+    const auto ring_size = m_staging_ring->size;
+    if (size > ring_size / MAX_RING_ALLOCATION_FRACTION)
+    {
+        return create_dedicated_staging_buffer(size);
+    }
+
+    auto head = pow2_align_up(m_ring_head, alignment);
+    if (head % ring_size + size > ring_size)
+    {
+        // Allocations don't wrap, the end of the ring is skipped.
+        head += ring_size - head % ring_size;
+    }
+    if (head + size - m_ring_tail > ring_size)
+    {
+        return create_dedicated_staging_buffer(size);
+    }
+    m_ring_head = head + size;
+    m_ring_allocations.add(size);
+    return {
+        .buffer = m_staging_ring,
+        .offset = head % ring_size
+    };
+}
+
+GPU_Transfer_Context::Staging_Buffer GPU_Transfer_Context::create_dedicated_staging_buffer(std::size_t size)
+{
+    const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
+
+    rhi::Buffer_Create_Info staging_buffer_create_info = {
+        .size = size,
+        .heap = rhi::Memory_Heap_Type::CPU_Upload,
+        .acceleration_structure_memory = false
+    };
+    auto* buffer = m_graphics_device->create_buffer(staging_buffer_create_info).value_or(nullptr);
+    std::string buffer_name = "gpu_transfer:dedicated_staging_buffer:frame" + std::to_string(frame_in_flight)
+        + ":buffer" + std::to_string(m_dedicated_staging_buffers[frame_in_flight].size());
+    m_graphics_device->name_resource(buffer, buffer_name.c_str());
+    m_dedicated_staging_buffers[frame_in_flight].push_back(buffer);
+    m_dedicated_allocations.add(size);
+    m_dedicated_buffers.add(buffer->size);
+
+    return {
+        .buffer = buffer,
+        .offset = 0
+    };
+}
+
+void GPU_Transfer_Context::copy_to_staging_buffer(const Staging_Buffer& staging_buffer, const void* data,
+    std::size_t size)
+{
+    auto* dst = static_cast<char*>(staging_buffer.buffer->data) + staging_buffer.offset;
+    if (m_task_scheduler)
+    {
+        copy_to_upload_memory(dst, data, size, *m_task_scheduler);
+    }
+    else
+    {
+        copy_to_upload_memory(dst, data, size);
+    }
+}
+
+std::vector<GPU_Transfer_Context::Scatter_Info> GPU_Transfer_Context::coalesce_pending_writes(const bool can_scatter)
 {
     const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
 
-    Staging_Buffer result = {};
-    for (auto& staging_buffer : m_coherent_staging_buffers[frame_in_flight])
+    std::vector<Scatter_Info> scatter_infos;
+    if (m_pending_writes.empty())
     {
-        if (alignment > 1ull)
+        return scatter_infos;
+    }
+
+    coalesce_buffer_writes(m_pending_writes, m_pending_write_data, m_write_runs, m_write_run_data);
+    m_pending_writes.clear();
+    m_pending_write_data.clear();
+
+    for (auto first_run = m_write_runs.begin(); first_run != m_write_runs.end();)
+    {
+        const auto last_run = std::find_if(first_run, m_write_runs.end(), [dst = first_run->dst](const Buffer_Write& run)
+        {
+            return run.dst != dst;
+        });
+
+        uint32_t scatter_write_count = 0;
+        for (auto run = first_run; run != last_run; ++run)
         {
-            staging_buffer.offset = pow2_align_up(staging_buffer.offset, alignment);
+            if (is_scattered_write_run(*run, can_scatter))
+            {
+                scatter_write_count += static_cast<uint32_t>(run->size / sizeof(uint32_t));
+                continue;
+            }
+            auto staging_buffer = get_next_staging_buffer(run->size);
+            copy_to_staging_buffer(staging_buffer, &m_write_run_data[run->data_offset], run->size);
+            m_buffer_staging_infos[frame_in_flight].push_back({
+                .src = staging_buffer.buffer,
+                .src_offset = staging_buffer.offset,
+                .dst = run->dst,
+                .dst_offset = run->dst_offset,
+                .size = run->size });
         }
 
-        if (staging_buffer.offset + size <= staging_buffer.buffer->size)
+        // One dispatch per buffer writes every scattered word of it.
+        if (scatter_write_count > 0)
         {
-            result = staging_buffer;
-            staging_buffer.offset += size;
-            return result;
+            auto staging_buffer = get_next_staging_buffer(scatter_write_count * SCATTER_WRITE_SIZE, SCATTER_WRITE_SIZE);
+            auto* scatter_writes = &static_cast<std::byte*>(staging_buffer.buffer->data)[staging_buffer.offset];
+            for (auto run = first_run; run != last_run; ++run)
+            {
+                if (is_scattered_write_run(*run, can_scatter))
+                {
+                    scatter_writes = encode_scatter_writes(*run, m_write_run_data, scatter_writes);
+                }
+            }
+            scatter_infos.push_back({
+                .src = staging_buffer.buffer,
+                .src_offset = staging_buffer.offset,
+                .dst = first_run->dst,
+                .write_count = scatter_write_count });
         }
+        first_run = last_run;
     }
-    auto& new_staging_buffer = m_coherent_staging_buffers[frame_in_flight].emplace_back();
-    rhi::Buffer_Create_Info staging_buffer_create_info = {
-        .size = std::max(MIN_PER_FRAME_STAGING_BUFFER_SIZE, size),
-        .heap = rhi::Memory_Heap_Type::CPU_Upload,
-        .acceleration_structure_memory = false
+    return scatter_infos;
+}
+
+std::size_t GPU_Transfer_Context::layout_image_copies(rhi::Image* image, std::span<const Image_Upload_Region> regions,
+    Image_Staging_Info& image_staging_info)
+{
+    const auto info = rhi::get_image_format_info(image->format);
+    const auto block_width = info.is_block_compressed ? info.block_size_x : 1u;
+    const auto block_height = info.is_block_compressed ? info.block_size_y : 1u;
+
+    image_staging_info = {
+        .dst = image,
+        .is_discarded = false,
+        .copies = {}
     };
-    new_staging_buffer.buffer = m_graphics_device->create_buffer(staging_buffer_create_info).value_or(nullptr);
-    std::string buffer_name = "gpu_transfer:staging_buffer:frame" + std::to_string(frame_in_flight) + ":buffer" + std::to_string(m_coherent_staging_buffers[frame_in_flight].size() - 1);
-    m_graphics_device->name_resource(new_staging_buffer.buffer, buffer_name.c_str());
+    image_staging_info.copies.reserve(regions.size());
+    std::size_t size = 0;
+    auto full_subresource_count = 0u;
+    for (const auto& region : regions)
+    {
+        const auto mip_width = get_mip_size(image->width, region.mip_level);
+        const auto mip_height = get_mip_size(image->height, region.mip_level);
+        auto& copy = image_staging_info.copies.emplace_back(Image_Copy_Info {
+            .src = nullptr,
+            .src_offset = pow2_align_up(size, IMAGE_REGION_ALIGNMENT),
+            .mip_level = region.mip_level,
+            .array_index = region.array_index,
+            .x = static_cast<int32_t>(region.x),
+            .y = static_cast<int32_t>(region.y),
+            .width = region.width > 0 ? region.width : mip_width - region.x,
+            .height = region.height > 0 ? region.height : mip_height - region.y,
+            .row_size = 0,
+            .row_count = 0
+        });
+        copy.row_size = (copy.width + block_width - 1) / block_width * info.bytes;
+        copy.row_count = (copy.height + block_height - 1) / block_height;
+        if (region.x == 0 && region.y == 0 && copy.width == mip_width && copy.height == mip_height)
+        {
+            full_subresource_count += 1;
+        }
+        size = copy.src_offset + copy.row_size * copy.row_count;
+    }
+    image_staging_info.is_discarded = full_subresource_count == static_cast<uint32_t>(image->mip_levels) * image->array_size;
+    return size;
+}
+
+void GPU_Transfer_Context::copy_image_to_staging_buffer(std::span<const Image_Upload_Region> regions,
+    const std::size_t size, Image_Staging_Info& image_staging_info)
+{
+    // The rows are packed tightly in the staging buffer.
+    auto staging_buffer = get_next_staging_buffer(size, IMAGE_REGION_ALIGNMENT);
+    auto* staging_data = static_cast<char*>(staging_buffer.buffer->data) + staging_buffer.offset;
+    for (auto i = 0ull; i < regions.size(); ++i)
+    {
+        auto& copy = image_staging_info.copies[i];
+        const auto row_pitch = regions[i].row_pitch > 0 ? regions[i].row_pitch : copy.row_size;
+        const auto* src = static_cast<const char*>(regions[i].data);
+        if (row_pitch == copy.row_size)
+        {
+            copy_to_staging_buffer({
+                    .buffer = staging_buffer.buffer,
+                    .offset = staging_buffer.offset + copy.src_offset
+                }, src, copy.row_size * copy.row_count);
+        }
+        else
+        {
+            for (auto row = 0u; row < copy.row_count; ++row)
+            {
+                copy_to_upload_memory(staging_data + copy.src_offset + row * copy.row_size, src + row * row_pitch,
+                    copy.row_size);
+            }
+        }
+        copy.src = staging_buffer.buffer;
+        copy.src_offset += staging_buffer.offset;
+    }
+    m_frame_staged_bytes += size;
+}
+
+GPU_Transfer_Context::Image_Staging_Info GPU_Transfer_Context::stage_image(rhi::Image* image,
+    std::span<const Image_Upload_Region> regions)
+{
+    Image_Staging_Info image_staging_info = {};
+    const auto size = layout_image_copies(image, regions, image_staging_info);
+    copy_image_to_staging_buffer(regions, size, image_staging_info);
+    return image_staging_info;
+}
+
+void GPU_Transfer_Context::stage_buffer(rhi::Buffer* dst, const void* data, std::size_t size, std::size_t dst_offset)
+{
+    const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
+
+    auto staging_buffer = get_next_staging_buffer(size);
+
+    copy_to_staging_buffer(staging_buffer, data, size);
+
+    m_buffer_staging_infos[frame_in_flight].push_back({
+        .src = staging_buffer.buffer,
+        .src_offset = staging_buffer.offset,
+        .dst = dst,
+        .dst_offset = dst_offset,
+        .size = size });
+    m_frame_staged_bytes += size;
+}
 
-    result = new_staging_buffer;
-    new_staging_buffer.offset += size;
+uint64_t GPU_Transfer_Context::defer_upload(Deferred_Upload&& deferred_upload, const Upload_Priority priority)
+{
+    deferred_upload.upload = m_next_upload++;
+    m_incomplete_uploads.insert(deferred_upload.upload);
+    if (priority == Upload_Priority::Frame_Constants)
+    {
+        stage_deferred_upload(deferred_upload);
+        return deferred_upload.upload;
+    }
+    m_deferred_usage.add(deferred_upload.size);
+    const auto upload = deferred_upload.upload;
+    m_deferred_uploads[static_cast<std::size_t>(priority)].push_back(std::move(deferred_upload));
+    return upload;
+}
 
-    return result;
+void GPU_Transfer_Context::stage_deferred_upload(Deferred_Upload& deferred_upload)
+{
+    const auto frame_in_flight = m_current_frame % REN_MAX_FRAMES_IN_FLIGHT;
+
+    if (deferred_upload.image.dst)
+    {
+        copy_image_to_staging_buffer(deferred_upload.regions, deferred_upload.size, deferred_upload.image);
+        if (deferred_upload.image.is_discarded)
+        {
+            m_async_image_staging_infos.push_back(std::move(deferred_upload.image));
+        }
+        else
+        {
+            m_image_staging_infos[frame_in_flight].push_back(std::move(deferred_upload.image));
+        }
+    }
+    else
+    {
+        stage_buffer(deferred_upload.dst, deferred_upload.data, deferred_upload.size, deferred_upload.dst_offset);
+    }
+    // Copy batches are waited on with the frame they were submitted in.
+    m_frame_uploads[frame_in_flight].push_back(deferred_upload.upload);
+}
+
+void GPU_Transfer_Context::record_image_copies(rhi::Command_List* cmd, std::span<const Image_Staging_Info> image_staging_infos)
+{
+    for (const auto& image_staging_info : image_staging_infos)
+    {
+        for (const auto& copy : image_staging_info.copies)
+        {
+            cmd->copy_buffer_to_image(
+                copy.src,
+                copy.src_offset,
+                image_staging_info.dst,
+                {
+                    .x = copy.x,
+                    .y = copy.y,
+                    .z = 0
+                },
+                {
+                    .x = copy.width,
+                    .y = copy.height,
+                    .z = 1
+                },
+                copy.mip_level,
+                copy.array_index);
+        }
+    }
 }
 }
@@ -1,25 +1,112 @@
 #pragma once
 
+#include "renderer/memory_usage.hpp"
+#include "renderer/write_coalescing.hpp"
+
+#include <ankerl/unordered_dense.h>
+
 #include <array>
+#include <cstdint>
+#include <deque>
+#include <span>
 #include <vector>
 
 namespace rhi
 {
 class Graphics_Device;
 class Command_List;
+class Fence;
 struct Buffer;
 struct Image;
+struct Submit_Fence_Info;
+}
+
+namespace enki
+{
+class TaskScheduler;
 }
 
 namespace ren
 {
 class Buffer;
 class Image;
+class Compute_Pipeline;
+
+// Region of one subresource. Offsets and extents are in texels, for block compressed formats they are
+// block aligned unless the region ends at the edge of the mip.
+struct Image_Upload_Region
+{
+    const void* data;
+    std::size_t row_pitch = 0; // Bytes between rows of texels or blocks in `data`, 0 if they are tightly packed
+    uint32_t mip_level = 0;
+    uint32_t array_index = 0; // Array slice or cubemap face
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0; // 0 for the rest of the mip
+    uint32_t height = 0;
+};
+
+// Deferred uploads are staged in priority order within the per-frame upload budget.
+enum class Upload_Priority
+{
+    Frame_Constants, // Never deferred, always staged in the frame it was enqueued in
+    Geometry,
+    Texture,
+    Streaming
+};
+constexpr static auto UPLOAD_PRIORITY_COUNT = 4ull;
+
+struct GPU_Transfer_Statistics
+{
+    std::size_t ring_size;
+    std::size_t ring_used; // Staged by frames that are still in flight
+    Memory_Usage ring_allocations; // Of the last processed frame
+    Memory_Usage dedicated_allocations; // Of the last processed frame
+    Memory_Usage dedicated_buffers; // Alive until their frame completed
+    uint32_t coalesced_writes; // Small buffer writes of the last processed frame
+    uint32_t buffer_copies; // Recorded copies, after coalescing
+    uint32_t scatter_words; // Words written by the scatter kernel
+    std::size_t staged_bytes; // Of the last processed frame, including uploads that are never deferred
+    Memory_Usage deferred_uploads; // Waiting for the budget of a later frame
+    Memory_Usage transient_allocations; // Of the last processed frame
+};
+
+// Written by the CPU and read by shaders in place, valid until the frame is garbage collected.
+struct Transient_Allocation
+{
+    void* data;
+    uint32_t bindless_index;
+};
 
+// Uploads are staged in a persistent ring buffer in the upload heap. The ring space of a frame is
+// reclaimed once the frame fence was waited on and the frame is garbage collected. Uploads that are
+// too large for the ring, or that don't fit while earlier frames are in flight, get dedicated
+// staging buffers that are destroyed with their frame.
+// Small buffer writes are kept on the CPU until the uploads are processed. They are then sorted by
+// destination and adjacent or overlapping writes are merged into one copy. Merged ranges that are
+// still too small for a copy to pay off are written by a compute scatter kernel, with one dispatch
+// per destination buffer. Small writes are applied after the other buffer uploads of the frame, even if
+// they were enqueued before them. Where they overlap, the small write wins.
+// Async uploads are recorded on the copy queue, which signals a timeline fence per batch. The graphics
+// queue never waits on it. Consumers keep using what they had until their upload is complete, the
+// image is then acquired by the graphics queue before it is used.
+// Immediate uploads are staged right away. Deferred uploads wait in one queue per priority and
+// are staged once per frame, higher priorities first, until the frame's upload budget is used up.
+// Buffer uploads larger than the rest of the budget are split into chunks across frames.
+// Their data is read when they are staged, it must stay valid until the upload is complete.
+// Constants that change every frame don't need a copy at all. They are written into transient
+// upload buffers, every allocation gets a buffer of its own from the pool of its frame in flight.
+// The pool of a frame is reused in allocation order once the frame is garbage collected, a pooled
+// buffer is only replaced by a larger one.
 class GPU_Transfer_Context
 {
 public:
-    GPU_Transfer_Context(rhi::Graphics_Device* graphics_device);
+    constexpr static std::size_t DEFAULT_RING_SIZE = 1ull << 26; // 64 MiB
+    constexpr static std::size_t DEFAULT_FRAME_UPLOAD_BUDGET = 1ull << 25; // 32 MiB
+
+    // With a task scheduler, large uploads are copied into staging memory by all workers.
+    GPU_Transfer_Context(rhi::Graphics_Device* graphics_device, enki::TaskScheduler* task_scheduler = nullptr,
+        std::size_t ring_size = DEFAULT_RING_SIZE);
     ~GPU_Transfer_Context();
 
     GPU_Transfer_Context(const GPU_Transfer_Context&) = delete;
@@ -29,8 +116,10 @@ public:
 
     // Buffer upload functions
 
-    void enqueue_immediate_upload(const Buffer& buffer, void* data, std::size_t size, std::size_t dst_offset);
-    void enqueue_immediate_upload(rhi::Buffer* dst, void* data, std::size_t size, std::size_t dst_offset);
+    // Writes up to 256 bytes are coalesced and applied after all larger uploads of the frame. A small write
+    // enqueued before an overlapping larger upload is not overwritten by it, don't mix both for one range.
+    void enqueue_immediate_upload(const Buffer& buffer, const void* data, std::size_t size, std::size_t dst_offset);
+    void enqueue_immediate_upload(rhi::Buffer* dst, const void* data, std::size_t size, std::size_t dst_offset);
 
     template<typename T>
     void enqueue_immediate_upload(rhi::Buffer* buffer, T& data, std::size_t offset = 0)
@@ -38,20 +127,75 @@ public:
         enqueue_immediate_upload(buffer, static_cast<void*>(&data), sizeof(T), offset);
     }
 
+    // Writes element `i` of `data` to the element `dst_indices[i]` of `dst`.
+    void enqueue_scatter_upload(rhi::Buffer* dst, const void* data, std::size_t element_size,
+        std::span<const uint32_t> dst_indices);
+
+    template<typename T>
+    void enqueue_scatter_upload(rhi::Buffer* dst, std::span<const T> data, std::span<const uint32_t> dst_indices)
+    {
+        enqueue_scatter_upload(dst, static_cast<const void*>(data.data()), sizeof(T), dst_indices.first(data.size()));
+    }
+
+    // Returns the upload, `dst` must not be read before `is_upload_complete` returns true for it.
+    [[nodiscard]] uint64_t enqueue_deferred_upload(rhi::Buffer* dst, const void* data, std::size_t size,
+        std::size_t dst_offset, Upload_Priority priority);
+
+    // Transient allocations are only valid for the frame they were made in.
+    [[nodiscard]] Transient_Allocation allocate_transient(std::size_t size);
+    // Returns the bindless index of the buffer the data was written to.
+    [[nodiscard]] uint32_t upload_transient(const void* data, std::size_t size);
+
+    template<typename T>
+    [[nodiscard]] uint32_t upload_transient(const T& data)
+    {
+        return upload_transient(static_cast<const void*>(&data), sizeof(T));
+    }
+
     // Image upload functions.
 
-    // void** data is a pointer to arrays of mipmap data
+    // void** data is a pointer to arrays of mipmap data, all mips of the first array slice are uploaded
     void enqueue_immediate_upload(rhi::Image* image, void** data);
 
+    // Regions that cover every subresource replace the contents of the image. Otherwise the image
+    // must be in the shader read layout and only the regions are updated.
+    void enqueue_immediate_upload(rhi::Image* image, std::span<const Image_Upload_Region> regions);
+
+    // Returns the upload, the image must not be used before `is_upload_complete` returns true for it.
+    // Async uploads are deferred. The copy queue can't update images that are in use, regions that
+    // don't cover the whole image are uploaded on the graphics queue.
+    [[nodiscard]] uint64_t enqueue_async_upload(rhi::Image* image, void** data,
+        Upload_Priority priority = Upload_Priority::Texture);
+    [[nodiscard]] uint64_t enqueue_async_upload(rhi::Image* image, std::span<const Image_Upload_Region> regions,
+        Upload_Priority priority = Upload_Priority::Texture);
+    [[nodiscard]] bool is_upload_complete(uint64_t upload) const noexcept;
+
+    void set_frame_upload_budget(std::size_t budget) noexcept { m_frame_upload_budget = budget; }
+    [[nodiscard]] std::size_t get_frame_upload_budget() const noexcept { return m_frame_upload_budget; }
+
 
     // Upload processing
 
-    void process_immediate_uploads_on_graphics_queue(rhi::Command_List* cmd);
+    // Stages the deferred uploads, or chunks of them, that fit into the budget of this frame.
+    // Must be called once per frame, before the uploads are processed.
+    void schedule_deferred_uploads();
+
+    // The scatter pipeline may be unavailable, small writes are then copied.
+    void process_immediate_uploads_on_graphics_queue(rhi::Command_List* cmd, const Compute_Pipeline& scatter_pipeline);
+
+    // Must be called before the uploads are processed on the graphics queue.
+    // The command list has to be submitted to the copy queue with the returned fence signal.
+    [[nodiscard]] bool has_async_uploads() const noexcept { return !m_async_image_staging_infos.empty(); }
+    [[nodiscard]] rhi::Submit_Fence_Info process_async_uploads_on_copy_queue(rhi::Command_List* cmd);
 
     // Bookkeeping
 
+    // Must be called once per frame, after the fence of the frame was waited on. Never waits on the copy queue,
+    // what its batches still use is released by a later call.
     void garbage_collect();
 
+    [[nodiscard]] GPU_Transfer_Statistics get_statistics() const noexcept;
+
 private:
     struct Buffer_Staging_Info
     {
@@ -62,11 +206,25 @@ private:
         std::size_t size;
     };
 
-    struct Image_Staging_Info
+    struct Image_Copy_Info
     {
         rhi::Buffer* src;
         std::size_t src_offset;
+        uint32_t mip_level;
+        uint32_t array_index;
+        int32_t x;
+        int32_t y;
+        uint32_t width;
+        uint32_t height;
+        std::size_t row_size; // In the staging buffer, rows are packed tightly
+        uint32_t row_count;
+    };
+
+    struct Image_Staging_Info
+    {
         rhi::Image* dst;
+        bool is_discarded; // The regions cover the whole image
+        std::vector<Image_Copy_Info> copies;
     };
 
     struct Staging_Buffer
@@ -75,14 +233,92 @@ private:
         std::size_t offset;
     };
 
+    struct Scatter_Info
+    {
+        rhi::Buffer* src;
+        std::size_t src_offset;
+        rhi::Buffer* dst;
+        uint32_t write_count;
+    };
+
+    // Either a buffer or an image upload.
+    struct Deferred_Upload
+    {
+        uint64_t upload;
+        std::size_t size; // Of the staging memory
+        rhi::Buffer* dst;
+        std::size_t dst_offset;
+        const void* data;
+        Image_Staging_Info image; // Laid out, but not staged yet
+        std::vector<Image_Upload_Region> regions;
+    };
+
+    // What a finished frame still holds on to until its copy batch completed.
+    struct Frame_Retirement
+    {
+        uint64_t copy_value; // Zero if the frame had no copy batch
+        uint64_t ring_head;
+        std::vector<rhi::Image*> released_images;
+        std::vector<uint64_t> uploads;
+        std::vector<rhi::Buffer*> dedicated_staging_buffers;
+    };
+
     rhi::Graphics_Device* m_graphics_device;
-    std::array<std::vector<Staging_Buffer>, REN_MAX_FRAMES_IN_FLIGHT> m_coherent_staging_buffers;
+    enki::TaskScheduler* m_task_scheduler;
+    rhi::Buffer* m_staging_ring = nullptr;
+    uint64_t m_ring_head = 0; // Both are running totals, their difference is the space in use
+    uint64_t m_ring_tail = 0;
+    std::array<uint64_t, REN_MAX_FRAMES_IN_FLIGHT> m_frame_ring_heads = {}; // Ring head at the end of the frame
+    std::array<std::vector<rhi::Buffer*>, REN_MAX_FRAMES_IN_FLIGHT> m_dedicated_staging_buffers;
     std::array<std::vector<Buffer_Staging_Info>, REN_MAX_FRAMES_IN_FLIGHT> m_buffer_staging_infos;
     std::array<std::vector<Image_Staging_Info>, REN_MAX_FRAMES_IN_FLIGHT> m_image_staging_infos;
 
+    rhi::Fence* m_copy_fence = nullptr;
+    uint64_t m_copy_fence_value = 0;
+    std::array<uint64_t, REN_MAX_FRAMES_IN_FLIGHT> m_frame_copy_values = {}; // Signalled by the copy batch of the frame
+    std::vector<Image_Staging_Info> m_async_image_staging_infos;
+    std::array<std::vector<rhi::Image*>, REN_MAX_FRAMES_IN_FLIGHT> m_released_images; // By the copy batch of the frame
+    std::vector<rhi::Image*> m_acquired_images; // Acquired on the graphics queue by the next processed frame
+
+    std::vector<Buffer_Write> m_pending_writes;
+    std::vector<std::byte> m_pending_write_data;
+    std::vector<Buffer_Write> m_write_runs; // Merged pending writes, kept to reuse the allocations
+    std::vector<std::byte> m_write_run_data;
+
+    std::size_t m_frame_upload_budget = DEFAULT_FRAME_UPLOAD_BUDGET;
+    std::size_t m_frame_staged_bytes = 0; // Since the last processed frame
+    std::array<std::deque<Deferred_Upload>, UPLOAD_PRIORITY_COUNT> m_deferred_uploads;
+    Memory_Usage m_deferred_usage = {};
+    uint64_t m_next_upload = 1;
+    ankerl::unordered_dense::set<uint64_t> m_incomplete_uploads;
+    std::array<std::vector<uint64_t>, REN_MAX_FRAMES_IN_FLIGHT> m_frame_uploads; // Complete once the frame is
+    std::deque<Frame_Retirement> m_frame_retirements; // Frames the graphics queue finished, in order
+
+    std::array<std::vector<rhi::Buffer*>, REN_MAX_FRAMES_IN_FLIGHT> m_transient_buffers;
+    std::size_t m_transient_buffer_index = 0; // Next buffer in the pool of the current frame
+    Memory_Usage m_transient_allocations = {};
+
     std::size_t m_current_frame = 0;
 
+    Memory_Usage m_ring_allocations = {};
+    Memory_Usage m_dedicated_allocations = {};
+    Memory_Usage m_dedicated_buffers = {};
+    GPU_Transfer_Statistics m_last_frame_statistics = {};
+
 private:
     Staging_Buffer get_next_staging_buffer(std::size_t size, std::size_t alignment = 1ull);
+    Staging_Buffer create_dedicated_staging_buffer(std::size_t size);
+    void copy_to_staging_buffer(const Staging_Buffer& staging_buffer, const void* data, std::size_t size);
+    void stage_buffer(rhi::Buffer* dst, const void* data, std::size_t size, std::size_t dst_offset);
+    // Returns the size of the staging memory the copies need.
+    std::size_t layout_image_copies(rhi::Image* image, std::span<const Image_Upload_Region> regions,
+        Image_Staging_Info& image_staging_info);
+    void copy_image_to_staging_buffer(std::span<const Image_Upload_Region> regions, std::size_t size,
+        Image_Staging_Info& image_staging_info);
+    Image_Staging_Info stage_image(rhi::Image* image, std::span<const Image_Upload_Region> regions);
+    uint64_t defer_upload(Deferred_Upload&& deferred_upload, Upload_Priority priority);
+    void stage_deferred_upload(Deferred_Upload& deferred_upload);
+    void record_image_copies(rhi::Command_List* cmd, std::span<const Image_Staging_Info> image_staging_infos);
+    std::vector<Scatter_Info> coalesce_pending_writes(bool can_scatter);
 };
 }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ren
+{
+// Bytes and number of allocations of one kind of memory, the owner evicts against its budget.
+struct Memory_Usage
+{
+    std::size_t bytes = 0;
+    uint32_t count = 0;
+
+    void add(const std::size_t size) noexcept
+    {
+        bytes += size;
+        count += 1;
+    }
+
+    void remove(const std::size_t size) noexcept
+    {
+        bytes -= size;
+        count -= 1;
+    }
+};
+}
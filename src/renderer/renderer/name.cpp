@@ -0,0 +1,38 @@
+#include "renderer/name.hpp"
+
+#include <cassert>
+#include <memory>
+#include <mutex>
+
+namespace ren
+{
+namespace
+{
+// The strings are heap allocated, views into them stay valid while the table grows.
+struct Name_Table
+{
+    std::mutex mutex;
+    ankerl::unordered_dense::map<Name_Hash, std::unique_ptr<const std::string>> strings;
+};
+
+Name_Table& get_name_table()
+{
+    static Name_Table table;
+    return table;
+}
+}
+
+Name::Name(const std::string_view str)
+    : m_hash(hash_name(str))
+{
+    auto& table = get_name_table();
+    std::scoped_lock lock(table.mutex);
+    auto& interned = table.strings[m_hash];
+    if (!interned)
+    {
+        interned = std::make_unique<const std::string>(str);
+    }
+    assert(*interned == str && "Name hash collision.");
+    m_str = *interned;
+}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ren
+{
+using Name_Hash = uint64_t;
+
+// 64 bit FNV-1a, usable at compile time.
+[[nodiscard]] constexpr Name_Hash hash_name(const std::string_view str) noexcept
+{
+    Name_Hash hash = 0xcbf29ce484222325ull;
+    for (const auto c : str)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Interned name with a stable integer handle. Names built from literals are hashed at compile time,
+// so looking up a resource by a literal or a `constexpr` name does neither allocate nor hash.
+// Names built at runtime are hashed once and their string is interned for the lifetime of the process.
+// The string is always null terminated.
+class Name
+{
+public:
+    constexpr Name() noexcept = default;
+
+    template<std::size_t N>
+    consteval Name(const char (&str)[N]) noexcept //NOLINT
+        : m_hash(hash_name({ str, N - 1 }))
+        , m_str(str, N - 1)
+    {}
+
+    explicit Name(std::string_view str);
+
+    [[nodiscard]] constexpr Name_Hash hash() const noexcept { return m_hash; }
+    [[nodiscard]] constexpr std::string_view str() const noexcept { return m_str; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return m_str.empty(); }
+
+    [[nodiscard]] constexpr bool operator==(const Name& other) const noexcept
+    {
+        return m_hash == other.m_hash;
+    }
+
+    struct Hash
+    {
+        [[nodiscard]] uint64_t operator()(const Name& name) const noexcept
+        {
+            return ankerl::unordered_dense::hash<uint64_t>()(name.m_hash);
+        }
+    };
+
+private:
+    Name_Hash m_hash = hash_name({});
+    std::string_view m_str;
+};
+
+template<typename T>
+using Name_Map = ankerl::unordered_dense::map<Name, T, Name::Hash>;
+}
@@ -5,7 +5,7 @@
 
 namespace ren
 {
-Buffer::Buffer(Render_Resource_Blackboard& blackboard, rhi::Buffer** buffer, const std::string& name)
+Buffer::Buffer(Render_Resource_Blackboard& blackboard, rhi::Buffer** buffer, const Name name)
     : m_blackboard(&blackboard)
     , m_buffer(buffer)
     , m_name(name)
@@ -28,7 +28,7 @@ void Buffer::recreate(const rhi::Buffer_Create_Info& create_info)
     m_blackboard->delete_resource(*m_buffer);
     auto device = m_blackboard->m_device;
     *m_buffer = device->create_buffer(create_info).value_or(nullptr);
-    device->name_resource(*m_buffer, m_name.c_str());
+    device->name_resource(*m_buffer, m_name.str().data());
 }
 
 uint64_t Buffer::size() const noexcept
@@ -55,7 +55,7 @@ Buffer::operator void*() const
     return (*m_buffer)->data;
 }
 
-Buffer::operator const std::string&() const
+Buffer::operator Name() const
 {
     return m_name;
 }
@@ -82,7 +82,7 @@ Image_View::operator rhi::Image_View*() const
     return *m_image_view;
 }
 
-Image::Image(Render_Resource_Blackboard& blackboard, rhi::Image** image, const std::string& name)
+Image::Image(Render_Resource_Blackboard& blackboard, rhi::Image** image, const Name name)
     : m_blackboard(&blackboard)
     , m_image(image)
     , m_name(name)
@@ -117,7 +117,7 @@ void Image::recreate(const rhi::Image_Create_Info& create_info)
     m_blackboard->delete_resource(*m_image);
     auto device = m_blackboard->m_device;
     *m_image = device->create_image(create_info).value_or(nullptr);
-    device->name_resource(*m_image, m_name.c_str());
+    device->name_resource(*m_image, m_name.str().data());
 
     for (auto& image_view : m_image_views)
     {
@@ -158,7 +158,7 @@ Image::operator rhi::Image_View*() const
     return (*m_image)->image_view;
 }
 
-Image::operator const std::string&() const
+Image::operator Name() const
 {
     return m_name;
 }
@@ -224,64 +224,70 @@ Sampler Render_Resource_Blackboard::get_sampler(const rhi::Sampler_Create_Info&
     return m_samplers[create_info];
 }
 
-Buffer Render_Resource_Blackboard::create_buffer(const std::string& name, const rhi::Buffer_Create_Info& create_info, const uint32_t index)
+Buffer Render_Resource_Blackboard::create_buffer(const Name name, const rhi::Buffer_Create_Info& create_info, const uint32_t index)
 {
-    if (has_buffer(name)) return Buffer(*this, &(m_buffer_wrapper_ptrs[name]->buffer), name);
+    if (const auto it = m_buffer_wrapper_ptrs.find(name); it != m_buffer_wrapper_ptrs.end())
+        return Buffer(*this, &it->second->buffer, it->first);
     const auto buffer = &*m_buffers.emplace();
     m_buffer_wrapper_ptrs[name] = buffer;
     buffer->buffer = m_device->create_buffer(create_info, index).value_or(nullptr);
-    m_device->name_resource(buffer->buffer, name.c_str());
-    return Buffer(*this, &(m_buffer_wrapper_ptrs[name]->buffer), name);
+    m_device->name_resource(buffer->buffer, name.str().data());
+    return Buffer(*this, &buffer->buffer, name);
 }
 
-Buffer Render_Resource_Blackboard::get_buffer(const std::string& name)
+Buffer Render_Resource_Blackboard::get_buffer(const Name name)
 {
-    if (!has_buffer(name)) return Buffer();
-    return Buffer(*this, &(m_buffer_wrapper_ptrs[name]->buffer), name);
+    const auto it = m_buffer_wrapper_ptrs.find(name);
+    if (it == m_buffer_wrapper_ptrs.end()) return Buffer();
+    return Buffer(*this, &it->second->buffer, it->first);
 }
 
-bool Render_Resource_Blackboard::has_buffer(const std::string& name)
+bool Render_Resource_Blackboard::has_buffer(const Name name)
 {
     return m_buffer_wrapper_ptrs.contains(name);
 }
 
-void Render_Resource_Blackboard::destroy_buffer(const std::string& name)
+void Render_Resource_Blackboard::destroy_buffer(const Name name)
 {
-    if (!has_buffer(name))
+    const auto it = m_buffer_wrapper_ptrs.find(name);
+    if (it == m_buffer_wrapper_ptrs.end())
         return;
-    delete_resource(m_buffer_wrapper_ptrs[name]->buffer);
-    m_buffers.erase(m_buffers.get_iterator(m_buffer_wrapper_ptrs[name]));
-    m_buffer_wrapper_ptrs.erase(name);
+    delete_resource(it->second->buffer);
+    m_buffers.erase(m_buffers.get_iterator(it->second));
+    m_buffer_wrapper_ptrs.erase(it);
 }
 
-Image Render_Resource_Blackboard::create_image(const std::string& name, const rhi::Image_Create_Info& create_info, const uint32_t index)
+Image Render_Resource_Blackboard::create_image(const Name name, const rhi::Image_Create_Info& create_info, const uint32_t index)
 {
-    if (has_image(name)) return Image(*this, &(m_image_wrapper_ptrs[name]->image), name);
+    if (const auto it = m_image_wrapper_ptrs.find(name); it != m_image_wrapper_ptrs.end())
+        return Image(*this, &it->second->image, it->first);
     const auto image = &*m_images.emplace();
     m_image_wrapper_ptrs[name] = image;
     image->image = m_device->create_image(create_info, index).value_or(nullptr);
-    m_device->name_resource(image->image, name.c_str());
-    return Image(*this, &(m_image_wrapper_ptrs[name]->image), name);
+    m_device->name_resource(image->image, name.str().data());
+    return Image(*this, &image->image, name);
 }
 
-Image Render_Resource_Blackboard::get_image(const std::string& name)
+Image Render_Resource_Blackboard::get_image(const Name name)
 {
-    if (!has_image(name)) return Image();
-    return Image(*this, &(m_image_wrapper_ptrs[name]->image), name);
+    const auto it = m_image_wrapper_ptrs.find(name);
+    if (it == m_image_wrapper_ptrs.end()) return Image();
+    return Image(*this, &it->second->image, it->first);
 }
 
-bool Render_Resource_Blackboard::has_image(const std::string& name)
+bool Render_Resource_Blackboard::has_image(const Name name)
 {
     return m_image_wrapper_ptrs.contains(name);
 }
 
-void Render_Resource_Blackboard::destroy_image(const std::string& name)
+void Render_Resource_Blackboard::destroy_image(const Name name)
 {
-    if (!has_image(name))
+    const auto it = m_image_wrapper_ptrs.find(name);
+    if (it == m_image_wrapper_ptrs.end())
         return;
-    delete_resource(m_image_wrapper_ptrs[name]->image);
-    m_images.erase(m_images.get_iterator(m_image_wrapper_ptrs[name]));
-    m_image_wrapper_ptrs.erase(name);
+    delete_resource(it->second->image);
+    m_images.erase(m_images.get_iterator(it->second));
+    m_image_wrapper_ptrs.erase(it);
 }
 
 void Render_Resource_Blackboard::garbage_collect(const uint64_t frame)
@@ -4,6 +4,8 @@
 #include <ankerl/unordered_dense.h>
 #include <plf_colony.h>
 
+#include "renderer/name.hpp"
+
 namespace rhi
 {
 class Graphics_Device;
@@ -18,7 +20,7 @@ class Buffer
 {
 public:
     Buffer() = default;
-    Buffer(Render_Resource_Blackboard& blackboard, rhi::Buffer** buffer, const std::string& name);
+    Buffer(Render_Resource_Blackboard& blackboard, rhi::Buffer** buffer, Name name);
 
     rhi::Buffer_Create_Info get_create_info() const;
     void recreate(const rhi::Buffer_Create_Info& create_info);
@@ -28,12 +30,12 @@ public:
     operator uint32_t() const; //NOLINT
     operator rhi::Buffer*() const; //NOLINT
     operator void*() const; //NOLINT
-    operator const std::string&() const; //NOLINT
+    operator Name() const; //NOLINT
 
 private:
     Render_Resource_Blackboard* m_blackboard;
     rhi::Buffer** m_buffer;
-    std::string m_name;
+    Name m_name;
 };
 
 struct Image_View_Subresource_Info
@@ -62,7 +64,7 @@ class Image
 {
 public:
     Image() = default;
-    Image(Render_Resource_Blackboard& blackboard, rhi::Image** image, const std::string& name);
+    Image(Render_Resource_Blackboard& blackboard, rhi::Image** image, Name name);
     Image(rhi::Swapchain& swapchain);
 
     rhi::Image_Create_Info get_create_info() const;
@@ -72,14 +74,14 @@ public:
     operator uint32_t() const; //NOLINT
     operator rhi::Image*() const; //NOLINT
     operator rhi::Image_View*() const; //NOLINT
-    operator const std::string&() const; //NOLINT
+    operator Name() const; //NOLINT
 
 private:
     static constexpr auto MAX_IMAGE_VIEWS = 16;
 
     Render_Resource_Blackboard* m_blackboard;
     rhi::Image** m_image;
-    std::string m_name;
+    Name m_name;
     std::array<std::pair<Image_View_Subresource_Info, rhi::Image_View*>, MAX_IMAGE_VIEWS> m_image_views;
 
 private:
@@ -112,15 +114,15 @@ public:
 
     Sampler get_sampler(const rhi::Sampler_Create_Info& create_info);
 
-    Buffer create_buffer(const std::string& name, const rhi::Buffer_Create_Info& create_info, uint32_t index = rhi::NO_RESOURCE_INDEX);
-    Buffer get_buffer(const std::string& name);
-    bool has_buffer(const std::string& name);
-    void destroy_buffer(const std::string& name);
+    Buffer create_buffer(Name name, const rhi::Buffer_Create_Info& create_info, uint32_t index = rhi::NO_RESOURCE_INDEX);
+    Buffer get_buffer(Name name);
+    bool has_buffer(Name name);
+    void destroy_buffer(Name name);
 
-    Image create_image(const std::string& name, const rhi::Image_Create_Info& create_info, uint32_t index = rhi::NO_RESOURCE_INDEX);
-    Image get_image(const std::string& name);
-    bool has_image(const std::string& name);
-    void destroy_image(const std::string& name);
+    Image create_image(Name name, const rhi::Image_Create_Info& create_info, uint32_t index = rhi::NO_RESOURCE_INDEX);
+    Image get_image(Name name);
+    bool has_image(Name name);
+    void destroy_image(Name name);
 
     void garbage_collect(uint64_t frame);
 
@@ -149,9 +151,9 @@ private:
 
     ankerl::unordered_dense::map<rhi::Sampler_Create_Info, Sampler, Sampler_Hash> m_samplers;
 
-    ankerl::unordered_dense::map<std::string, Buffer_Wrapper*> m_buffer_wrapper_ptrs;
+    Name_Map<Buffer_Wrapper*> m_buffer_wrapper_ptrs;
     plf::colony<Buffer_Wrapper> m_buffers;
-    ankerl::unordered_dense::map<std::string, Image_Wrapper*> m_image_wrapper_ptrs;
+    Name_Map<Image_Wrapper*> m_image_wrapper_ptrs;
     plf::colony<Image_Wrapper> m_images;
 
     struct Deleted_Resource
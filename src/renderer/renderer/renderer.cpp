@@ -14,7 +14,7 @@
 
 namespace ren
 {
-constexpr static auto SHADED_GEOMETRY_RENDER_TARGET_NAME = "shaded_geometry_render_target";
+constexpr static Name SHADED_GEOMETRY_RENDER_TARGET_NAME = "shaded_geometry_render_target";
 
 float calculate_aspect_ratio(const rhi::Swapchain& swapchain)
 {
@@ -22,10 +22,12 @@ float calculate_aspect_ratio(const rhi::Swapchain& swapchain)
 }
 
 Renderer::Renderer(GPU_Transfer_Context& gpu_transfer_context,
+    GPU_Readback_Context& gpu_readback_context,
     rhi::Swapchain& swapchain,
     Asset_Repository& asset_repository,
     Render_Resource_Blackboard& resource_blackboard)
     : m_gpu_transfer_context(gpu_transfer_context)
+    , m_gpu_readback_context(gpu_readback_context)
     , m_swapchain(swapchain)
     , m_asset_repository(asset_repository)
     , m_resource_blackboard(resource_blackboard)
@@ -42,10 +44,6 @@ Renderer::Renderer(GPU_Transfer_Context& gpu_transfer_context,
         .yaw = 0.f,
         .position = { .0f, .0f, .5f }
     }
-    , m_camera_buffer(m_resource_blackboard.create_buffer("Camera Buffer", {
-        .size = sizeof(GPU_Camera_Data),
-        .heap = rhi::Memory_Heap_Type::GPU
-        }))
     , m_brdf_lut(
         m_asset_repository,
         m_resource_blackboard)
@@ -69,6 +67,7 @@ Renderer::Renderer(GPU_Transfer_Context& gpu_transfer_context,
     , m_ocean(
         m_asset_repository,
         m_gpu_transfer_context,
+        m_gpu_readback_context,
         m_resource_blackboard,
         m_swapchain.get_width(),
         m_swapchain.get_height())
@@ -78,6 +77,8 @@ Renderer::Renderer(GPU_Transfer_Context& gpu_transfer_context,
         m_resource_blackboard,
         m_swapchain.get_width(),
         m_swapchain.get_height())
+    , m_skinning(
+        m_asset_repository)
     , m_tone_map(
         m_asset_repository,
         m_gpu_transfer_context,
@@ -186,7 +187,7 @@ void Renderer::update(const Input_State& input_state, const Static_Scene_Data& s
         .jitter = {},
         .prev_jitter = {}
     };
-    m_gpu_transfer_context.enqueue_immediate_upload(m_camera_buffer, camera_data);
+    m_camera_buffer = m_gpu_transfer_context.upload_transient(camera_data);
 
     is_first_frame = false;
 }
@@ -277,6 +278,11 @@ void Renderer::render(
     tracker.flush_barriers(cmd);
 }
 
+void Renderer::skin(const Static_Scene_Data& scene, rhi::Command_List* cmd) noexcept
+{
+    m_skinning.skin_instances(cmd, scene);
+}
+
 void Renderer::on_resize(uint32_t width, uint32_t height) noexcept
 {
     auto resize_target = [width, height, this](Image& image)
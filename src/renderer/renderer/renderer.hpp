@@ -10,6 +10,7 @@
 #include "renderer/techniques/imgui.hpp"
 #include "renderer/techniques/ocean.hpp"
 #include "renderer/techniques/rt_soft_shadows.hpp"
+#include "renderer/techniques/skinning.hpp"
 #include "renderer/techniques/tone_map.hpp"
 
 namespace rhi
@@ -21,6 +22,7 @@ class Swapchain;
 namespace ren
 {
 class Asset_Repository;
+class GPU_Readback_Context;
 class GPU_Transfer_Context;
 class Input_State;
 struct Render_Attachment;
@@ -37,6 +39,7 @@ class Renderer
 {
 public:
     Renderer(GPU_Transfer_Context& gpu_transfer_context,
+        GPU_Readback_Context& gpu_readback_context,
         rhi::Swapchain& swapchain,
         Asset_Repository& asset_repository,
         Render_Resource_Blackboard& resource_blackboard);
@@ -46,21 +49,24 @@ public:
     void update(const Input_State& input_state, const Static_Scene_Data& scene, double t, double dt) noexcept;
     void setup_frame();
     void render(const Static_Scene_Data& scene, rhi::Command_List* cmd, double t, double dt) noexcept;
+    void skin(const Static_Scene_Data& scene, rhi::Command_List* cmd) noexcept;
     void on_resize(uint32_t width, uint32_t height) noexcept;
 
     void set_hdr_state(bool enabled, float display_peak_luminance_nits) noexcept;
     void set_benchmark_mode(Benchmark_Mode mode) noexcept { m_benchmark_mode = mode; }
+    [[nodiscard]] const Fly_Camera& get_camera() const noexcept { return m_fly_cam; }
     void debug_gui();
 
 private:
     GPU_Transfer_Context& m_gpu_transfer_context;
+    GPU_Readback_Context& m_gpu_readback_context;
     rhi::Swapchain& m_swapchain;
     Asset_Repository& m_asset_repository;
     Render_Resource_Blackboard& m_resource_blackboard;
 
     Fly_Camera m_fly_cam;
     Fly_Camera m_cull_cam;
-    Buffer m_camera_buffer;
+    uint32_t m_camera_buffer = 0; // Transient, written every frame
 
     Benchmark_Mode m_benchmark_mode = Benchmark_Mode::None;
 
@@ -77,6 +83,7 @@ private:
     techniques::Imgui m_imgui;
     techniques::Ocean m_ocean;
     techniques::RT_Soft_Shadows m_rt_soft_shadows;
+    techniques::Skinning m_skinning;
     techniques::Tone_Map m_tone_map;
 
 private:
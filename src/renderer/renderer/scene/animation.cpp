@@ -0,0 +1,265 @@
+#include "renderer/scene/animation.hpp"
+
+#include <shared/serialized_asset_formats.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <immintrin.h>
+
+namespace ren
+{
+namespace
+{
+struct Joint_Pose_SIMD
+{
+    __m128 translation; // x, y, z, 0
+    __m128 rotation; // x, y, z, w
+    __m128 scale; // x, y, z, 0
+};
+
+__m128 dequantize_unorm16x3(const uint16_t* value, const float* min, const float* extent)
+{
+    const auto q = _mm_cvtepi32_ps(_mm_setr_epi32(value[0], value[1], value[2], 0));
+    const auto range_min = _mm_setr_ps(min[0], min[1], min[2], 0.f);
+    const auto range_extent = _mm_setr_ps(extent[0], extent[1], extent[2], 0.f);
+    return _mm_add_ps(range_min, _mm_mul_ps(_mm_mul_ps(q, _mm_set1_ps(1.f / 65535.f)), range_extent));
+}
+
+__m128 dequantize_snorm16x4(const int16_t* value)
+{
+    const auto q = _mm_cvtepi32_ps(_mm_setr_epi32(value[0], value[1], value[2], value[3]));
+    return _mm_mul_ps(q, _mm_set1_ps(1.f / 32767.f));
+}
+
+__m128 lerp(__m128 a, __m128 b, __m128 t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+__m128 normalize4(__m128 v)
+{
+    auto length_squared = _mm_mul_ps(v, v);
+    length_squared = _mm_add_ps(length_squared, _mm_shuffle_ps(length_squared, length_squared, _MM_SHUFFLE(2, 3, 0, 1)));
+    length_squared = _mm_add_ps(length_squared, _mm_shuffle_ps(length_squared, length_squared, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_div_ps(v, _mm_sqrt_ps(length_squared));
+}
+
+Joint_Pose_SIMD sample_pose(const Animation_Clip& clip, uint32_t joint, uint32_t key_a, uint32_t key_b, float factor)
+{
+    const auto& track = clip.tracks[joint];
+    const auto& a = clip.keys[track.key_range_start + key_a];
+    const auto& b = clip.keys[track.key_range_start + key_b];
+    const auto t = _mm_set1_ps(factor);
+
+    // Keys are baked in the same rotation hemisphere, so nlerp does not need to flip the sign.
+    return {
+        .translation = lerp(
+            dequantize_unorm16x3(a.translation, track.translation_min, track.translation_extent),
+            dequantize_unorm16x3(b.translation, track.translation_min, track.translation_extent),
+            t),
+        .rotation = normalize4(lerp(dequantize_snorm16x4(a.rotation), dequantize_snorm16x4(b.rotation), t)),
+        .scale = lerp(
+            dequantize_unorm16x3(a.scale, track.scale_min, track.scale_extent),
+            dequantize_unorm16x3(b.scale, track.scale_min, track.scale_extent),
+            t)
+    };
+}
+
+Joint_Pose_SIMD rest_pose(const Skeleton& skeleton, uint32_t joint)
+{
+    const auto& t = skeleton.rest_translations[joint];
+    const auto& r = skeleton.rest_rotations[joint];
+    const auto& s = skeleton.rest_scales[joint];
+    return {
+        .translation = _mm_setr_ps(t.x, t.y, t.z, 0.f),
+        .rotation = _mm_setr_ps(r.x, r.y, r.z, r.w),
+        .scale = _mm_setr_ps(s.x, s.y, s.z, 0.f)
+    };
+}
+
+// Same convention as glm::translate * glm::mat4_cast * glm::scale.
+void compose(const Joint_Pose_SIMD& pose, __m128 result[4])
+{
+    alignas(16) float q[4];
+    alignas(16) float s[4];
+    _mm_store_ps(q, pose.rotation);
+    _mm_store_ps(s, pose.scale);
+    const auto x = q[0], y = q[1], z = q[2], w = q[3];
+
+    const auto c0 = _mm_setr_ps(1.f - 2.f * (y * y + z * z), 2.f * (x * y + w * z), 2.f * (x * z - w * y), 0.f);
+    const auto c1 = _mm_setr_ps(2.f * (x * y - w * z), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + w * x), 0.f);
+    const auto c2 = _mm_setr_ps(2.f * (x * z + w * y), 2.f * (y * z - w * x), 1.f - 2.f * (x * x + y * y), 0.f);
+
+    result[0] = _mm_mul_ps(c0, _mm_set1_ps(s[0]));
+    result[1] = _mm_mul_ps(c1, _mm_set1_ps(s[1]));
+    result[2] = _mm_mul_ps(c2, _mm_set1_ps(s[2]));
+    result[3] = _mm_add_ps(pose.translation, _mm_setr_ps(0.f, 0.f, 0.f, 1.f));
+}
+
+void load(const glm::mat4& m, __m128 result[4])
+{
+    for (auto i = 0; i < 4; ++i)
+        result[i] = _mm_loadu_ps(&m[i][0]);
+}
+
+void store(const __m128 m[4], glm::mat4& result)
+{
+    for (auto i = 0; i < 4; ++i)
+        _mm_storeu_ps(&result[i][0], m[i]);
+}
+
+// Column major a * b, `result` may not alias `a`.
+void multiply(const __m128 a[4], const __m128 b[4], __m128 result[4])
+{
+    for (auto i = 0; i < 4; ++i)
+    {
+        const auto column = b[i];
+        auto r = _mm_mul_ps(a[0], _mm_shuffle_ps(column, column, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(a[1], _mm_shuffle_ps(column, column, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(a[2], _mm_shuffle_ps(column, column, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(a[3], _mm_shuffle_ps(column, column, _MM_SHUFFLE(3, 3, 3, 3))));
+        result[i] = r;
+    }
+}
+}
+
+void load_animations(
+    serialization::Animation_Header_00* animations,
+    std::vector<Skeleton>& skeletons,
+    std::vector<Animation_Clip>& clips)
+{
+    const auto* loadable_skeletons = animations->get_skeletons();
+    const auto* loadable_joints = animations->get_joints();
+    const auto* loadable_skin_bindings = animations->get_skin_bindings();
+
+    skeletons.resize(animations->skeleton_count);
+    for (auto i = 0; i < animations->skeleton_count; ++i)
+    {
+        const auto& loadable_skeleton = loadable_skeletons[i];
+        auto& skeleton = skeletons[i];
+        skeleton.name = loadable_skeleton.name;
+        memcpy(&skeleton.root_transform, loadable_skeleton.root_transform, sizeof(glm::mat4));
+
+        const auto joint_count = loadable_skeleton.joint_range_end - loadable_skeleton.joint_range_start;
+        skeleton.parents.resize(joint_count);
+        skeleton.inverse_bind_matrices.resize(joint_count);
+        skeleton.rest_translations.resize(joint_count);
+        skeleton.rest_rotations.resize(joint_count);
+        skeleton.rest_scales.resize(joint_count);
+        for (auto j = 0; j < joint_count; ++j)
+        {
+            const auto& joint = loadable_joints[loadable_skeleton.joint_range_start + j];
+            skeleton.parents[j] = joint.parent_index < joint_count
+                ? joint.parent_index
+                : serialization::JOINT_PARENT_INDEX_NO_PARENT;
+            memcpy(&skeleton.inverse_bind_matrices[j], joint.inverse_bind_matrix, sizeof(glm::mat4));
+            skeleton.rest_translations[j] = { joint.rest_translation[0], joint.rest_translation[1], joint.rest_translation[2] };
+            skeleton.rest_rotations[j] = glm::quat(
+                joint.rest_rotation[0], joint.rest_rotation[1], joint.rest_rotation[2], joint.rest_rotation[3]);
+            skeleton.rest_scales[j] = { joint.rest_scale[0], joint.rest_scale[1], joint.rest_scale[2] };
+        }
+
+        // Sorting by depth puts every parent in front of its children, regardless of the order in the file.
+        std::vector<uint32_t> depths(joint_count, 0);
+        for (auto j = 0; j < joint_count; ++j)
+        {
+            auto parent = skeleton.parents[j];
+            while (parent != serialization::JOINT_PARENT_INDEX_NO_PARENT && depths[j] < joint_count)
+            {
+                depths[j] += 1;
+                parent = skeleton.parents[parent];
+            }
+        }
+        skeleton.evaluation_order.resize(joint_count);
+        std::iota(skeleton.evaluation_order.begin(), skeleton.evaluation_order.end(), 0);
+        std::ranges::stable_sort(skeleton.evaluation_order, {}, [&](const uint32_t joint) { return depths[joint]; });
+
+        for (auto j = loadable_skeleton.skin_binding_range_start; j < loadable_skeleton.skin_binding_range_end; ++j)
+        {
+            skeleton.skinned_mesh_indices.push_back(loadable_skin_bindings[j].instance_index);
+        }
+    }
+
+    const auto* loadable_clips = animations->get_clips();
+    clips.reserve(animations->clip_count);
+    for (auto i = 0; i < animations->clip_count; ++i)
+    {
+        const auto& loadable_clip = loadable_clips[i];
+        if (loadable_clip.skeleton_index >= skeletons.size()
+            || loadable_clip.track_range_end - loadable_clip.track_range_start != skeletons[loadable_clip.skeleton_index].get_joint_count())
+        {
+            continue;
+        }
+        clips.emplace_back( Animation_Clip {
+            .name = loadable_clip.name,
+            .skeleton_index = loadable_clip.skeleton_index,
+            .sample_rate = loadable_clip.sample_rate,
+            .duration = loadable_clip.duration,
+            .sample_count = loadable_clip.sample_count,
+            .tracks = animations->get_tracks() + loadable_clip.track_range_start,
+            .keys = animations->get_keys()
+        });
+    }
+}
+
+void evaluate_joint_palette(
+    const Skeleton& skeleton,
+    const Animation_Clip* clip,
+    float time,
+    glm::mat4* palette)
+{
+    uint32_t key_a = 0;
+    uint32_t key_b = 0;
+    float factor = 0.f;
+    if (clip && clip->sample_count > 0)
+    {
+        const auto sample = std::clamp(time, 0.f, clip->duration) * clip->sample_rate;
+        key_a = std::min(static_cast<uint32_t>(sample), clip->sample_count - 1);
+        key_b = std::min(key_a + 1, clip->sample_count - 1);
+        factor = std::clamp(sample - static_cast<float>(key_a), 0.f, 1.f);
+    }
+    else
+    {
+        clip = nullptr;
+    }
+
+    __m128 root[4];
+    load(skeleton.root_transform, root);
+
+    // Global joint transforms are accumulated in the palette first.
+    for (const auto joint : skeleton.evaluation_order)
+    {
+        const auto pose = clip
+            ? sample_pose(*clip, joint, key_a, key_b, factor)
+            : rest_pose(skeleton, joint);
+        __m128 local[4];
+        compose(pose, local);
+
+        __m128 global[4];
+        const auto parent = skeleton.parents[joint];
+        if (parent != serialization::JOINT_PARENT_INDEX_NO_PARENT)
+        {
+            __m128 parent_global[4];
+            load(palette[parent], parent_global);
+            multiply(parent_global, local, global);
+        }
+        else
+        {
+            multiply(root, local, global);
+        }
+        store(global, palette[joint]);
+    }
+
+    for (auto joint = 0u; joint < skeleton.get_joint_count(); ++joint)
+    {
+        __m128 global[4];
+        __m128 inverse_bind[4];
+        __m128 skinning[4];
+        load(palette[joint], global);
+        load(skeleton.inverse_bind_matrices[joint], inverse_bind);
+        multiply(global, inverse_bind, skinning);
+        store(skinning, palette[joint]);
+    }
+}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <string>
+#include <vector>
+
+namespace serialization
+{
+struct Animation_Header_00;
+struct Joint_Track_00;
+struct Joint_Key_00;
+}
+
+namespace ren
+{
+struct Skeleton
+{
+    std::string name;
+    glm::mat4 root_transform;
+    std::vector<uint32_t> parents;
+    std::vector<glm::mat4> inverse_bind_matrices;
+    std::vector<glm::vec3> rest_translations;
+    std::vector<glm::quat> rest_rotations;
+    std::vector<glm::vec3> rest_scales;
+    std::vector<uint32_t> evaluation_order; // Parents are always evaluated before their children
+    std::vector<uint32_t> skinned_mesh_indices; // Meshes of the model deformed by this skeleton
+
+    [[nodiscard]] uint32_t get_joint_count() const noexcept { return static_cast<uint32_t>(parents.size()); }
+};
+
+struct Animation_Clip
+{
+    std::string name;
+    uint32_t skeleton_index;
+    float sample_rate;
+    float duration;
+    uint32_t sample_count;
+    const serialization::Joint_Track_00* tracks; // One track per joint, points into the mapped file pinned by the model
+    const serialization::Joint_Key_00* keys;
+};
+
+void load_animations(
+    serialization::Animation_Header_00* animations,
+    std::vector<Skeleton>& skeletons,
+    std::vector<Animation_Clip>& clips);
+
+// Writes one skinning matrix per joint of the skeleton to `palette`.
+// Without a clip the rest pose is evaluated.
+void evaluate_joint_palette(
+    const Skeleton& skeleton,
+    const Animation_Clip* clip,
+    float time,
+    glm::mat4* palette);
+}
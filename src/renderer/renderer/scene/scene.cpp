@@ -4,7 +4,16 @@
 #include "renderer/asset/asset_formats.hpp"
 #include "renderer/asset/asset_repository.hpp"
 #include "renderer/acceleration_structure_builder.hpp"
-
+#include "renderer/filesystem/mapped_file.hpp"
+#include "renderer/scene/camera.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <limits>
 #include <numeric>
 #include <ranges>
 #include <shared/serialized_asset_formats.hpp>
@@ -16,6 +25,7 @@
 
 #include <shared/shared_resources.h>
 #include <imgui.h>
+#include <TaskScheduler.h>
 
 namespace ren
 {
@@ -42,6 +52,156 @@ constexpr static auto DEFAULT_SAMPLER_CREATE_INFO = rhi::Sampler_Create_Info {
     .anisotropy_enable = true
 };
 
+// Load files are pinned in the asset repository until they are integrated.
+// Models are integrated once their geometry uploads are complete.
+struct Static_Scene_Data::Model_Load
+{
+    Model_Descriptor descriptor;
+    Mapped_File* file;
+    bool is_valid = false;
+    std::unique_ptr<enki::TaskSet> task;
+    Model* model = nullptr; // Created when the geometry is uploaded
+    std::vector<uint64_t> uploads = {};
+};
+
+struct Static_Scene_Data::Texture_Load
+{
+    constexpr static auto TAIL_MIP = ~0u;
+
+    std::string uri;
+    Mapped_File* file;
+    uint32_t first_mip; // TAIL_MIP is resolved by the worker once the texture is validated
+    bool is_valid = false;
+    std::unique_ptr<enki::TaskSet> task;
+};
+
+// Mips up to this size are loaded with the texture, more detailed ones are streamed on demand.
+constexpr static auto STREAMING_TAIL_SIZE = 128u;
+constexpr static auto MAX_TEXTURE_LOADS_IN_FLIGHT = 16u;
+constexpr static auto MIB = 1024ull * 1024ull;
+
+// Everything the main thread reads while integrating is checked against the file size and the element counts.
+bool validate_model(const Mapped_File& file)
+{
+    if (!file.data || file.size < sizeof(serialization::Model_Header_00))
+    {
+        return false;
+    }
+    auto* model = static_cast<serialization::Model_Header_00*>(file.data);
+    if (!model->header.validate() || model->get_size() > file.size)
+    {
+        return false;
+    }
+    for (auto i = 0u; i < model->referenced_uri_count; ++i)
+    {
+        if (!std::memchr(model->get_referenced_uris()[i].value, '\0', serialization::NAME_FIELD_SIZE))
+        {
+            return false;
+        }
+    }
+    const auto is_uri_index_valid = [&](const uint32_t index)
+    {
+        return index == serialization::Material_00::URI_NO_REFERENCE || index < model->referenced_uri_count;
+    };
+    for (auto i = 0u; i < model->material_count; ++i)
+    {
+        const auto& material = model->get_materials()[i];
+        if (!is_uri_index_valid(material.albedo_uri_index)
+            || !is_uri_index_valid(material.normal_uri_index)
+            || !is_uri_index_valid(material.metallic_roughness_uri_index)
+            || !is_uri_index_valid(material.emissive_uri_index))
+        {
+            return false;
+        }
+    }
+    const auto is_range_valid = [](const uint32_t start, const uint32_t end, const uint32_t count)
+    {
+        return start <= end && end <= count;
+    };
+    for (auto i = 0u; i < model->submesh_count; ++i)
+    {
+        const auto& submesh = model->get_submeshes()[i];
+        if ((submesh.material_index != MESH_PARENT_INDEX_NO_PARENT && submesh.material_index >= model->material_count)
+            || !is_range_valid(submesh.vertex_position_range_start, submesh.vertex_position_range_end, model->vertex_position_count)
+            || !is_range_valid(submesh.vertex_attribute_range_start, submesh.vertex_attribute_range_end, model->vertex_attribute_count)
+            || !is_range_valid(submesh.vertex_skin_attribute_range_start, submesh.vertex_skin_attribute_range_end, model->vertex_skin_attribute_count)
+            || !is_range_valid(submesh.index_range_start, submesh.index_range_end, model->index_count))
+        {
+            return false;
+        }
+    }
+    for (auto i = 0u; i < model->instance_count; ++i)
+    {
+        const auto& instance = model->get_instances()[i];
+        if ((instance.parent_index != MESH_PARENT_INDEX_NO_PARENT && instance.parent_index >= model->instance_count)
+            || !is_range_valid(instance.submeshes_range_start, instance.submeshes_range_end, model->submesh_count))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool validate_texture(const Mapped_File& file)
+{
+    if (!file.data || file.size < sizeof(serialization::Image_Data_00))
+    {
+        return false;
+    }
+    auto* image = static_cast<serialization::Image_Data_00*>(file.data);
+    if (!image->header.validate() || image->mip_count == 0 || image->mip_count > static_cast<uint32_t>(serialization::TEXTURE_MAX_MIP_LEVELS))
+    {
+        return false;
+    }
+    return image->get_mip_data(image->mip_count) <= static_cast<char*>(file.data) + file.size;
+}
+
+uint32_t get_tail_mip(const serialization::Image_Data_00& image)
+{
+    for (auto mip = 0u; mip < image.mip_count; ++mip)
+    {
+        if (std::max(image.mips[mip].width, image.mips[mip].height) <= STREAMING_TAIL_SIZE)
+        {
+            return mip;
+        }
+    }
+    return image.mip_count - 1;
+}
+
+// Size of the mips from `first_mip` to the end of the chain.
+std::size_t get_mip_chain_size(serialization::Image_Data_00& image, const uint32_t first_mip)
+{
+    return image.get_mip_data(image.mip_count) - image.get_mip_data(first_mip);
+}
+
+// The square root of the texture coordinate area per surface area, both are scaled the same by a projection.
+float calculate_uv_density(
+    const glm::vec3* positions,
+    const serialization::Vertex_Attributes* attributes,
+    const uint32_t* indices,
+    const uint32_t index_count,
+    const uint32_t vertex_count)
+{
+    double surface_area = 0.;
+    double uv_area = 0.;
+    for (auto i = 0u; i + 2 < index_count; i += 3)
+    {
+        const auto a = indices[i];
+        const auto b = indices[i + 1];
+        const auto c = indices[i + 2];
+        if (a >= vertex_count || b >= vertex_count || c >= vertex_count)
+        {
+            continue;
+        }
+        surface_area += glm::length(glm::cross(positions[b] - positions[a], positions[c] - positions[a]));
+        const auto uv_a = glm::vec2(attributes[a].tex_coords[0], attributes[a].tex_coords[1]);
+        const auto uv_ab = glm::vec2(attributes[b].tex_coords[0], attributes[b].tex_coords[1]) - uv_a;
+        const auto uv_ac = glm::vec2(attributes[c].tex_coords[0], attributes[c].tex_coords[1]) - uv_a;
+        uv_area += std::abs(uv_ab.x * uv_ac.y - uv_ab.y * uv_ac.x);
+    }
+    return surface_area > 0. ? static_cast<float>(std::sqrt(uv_area / surface_area)) : 0.f;
+}
+
 glm::mat4 TRS::to_mat() const noexcept
 {
     const auto s = glm::scale(glm::identity<glm::mat4>(), scale);
@@ -67,45 +227,168 @@ glm::mat3 TRS::adjugate(const glm::mat4& parent) const noexcept
 
 void Static_Scene_Data::add_model(const Model_Descriptor& model_descriptor)
 {
-    auto& model = *m_models.emplace();
-    auto* loadable_model = static_cast<serialization::Model_Header_00*>(
-        m_asset_repository.get_model(model_descriptor.name)->data);
+    auto* model_file = m_asset_repository.get_model(model_descriptor.name);
+    m_asset_repository.pin_file(model_file);
     m_logger->info("Loading model '{}'", model_descriptor.name);
+    auto& load = *m_model_loads.emplace_back(std::make_unique<Model_Load>(Model_Load {
+        .descriptor = model_descriptor,
+        .file = model_file
+    }));
+    load.task = std::make_unique<enki::TaskSet>(1,
+        [load = &load](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            // Workers only read the pinned file, the asset repository is not thread safe.
+            load->is_valid = validate_model(*load->file);
+            if (load->is_valid)
+            {
+                load->file->populate();
+            }
+        });
+    m_task_scheduler.AddTaskSetToPipe(load.task.get());
+}
+
+void Static_Scene_Data::integrate_loads()
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto budget = std::chrono::duration<float, std::milli>(m_load_budget_ms);
+    // At least one load is integrated per frame, so loading always progresses.
+    const auto has_budget = [&]
+    {
+        return std::chrono::steady_clock::now() - start < budget;
+    };
 
-    // create buffers and upload the data
+    // Uploads are deferred by the transfer context, so they can start as soon as the model is validated.
+    for (const auto& load : m_model_loads)
+    {
+        if (!load->model && load->task->GetIsComplete() && load->is_valid)
+        {
+            load->model = &upload_model_geometry(load->descriptor, *load->file, load->uploads);
+        }
+    }
+    const auto is_uploaded = [this](const Model_Load& load)
+    {
+        return std::ranges::all_of(load.uploads, [this](const uint64_t upload)
+        {
+            return m_gpu_transfer_context.is_upload_complete(upload);
+        });
+    };
+    while (!m_model_loads.empty() && m_model_loads.front()->task->GetIsComplete() && has_budget())
+    {
+        if (m_model_loads.front()->is_valid && !is_uploaded(*m_model_loads.front()))
+        {
+            break;
+        }
+        const auto load = std::move(m_model_loads.front());
+        m_model_loads.pop_front();
+        if (load->is_valid)
+        {
+            integrate_model(load->descriptor, *load->file, *load->model);
+        }
+        else
+        {
+            m_logger->error("Failed to validate model '{}'", load->descriptor.name);
+        }
+        m_asset_repository.unpin_file(load->file);
+    }
+    for (auto it = m_texture_loads.begin(); it != m_texture_loads.end() && has_budget();)
+    {
+        if (!(*it)->task->GetIsComplete())
+        {
+            ++it;
+            continue;
+        }
+        integrate_texture(**it);
+        m_asset_repository.unpin_file((*it)->file);
+        it = m_texture_loads.erase(it);
+    }
+}
+
+Scene_Load_Progress Static_Scene_Data::get_load_progress() const noexcept
+{
+    Scene_Load_Progress progress = {
+        .pending_models = static_cast<uint32_t>(m_model_loads.size()),
+        .pending_textures = static_cast<uint32_t>(m_texture_loads.size()),
+        .pending_bytes = 0,
+        .texture_bytes = m_image_usage.bytes
+    };
+    for (const auto& load : m_model_loads)
+    {
+        progress.pending_bytes += load->file->size;
+    }
+    for (const auto& load : m_texture_loads)
+    {
+        progress.pending_bytes += load->file->size;
+    }
+    return progress;
+}
+
+Model& Static_Scene_Data::upload_model_geometry(const Model_Descriptor& model_descriptor, const Mapped_File& model_file,
+    std::vector<uint64_t>& uploads)
+{
+    auto& model = *m_models.emplace();
+    model.blas_allocation = nullptr;
+    auto* loadable_model = static_cast<serialization::Model_Header_00*>(model_file.data);
+
+    // create buffers and upload the data, the file stays pinned until the uploads are complete
     {
         rhi::Buffer_Create_Info buffer_create_info = {
             .size = loadable_model->vertex_position_count * sizeof(std::array<float, 3>),
             .heap = rhi::Memory_Heap_Type::GPU
         };
         model.vertex_positions = m_graphics_device->create_buffer(buffer_create_info).value_or(nullptr);
+        track_buffer(model.vertex_positions);
         m_graphics_device->name_resource(model.vertex_positions, (std::string("gltf:") + model_descriptor.name + ":position").c_str());
         buffer_create_info.size = loadable_model->vertex_attribute_count * sizeof(serialization::Vertex_Attributes);
         model.vertex_attributes = m_graphics_device->create_buffer(buffer_create_info).value_or(nullptr);
+        track_buffer(model.vertex_attributes);
         m_graphics_device->name_resource(model.vertex_attributes, (std::string("gltf:") + model_descriptor.name + ":attributes").c_str());
+        model.vertex_skin_attributes = nullptr;
+        if (loadable_model->vertex_skin_attribute_count > 0)
+        {
+            buffer_create_info.size = loadable_model->vertex_skin_attribute_count * sizeof(serialization::Vertex_Skin_Attributes);
+            model.vertex_skin_attributes = m_graphics_device->create_buffer(buffer_create_info).value_or(nullptr);
+            track_buffer(model.vertex_skin_attributes);
+            m_graphics_device->name_resource(model.vertex_skin_attributes, (std::string("gltf:") + model_descriptor.name + ":skin_attributes").c_str());
+            uploads.push_back(m_gpu_transfer_context.enqueue_deferred_upload(
+                model.vertex_skin_attributes,
+                loadable_model->get_vertex_skin_attributes(),
+                loadable_model->vertex_skin_attribute_count * sizeof(serialization::Vertex_Skin_Attributes),
+                0,
+                Upload_Priority::Geometry));
+        }
         model.index_buffer_allocation = m_index_buffer_allocator.allocate(loadable_model->index_count);
 
         auto* positions = loadable_model->get_vertex_positions();
-        m_gpu_transfer_context.enqueue_immediate_upload(
+        uploads.push_back(m_gpu_transfer_context.enqueue_deferred_upload(
             model.vertex_positions,
             positions,
             loadable_model->vertex_position_count * sizeof(std::array<float, 3>),
-            0);
+            0,
+            Upload_Priority::Geometry));
 
         auto* attributes = loadable_model->get_vertex_attributes();
-        m_gpu_transfer_context.enqueue_immediate_upload(
+        uploads.push_back(m_gpu_transfer_context.enqueue_deferred_upload(
             model.vertex_attributes,
             attributes,
             loadable_model->vertex_attribute_count * sizeof(serialization::Vertex_Attributes),
-            0);
+            0,
+            Upload_Priority::Geometry));
 
         auto* indices = loadable_model->get_indices();
-        m_gpu_transfer_context.enqueue_immediate_upload(
+        uploads.push_back(m_gpu_transfer_context.enqueue_deferred_upload(
             m_global_index_buffer,
             indices,
             loadable_model->index_count * sizeof(std::uint32_t),
-            model.index_buffer_allocation.offset * sizeof(std::uint32_t));
+            model.index_buffer_allocation.offset * sizeof(std::uint32_t),
+            Upload_Priority::Geometry));
     }
+    return model;
+}
+
+void Static_Scene_Data::integrate_model(const Model_Descriptor& model_descriptor, const Mapped_File& model_file,
+    Model& model)
+{
+    auto* loadable_model = static_cast<serialization::Model_Header_00*>(model_file.data);
 
     model.materials.resize(loadable_model->material_count);
     for (auto i = 0; i < loadable_model->material_count; ++i)
@@ -115,13 +398,23 @@ void Static_Scene_Data::add_model(const Model_Descriptor& model_descriptor)
         model.materials[i] = &m_materials[material_index];
         auto& material = *model.materials[i];
 
-        auto get_material_texture = [&](uint32_t index, rhi::Image* replacement) -> rhi::Image* {
+        auto get_material_texture = [&](uint32_t index, rhi::Image* replacement, rhi::Image* Material::* image) -> rhi::Image* {
             const auto* uris = loadable_model->get_referenced_uris();
             if (index == ~0u)
             {
                 return replacement;
             }
-            return get_or_create_image(uris[index].value, replacement);
+            const std::string uri = uris[index].value;
+            if (const auto it = m_textures.find(uri); it != m_textures.end())
+            {
+                it->second.bindings.push_back({ .material = &material, .image = image });
+                return it->second.image ? it->second.image : replacement;
+            }
+            if (auto* texture_file = m_asset_repository.get_texture_safe(uri))
+            {
+                request_texture(uri, *texture_file, { .material = &material, .image = image });
+            }
+            return replacement;
         };
 
         material = {
@@ -140,39 +433,15 @@ void Static_Scene_Data::add_model(const Model_Descriptor& model_descriptor)
                 loadable_material.emissive_color[2]
             },
             .emissive_strength = loadable_material.emissive_strength,
-            .albedo = get_material_texture(loadable_material.albedo_uri_index, m_default_albedo_tex),
-            .normal = get_material_texture(loadable_material.normal_uri_index, m_default_normal_tex),
-            .metallic_roughness = get_material_texture(loadable_material.metallic_roughness_uri_index, m_default_metallic_roughness_tex),
-            .emissive = get_material_texture(loadable_material.emissive_uri_index, m_default_emissive_tex),
+            .albedo = get_material_texture(loadable_material.albedo_uri_index, m_default_albedo_tex, &Material::albedo),
+            .normal = get_material_texture(loadable_material.normal_uri_index, m_default_normal_tex, &Material::normal),
+            .metallic_roughness = get_material_texture(loadable_material.metallic_roughness_uri_index, m_default_metallic_roughness_tex, &Material::metallic_roughness),
+            .emissive = get_material_texture(loadable_material.emissive_uri_index, m_default_emissive_tex, &Material::emissive),
             .sampler = m_render_resource_blackboard.get_sampler(DEFAULT_SAMPLER_CREATE_INFO),
             .alpha_mode = static_cast<Material_Alpha_Mode>(loadable_material.alpha_mode),
             .double_sided = static_cast<bool>(loadable_material.double_sided),
         };
-
-        auto get_image_index = [&](const rhi::Image* image)
-        {
-            if (!image) return ~0u;
-            return image->image_view->bindless_index;
-        };
-
-        GPU_Material gpu_material = {
-            .base_color_factor = glm::packUint4x8(material.base_color_factor),
-            .pbr_roughness = material.pbr_roughness,
-            .pbr_metallic = material.pbr_metallic,
-            .emissive_color = material.emissive_color,
-            .emissive_strength = material.emissive_strength,
-            .albedo = get_image_index(material.albedo),
-            .normal = get_image_index(material.normal),
-            .metallic_roughness = get_image_index(material.metallic_roughness),
-            .emissive = get_image_index(material.emissive),
-            .sampler_id = material.sampler->bindless_index
-        };
-
-        m_gpu_transfer_context.enqueue_immediate_upload(
-            m_material_buffer,
-            &gpu_material,
-            sizeof(GPU_Material),
-            material.material_index * sizeof(GPU_Material));
+        upload_material(material);
     }
 
     uint64_t acceleration_structure_buffer_size = 0;
@@ -194,8 +463,26 @@ void Static_Scene_Data::add_model(const Model_Descriptor& model_descriptor)
         submesh.first_index = loadable_submesh.index_range_start;
         submesh.index_count = loadable_submesh.index_range_end - loadable_submesh.index_range_start;
         submesh.first_vertex = loadable_submesh.vertex_position_range_start;
-        submesh.aabb_min = {};
-        submesh.aabb_max = {};
+        submesh.vertex_count = loadable_submesh.vertex_position_range_end - loadable_submesh.vertex_position_range_start;
+        submesh.first_skin_attribute = loadable_submesh.vertex_skin_attribute_range_start;
+        submesh.is_skinned = model.vertex_skin_attributes != nullptr
+            && loadable_submesh.vertex_skin_attribute_range_end - loadable_submesh.vertex_skin_attribute_range_start >= submesh.vertex_count;
+        const auto* submesh_positions = reinterpret_cast<const glm::vec3*>(loadable_model->get_vertex_positions()) + submesh.first_vertex;
+        submesh.aabb_min = submesh.vertex_count > 0 ? glm::vec3(std::numeric_limits<float>::max()) : glm::vec3();
+        submesh.aabb_max = submesh.vertex_count > 0 ? glm::vec3(std::numeric_limits<float>::lowest()) : glm::vec3();
+        for (auto j = 0u; j < submesh.vertex_count; ++j)
+        {
+            submesh.aabb_min = glm::min(submesh.aabb_min, submesh_positions[j]);
+            submesh.aabb_max = glm::max(submesh.aabb_max, submesh_positions[j]);
+        }
+        submesh.uv_density = loadable_submesh.vertex_attribute_range_end - loadable_submesh.vertex_attribute_range_start >= submesh.vertex_count
+            ? calculate_uv_density(
+                submesh_positions,
+                reinterpret_cast<const serialization::Vertex_Attributes*>(loadable_model->get_vertex_attributes()) + loadable_submesh.vertex_attribute_range_start,
+                loadable_model->get_indices() + submesh.first_index,
+                submesh.index_count,
+                submesh.vertex_count)
+            : 0.f;
         submesh.material = loadable_submesh.material_index != MESH_PARENT_INDEX_NO_PARENT
             ? model.materials[loadable_submesh.material_index]
             : &m_default_material;
@@ -212,7 +499,7 @@ void Static_Scene_Data::add_model(const Model_Descriptor& model_descriptor)
                     .vertex_gpu_address = model.vertex_positions->gpu_address + sizeof(glm::vec3) * submesh.first_vertex,
                     .index_gpu_address = m_global_index_buffer->gpu_address + sizeof(uint32_t) * (submesh.first_index + model.index_buffer_allocation.offset),
                     .vertex_format = rhi::Image_Format::R32G32B32_SFLOAT,
-                    .vertex_count = loadable_submesh.vertex_position_range_end - loadable_submesh.vertex_position_range_start,
+                    .vertex_count = submesh.vertex_count,
                     .vertex_stride = 12,
                     .index_count = submesh.index_count,
                     .index_type = rhi::Index_Type::U32
@@ -243,6 +530,7 @@ void Static_Scene_Data::add_model(const Model_Descriptor& model_descriptor)
         .acceleration_structure_memory = true
     };
     model.blas_allocation = m_graphics_device->create_buffer(blas_buffer_create_info).value_or(nullptr);
+    track_buffer(model.blas_allocation);
     m_graphics_device->name_resource(model.blas_allocation, (std::string("gltf:") + model_descriptor.name + ":blas_allocation").c_str());
 
     for (auto& blas_info : submesh_blas_infos)
@@ -315,11 +603,27 @@ void Static_Scene_Data::add_model(const Model_Descriptor& model_descriptor)
         }
     }
 
+    const auto animation_name = std::filesystem::path(model_descriptor.name)
+        .replace_extension(serialization::ANIMATION_FILE_EXTENSION).string();
+    if (auto* animation_file = m_asset_repository.get_animation_safe(animation_name); animation_file && model.vertex_skin_attributes)
+    {
+        load_animations(
+            static_cast<serialization::Animation_Header_00*>(animation_file->data),
+            model.skeletons,
+            model.animation_clips);
+        // The clips are sampled from the mapped file every frame, it must not be evicted.
+        m_asset_repository.pin_file(animation_file);
+        model.animation_file = animation_file;
+        m_logger->info("Loaded {} skeletons and {} animation clips for model '{}'",
+            model.skeletons.size(), model.animation_clips.size(), model_descriptor.name);
+    }
+
     for (auto& model_instance_descriptor : model_descriptor.instances)
     {
         auto& model_instance = *m_model_Instances.emplace();
         model_instance.model = &model;
         model_instance.trs = model_instance_descriptor;
+        model_instance.model_to_world = model_instance.trs.to_mat();
         model_instance.mesh_instances.resize(model.meshes.size());
         for (auto i = 0; i < model.meshes.size(); ++i)
         {
@@ -348,35 +652,64 @@ void Static_Scene_Data::add_model(const Model_Descriptor& model_descriptor)
             if (mesh_instance.parent)
                 mesh_instance.mesh_to_world = mesh_instance.trs.to_transform(mesh_instance.parent->mesh_to_world);
             else
-                mesh_instance.mesh_to_world = mesh_instance.trs.to_mat();
+                mesh_instance.mesh_to_world = mesh_instance.trs.to_transform(model_instance.model_to_world);
         }
+
+        model_instance.skeleton_instances.reserve(model.skeletons.size());
+        for (auto i = 0; i < model.skeletons.size(); ++i)
+        {
+            const auto& skeleton = model.skeletons[i];
+            if (m_joint_palette.size() + skeleton.get_joint_count() > MAX_JOINT_PALETTE_MATRICES)
+            {
+                m_logger->warn("Joint palette is full, skeleton '{}' is not animated.", skeleton.name);
+                break;
+            }
+            const auto clip = std::ranges::find(model.animation_clips, static_cast<uint32_t>(i), &Animation_Clip::skeleton_index);
+            auto& skeleton_instance = model_instance.skeleton_instances.emplace_back( Skeleton_Instance {
+                .skeleton = &skeleton,
+                .clip = clip != model.animation_clips.end() ? &*clip : nullptr,
+                .time = 0.f,
+                .palette_offset = static_cast<uint32_t>(m_joint_palette.size())
+            });
+            m_joint_palette.resize(m_joint_palette.size() + skeleton.get_joint_count());
+            m_skeleton_instances.push_back(&skeleton_instance);
+            for (const auto mesh_index : skeleton.skinned_mesh_indices)
+            {
+                if (mesh_index < model_instance.mesh_instances.size())
+                    model_instance.mesh_instances[mesh_index].skeleton_instance = &skeleton_instance;
+            }
+        }
+        create_skinned_instance_data(model_instance, model_descriptor.name);
+
+        std::vector<GPU_Instance_Transform_Data> instance_transforms;
+        std::vector<uint32_t> transform_indices;
+        std::vector<GPU_Instance_Indices> instance_indices;
+        std::vector<uint32_t> instance_index_indices;
+        instance_transforms.reserve(model_instance.mesh_instances.size());
+        transform_indices.reserve(model_instance.mesh_instances.size());
         for (const auto& mesh_instance : model_instance.mesh_instances)
         {
-            GPU_Instance_Transform_Data instance_transform_data = {
+            instance_transforms.push_back({
                 .mesh_to_world = mesh_instance.mesh_to_world,
                 .normal_to_world = mesh_instance.trs.adjugate(
                     mesh_instance.parent != nullptr
                     ? mesh_instance.parent->mesh_to_world
-                    : glm::identity<glm::mat4>())
-            };
-            m_gpu_transfer_context.enqueue_immediate_upload(
-                m_transform_buffer,
-                &instance_transform_data,
-                sizeof(GPU_Instance_Transform_Data),
-                mesh_instance.transform_index * sizeof(GPU_Instance_Transform_Data));
+                    : model_instance.model_to_world)
+            });
+            transform_indices.push_back(mesh_instance.transform_index);
             for (const auto& submesh_instance : mesh_instance.submesh_instances)
             {
-                GPU_Instance_Indices instance_indices = {
+                instance_indices.push_back({
                     .transform_index = mesh_instance.transform_index,
                     .material_index = submesh_instance.material->material_index
-                };
-                m_gpu_transfer_context.enqueue_immediate_upload(
-                    m_instance_buffer,
-                    &instance_indices,
-                    sizeof(instance_indices),
-                    submesh_instance.instance_index * sizeof(GPU_Instance_Indices));
+                });
+                instance_index_indices.push_back(submesh_instance.instance_index);
             }
         }
+        m_gpu_transfer_context.enqueue_scatter_upload<GPU_Instance_Transform_Data>(
+            m_transform_buffer, instance_transforms, transform_indices);
+        m_gpu_transfer_context.enqueue_scatter_upload<GPU_Instance_Indices>(
+            m_instance_buffer, instance_indices, instance_index_indices);
     }
 }
 
@@ -425,7 +758,9 @@ void Static_Scene_Data::update_tlas()
                     .flags = static_cast<uint32_t>(
                         rhi::Acceleration_Structure_Instance_Flags::Triangle_Cull_Disable |
                         rhi::Acceleration_Structure_Instance_Flags::Triangle_Front_CCW),
-                    .acceleration_structure_gpu_address = submesh_instance.submesh->blas->address
+                    .acceleration_structure_gpu_address = submesh_instance.blas != nullptr
+                        ? submesh_instance.blas->address
+                        : submesh_instance.submesh->blas->address
                 };
                 glm::mat3x4 transform = glm::mat3x4(glm::transpose(mesh_instance.mesh_to_world));
                 memcpy_s(&tlas_instance, sizeof(glm::mat3x4), &transform, sizeof(glm::mat3x4));
@@ -457,6 +792,50 @@ void Static_Scene_Data::update_tlas()
     ping_pong = (ping_pong + 1) % REN_MAX_FRAMES_IN_FLIGHT;
 }
 
+void Static_Scene_Data::update_animations(float dt, enki::TaskScheduler& task_scheduler)
+{
+    if (m_skeleton_instances.empty())
+    {
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto time_step = m_animation_paused ? 0.f : dt * m_animation_playback_speed;
+    enki::TaskSet evaluate_task(
+        static_cast<uint32_t>(m_skeleton_instances.size()),
+        [&](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            for (auto i = range.start; i < range.end; ++i)
+            {
+                auto& skeleton_instance = *m_skeleton_instances[i];
+                if (skeleton_instance.clip && skeleton_instance.clip->duration > 0.f)
+                {
+                    skeleton_instance.time = std::fmod(skeleton_instance.time + time_step, skeleton_instance.clip->duration);
+                }
+                evaluate_joint_palette(
+                    *skeleton_instance.skeleton,
+                    skeleton_instance.clip,
+                    skeleton_instance.time,
+                    &m_joint_palette[skeleton_instance.palette_offset]);
+            }
+        });
+    task_scheduler.AddTaskSetToPipe(&evaluate_task);
+    task_scheduler.WaitforTask(&evaluate_task);
+    m_animation_cpu_time_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    m_gpu_transfer_context.enqueue_immediate_upload(
+        m_joint_palette_buffer,
+        m_joint_palette.data(),
+        m_joint_palette.size() * sizeof(glm::mat4),
+        0);
+
+    // The skinned positions change every frame, so the BLAS are rebuilt after the skinning pass.
+    for (const auto& blas_request : m_skinned_blas_build_requests)
+    {
+        m_acceleration_structure_builder.add_blas_build_request(blas_request);
+    }
+}
+
 void Static_Scene_Data::gui()
 {
     ImGui::SeparatorText("Sun");
@@ -474,6 +853,55 @@ void Static_Scene_Data::gui()
         ImGui::Text("Direction: %.3f, %.3f, %.3f", m_sun_direction.x, m_sun_direction.y, m_sun_direction.z);
         ImGui::SliderFloat("Illuminance (lx)", &m_sun_intensity, 0.f, 100000.f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
     }
+    ImGui::SeparatorText("Animation");
+    {
+        ImGui::Checkbox("Paused", &m_animation_paused);
+        ImGui::SliderFloat("Playback speed", &m_animation_playback_speed, 0.f, 4.f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        ImGui::Text("Skinned instances: %zu", m_skeleton_instances.size());
+        ImGui::Text("Joints: %zu / %d", m_joint_palette.size(), MAX_JOINT_PALETTE_MATRICES);
+        ImGui::Text("Skinned BLAS rebuilds: %zu", m_skinned_blas_build_requests.size());
+        ImGui::Text("CPU evaluation: %.3f ms", m_animation_cpu_time_ms);
+    }
+    ImGui::SeparatorText("Loading");
+    {
+        const auto progress = get_load_progress();
+        ImGui::SliderFloat("Integration budget (ms)", &m_load_budget_ms, 0.25f, 16.f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        ImGui::Text("Pending models: %u", progress.pending_models);
+        ImGui::Text("Pending textures: %u", progress.pending_textures);
+        ImGui::Text("Pending data: %.1f MiB", static_cast<double>(progress.pending_bytes) / MIB);
+    }
+    ImGui::SeparatorText("Memory");
+    {
+        auto mapped_file_budget_mib = static_cast<int32_t>(m_asset_repository.get_mapped_file_budget() / MIB);
+        if (ImGui::SliderInt("Mapped file budget (MiB)", &mapped_file_budget_mib, 64, 16384, "%d", ImGuiSliderFlags_AlwaysClamp))
+        {
+            m_asset_repository.set_mapped_file_budget(static_cast<std::size_t>(mapped_file_budget_mib) * MIB);
+        }
+        ImGui::SliderInt("GPU budget (MiB)", &m_gpu_budget_mib, 256, 32768, "%d", ImGuiSliderFlags_AlwaysClamp);
+        const auto print_usage = [](const char* name, const Memory_Usage& usage)
+        {
+            ImGui::Text("%s: %u, %.1f MiB", name, usage.count, static_cast<double>(usage.bytes) / MIB);
+        };
+        print_usage("Mapped files", m_asset_repository.get_mapped_file_usage());
+        print_usage("Images", m_image_usage);
+        print_usage("Buffers", m_buffer_usage);
+        const auto staging = m_gpu_transfer_context.get_statistics();
+        ImGui::Text("Staging ring: %.1f / %.1f MiB",
+            static_cast<double>(staging.ring_used) / MIB, static_cast<double>(staging.ring_size) / MIB);
+        print_usage("Staging ring allocations", staging.ring_allocations);
+        print_usage("Dedicated staging allocations", staging.dedicated_allocations);
+        print_usage("Dedicated staging buffers", staging.dedicated_buffers);
+        ImGui::Text("Coalesced writes: %u, copies: %u, scattered words: %u",
+            staging.coalesced_writes, staging.buffer_copies, staging.scatter_words);
+        auto upload_budget_mib = static_cast<int32_t>(m_gpu_transfer_context.get_frame_upload_budget() / MIB);
+        if (ImGui::SliderInt("Upload budget (MiB per frame)", &upload_budget_mib, 1, 512, "%d", ImGuiSliderFlags_AlwaysClamp))
+        {
+            m_gpu_transfer_context.set_frame_upload_budget(static_cast<std::size_t>(upload_budget_mib) * MIB);
+        }
+        ImGui::Text("Staged: %.1f MiB", static_cast<double>(staging.staged_bytes) / MIB);
+        print_usage("Deferred uploads", staging.deferred_uploads);
+        print_usage("Transient allocations", staging.transient_allocations);
+    }
 }
 
 uint32_t Static_Scene_Data::acquire_instance_index()
@@ -497,40 +925,460 @@ uint32_t Static_Scene_Data::acquire_transform_index()
     return val;
 }
 
-rhi::Image* Static_Scene_Data::get_or_create_image(const std::string& uri, rhi::Image* replacement)
+void Static_Scene_Data::update_texture_streaming(const Fly_Camera& camera)
+{
+    m_streaming_frame += 1;
+    std::erase_if(m_retired_images, [&](const Retired_Image& retired)
+    {
+        if (retired.frame + REN_MAX_FRAMES_IN_FLIGHT > m_streaming_frame)
+        {
+            return false;
+        }
+        m_graphics_device->destroy_image(retired.image);
+        return true;
+    });
+    apply_finished_texture_uploads();
+
+    // Texture coordinate distance per pixel where each material is closest to the camera.
+    ankerl::unordered_dense::map<const Material*, float> material_demand;
+    const auto pixels_per_unit_at_unit_distance = camera.height / (2.f * glm::tan(glm::radians(camera.fov_y) * .5f));
+    for (const auto& model_instance : m_model_Instances)
+    {
+        for (const auto& mesh_instance : model_instance.mesh_instances)
+        {
+            const auto scale = glm::max(glm::max(
+                glm::length(glm::vec3(mesh_instance.mesh_to_world[0])),
+                glm::length(glm::vec3(mesh_instance.mesh_to_world[1]))),
+                glm::length(glm::vec3(mesh_instance.mesh_to_world[2])));
+            for (const auto& submesh_instance : mesh_instance.submesh_instances)
+            {
+                const auto& submesh = *submesh_instance.submesh;
+                const auto center = glm::vec3(mesh_instance.mesh_to_world * glm::vec4((submesh.aabb_min + submesh.aabb_max) * .5f, 1.f));
+                const auto radius = glm::length(submesh.aabb_max - submesh.aabb_min) * .5f * scale;
+                const auto distance = glm::max(glm::length(center - camera.position) - radius, camera.near_plane);
+                // Without a density estimate the full resolution is demanded.
+                const auto uv_per_pixel = scale > 0.f
+                    ? submesh.uv_density / scale * distance / pixels_per_unit_at_unit_distance
+                    : 0.f;
+                const auto [it, is_new] = material_demand.try_emplace(submesh_instance.material, uv_per_pixel);
+                if (!is_new)
+                {
+                    it->second = glm::min(it->second, uv_per_pixel);
+                }
+            }
+        }
+    }
+
+    std::vector<std::pair<const std::string*, Streamed_Texture*>> requests;
+    for (auto& [uri, texture] : m_textures)
+    {
+        texture.demanded_mip = texture.tail_mip;
+        for (const auto& binding : texture.bindings)
+        {
+            if (const auto it = material_demand.find(binding.material); it != material_demand.end())
+            {
+                const auto mip = static_cast<uint32_t>(glm::log2(glm::max(static_cast<float>(texture.size) * it->second, 1.f)));
+                texture.demanded_mip = glm::min(texture.demanded_mip, mip);
+                texture.last_demand_frame = m_streaming_frame;
+            }
+        }
+        if (texture.demanded_mip < texture.requested_mip)
+        {
+            requests.emplace_back(&uri, &texture);
+        }
+    }
+
+    // The textures that are the furthest from their demanded detail are streamed first.
+    std::ranges::sort(requests, std::greater(), [](const auto& request)
+    {
+        return request.second->requested_mip - request.second->demanded_mip;
+    });
+    for (const auto& [uri, texture] : requests)
+    {
+        if (m_texture_loads.size() >= MAX_TEXTURE_LOADS_IN_FLIGHT)
+        {
+            break;
+        }
+        request_texture_mips(*uri, *texture, texture->demanded_mip);
+    }
+}
+
+void Static_Scene_Data::integrate_texture(const Texture_Load& load)
 {
-    if (m_images.contains(uri))
+    if (const auto it = m_textures.find(load.uri); it != m_textures.end())
     {
-        return m_images[uri];
+        auto& texture = it->second;
+        if (load.first_mip < texture.resident_mip)
+        {
+            set_resident_mip(texture, *load.file, load.first_mip, Upload_Priority::Streaming);
+        }
+        if (texture.requested_mip != texture.resident_mip)
+        {
+            m_image_usage.bytes -= texture.mip_chain_sizes[texture.requested_mip] - texture.mip_chain_sizes[texture.resident_mip];
+            texture.requested_mip = texture.resident_mip;
+        }
+        return;
     }
 
-    const auto texture_file = m_asset_repository.get_texture_safe(uri);
-    if (!texture_file)
-        return replacement;
+    const auto bindings = std::move(m_texture_bindings[load.uri]);
+    m_texture_bindings.erase(load.uri);
+    if (!load.is_valid)
+    {
+        m_logger->error("Failed to validate texture '{}'", load.uri);
+        return;
+    }
 
-    m_logger->info("Loading texture {}", uri);
-    auto loadable_image = static_cast<serialization::Image_Data_00*>(texture_file->data);
+    m_logger->info("Loading texture {}", load.uri);
+    auto* loadable_image = static_cast<serialization::Image_Data_00*>(load.file->data);
+    auto& texture = m_textures[load.uri] = {
+        .image = nullptr,
+        .pending_image = nullptr,
+        .pending_upload = 0,
+        .pending_file = nullptr,
+        .size = std::max(loadable_image->mips[0].width, loadable_image->mips[0].height),
+        .tail_mip = load.first_mip,
+        .resident_mip = load.first_mip,
+        .requested_mip = load.first_mip,
+        .demanded_mip = load.first_mip,
+        .last_demand_frame = m_streaming_frame,
+        .mip_chain_sizes = {},
+        .bindings = bindings
+    };
+    for (auto mip = 0u; mip < loadable_image->mip_count; ++mip)
+    {
+        texture.mip_chain_sizes.push_back(get_mip_chain_size(*loadable_image, mip));
+    }
+    if (!set_resident_mip(texture, *load.file, load.first_mip, Upload_Priority::Texture))
+    {
+        m_logger->error("Failed to create texture '{}'", load.uri);
+        m_textures.erase(load.uri);
+        return;
+    }
+    m_image_usage.add(texture.mip_chain_sizes[load.first_mip]);
+}
+
+void Static_Scene_Data::request_texture(const std::string& uri, Mapped_File& texture_file,
+    const Texture_Binding& binding)
+{
+    auto [it, is_new] = m_texture_bindings.try_emplace(uri);
+    it->second.push_back(binding);
+    if (!is_new)
+    {
+        return;
+    }
+    m_asset_repository.pin_file(&texture_file);
+    auto& load = *m_texture_loads.emplace_back(std::make_unique<Texture_Load>(Texture_Load {
+        .uri = uri,
+        .file = &texture_file,
+        .first_mip = Texture_Load::TAIL_MIP
+    }));
+    load.task = std::make_unique<enki::TaskSet>(1,
+        [load = &load](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            load->is_valid = validate_texture(*load->file);
+            if (!load->is_valid)
+            {
+                return;
+            }
+            auto* loadable_image = static_cast<serialization::Image_Data_00*>(load->file->data);
+            load->first_mip = get_tail_mip(*loadable_image);
+            load->file->populate(loadable_image->get_mip_data(load->first_mip) - static_cast<char*>(load->file->data));
+        });
+    m_task_scheduler.AddTaskSetToPipe(load.task.get());
+}
+
+void Static_Scene_Data::request_texture_mips(const std::string& uri, Streamed_Texture& texture, const uint32_t mip)
+{
+    const auto size = texture.mip_chain_sizes[mip] - texture.mip_chain_sizes[texture.requested_mip];
+    if (!evict_texture_mips(size, &texture))
+    {
+        return;
+    }
+    m_image_usage.bytes += size;
+    texture.requested_mip = mip;
+
+    // The texture was validated by its first load.
+    auto* texture_file = m_asset_repository.get_texture(uri);
+    m_asset_repository.pin_file(texture_file);
+    auto& load = *m_texture_loads.emplace_back(std::make_unique<Texture_Load>(Texture_Load {
+        .uri = uri,
+        .file = texture_file,
+        .first_mip = mip,
+        .is_valid = texture_file->data != nullptr
+    }));
+    load.task = std::make_unique<enki::TaskSet>(1,
+        [load = &load](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            if (!load->is_valid)
+            {
+                return;
+            }
+            auto* loadable_image = static_cast<serialization::Image_Data_00*>(load->file->data);
+            load->file->populate(loadable_image->get_mip_data(load->first_mip) - static_cast<char*>(load->file->data));
+        });
+    m_task_scheduler.AddTaskSetToPipe(load.task.get());
+}
+
+bool Static_Scene_Data::evict_texture_mips(const std::size_t size, const Streamed_Texture* requesting_texture)
+{
+    // Buffers are not evicted, textures get what they leave of the budget.
+    const auto budget = static_cast<std::size_t>(m_gpu_budget_mib) * MIB;
+    while (m_buffer_usage.bytes + m_image_usage.bytes + size > budget)
+    {
+        // The least recently demanded texture that has more detail than it needs loses its top mips.
+        std::pair<const std::string*, Streamed_Texture*> victim = {};
+        for (auto& [uri, texture] : m_textures)
+        {
+            if (&texture == requesting_texture
+                || texture.pending_image
+                || texture.requested_mip != texture.resident_mip
+                || texture.resident_mip >= texture.demanded_mip)
+            {
+                continue;
+            }
+            if (!victim.second || texture.last_demand_frame < victim.second->last_demand_frame)
+            {
+                victim = { &uri, &texture };
+            }
+        }
+        auto* texture = victim.second;
+        if (!texture || texture->last_demand_frame >= m_streaming_frame)
+        {
+            return false;
+        }
+        auto* texture_file = m_asset_repository.get_texture(*victim.first);
+        if (!texture_file->data)
+        {
+            return false;
+        }
+        const auto resident_mip = texture->resident_mip;
+        if (!set_resident_mip(*texture, *texture_file, texture->demanded_mip, Upload_Priority::Streaming))
+        {
+            return false;
+        }
+        m_image_usage.bytes -= texture->mip_chain_sizes[resident_mip] - texture->mip_chain_sizes[texture->resident_mip];
+        texture->requested_mip = texture->resident_mip;
+    }
+    return true;
+}
+
+bool Static_Scene_Data::set_resident_mip(Streamed_Texture& texture, Mapped_File& texture_file, const uint32_t mip,
+    const Upload_Priority priority)
+{
+    // The pending image may still be copied, it is not replaced.
+    if (texture.pending_image)
+    {
+        return false;
+    }
+    texture.pending_image = create_image(texture_file, mip, texture.pending_upload, priority);
+    if (!texture.pending_image)
+    {
+        return false;
+    }
+    // The upload is deferred, it reads the file when it is staged.
+    m_asset_repository.pin_file(&texture_file);
+    texture.pending_file = &texture_file;
+    texture.resident_mip = mip;
+    return true;
+}
+
+void Static_Scene_Data::apply_finished_texture_uploads()
+{
+    for (auto& texture : m_textures | std::views::values)
+    {
+        if (!texture.pending_image || !m_gpu_transfer_context.is_upload_complete(texture.pending_upload))
+        {
+            continue;
+        }
+        if (texture.image)
+        {
+            m_retired_images.push_back({ .image = texture.image, .frame = m_streaming_frame });
+        }
+        texture.image = texture.pending_image;
+        texture.pending_image = nullptr;
+        m_asset_repository.unpin_file(texture.pending_file);
+        texture.pending_file = nullptr;
+        for (const auto& binding : texture.bindings)
+        {
+            binding.material->*binding.image = texture.image;
+            upload_material(*binding.material);
+        }
+    }
+}
+
+rhi::Image* Static_Scene_Data::create_image(const Mapped_File& texture_file, const uint32_t first_mip, uint64_t& upload,
+    const Upload_Priority priority)
+{
+    auto loadable_image = static_cast<serialization::Image_Data_00*>(texture_file.data);
     rhi::Image_Create_Info texture_create_info = {
         .format = loadable_image->format,
-        .width = loadable_image->mips[0].width,
-        .height = loadable_image->mips[0].height,
+        .width = loadable_image->mips[first_mip].width,
+        .height = loadable_image->mips[first_mip].height,
         .depth = 1,
         .array_size = 1,
-        .mip_levels = static_cast<uint16_t>(loadable_image->mip_count),
+        .mip_levels = static_cast<uint16_t>(loadable_image->mip_count - first_mip),
         .usage = rhi::Image_Usage::Sampled,
         .primary_view_type = rhi::Image_View_Type::Texture_2D
     };
     auto image = m_graphics_device->create_image(texture_create_info).value_or(nullptr);
+    if (!image)
+    {
+        return nullptr;
+    }
     m_graphics_device->name_resource(image, (std::string("gltf:") + loadable_image->name).c_str());
-    std::array<void*, 14> mip_data{};
-    for (auto mip = 0; mip < loadable_image->mip_count; ++mip)
+    std::vector<Image_Upload_Region> regions;
+    for (auto mip = first_mip; mip < loadable_image->mip_count; ++mip)
     {
-        mip_data[mip] = loadable_image->get_mip_data(mip);
+        regions.push_back({ .data = loadable_image->get_mip_data(mip), .mip_level = mip - first_mip });
     }
-    m_gpu_transfer_context.enqueue_immediate_upload(image, mip_data.data());
-    m_images[uri] = image;
+    upload = m_gpu_transfer_context.enqueue_async_upload(image, regions, priority);
+    return image;
+}
 
-    return m_images[uri];
+void Static_Scene_Data::track_buffer(const rhi::Buffer* buffer)
+{
+    if (buffer)
+    {
+        m_buffer_usage.add(buffer->size);
+    }
+}
+
+void Static_Scene_Data::upload_material(const Material& material)
+{
+    auto get_image_index = [&](const rhi::Image* image)
+    {
+        if (!image) return ~0u;
+        return image->image_view->bindless_index;
+    };
+
+    GPU_Material gpu_material = {
+        .base_color_factor = glm::packUint4x8(material.base_color_factor),
+        .pbr_roughness = material.pbr_roughness,
+        .pbr_metallic = material.pbr_metallic,
+        .emissive_color = material.emissive_color,
+        .emissive_strength = material.emissive_strength,
+        .albedo = get_image_index(material.albedo),
+        .normal = get_image_index(material.normal),
+        .metallic_roughness = get_image_index(material.metallic_roughness),
+        .emissive = get_image_index(material.emissive),
+        .sampler_id = material.sampler->bindless_index
+    };
+
+    m_gpu_transfer_context.enqueue_immediate_upload(
+        m_material_buffer,
+        &gpu_material,
+        sizeof(GPU_Material),
+        material.material_index * sizeof(GPU_Material));
+}
+
+void Static_Scene_Data::create_skinned_instance_data(Model_Instance& model_instance, const std::string& name)
+{
+    const auto& model = *model_instance.model;
+    model_instance.skinned_vertex_positions = nullptr;
+    model_instance.skinned_blas_allocation = nullptr;
+
+    std::vector<Submesh_Instance*> skinned_submesh_instances;
+    for (auto& mesh_instance : model_instance.mesh_instances)
+    {
+        if (!mesh_instance.skeleton_instance)
+            continue;
+        for (auto& submesh_instance : mesh_instance.submesh_instances)
+        {
+            if (submesh_instance.submesh->is_skinned)
+                skinned_submesh_instances.push_back(&submesh_instance);
+        }
+    }
+    if (skinned_submesh_instances.empty())
+    {
+        return;
+    }
+
+    rhi::Buffer_Create_Info buffer_create_info = {
+        .size = model.vertex_positions->size,
+        .heap = rhi::Memory_Heap_Type::GPU
+    };
+    model_instance.skinned_vertex_positions = m_graphics_device->create_buffer(buffer_create_info).value_or(nullptr);
+    track_buffer(model_instance.skinned_vertex_positions);
+    m_graphics_device->name_resource(model_instance.skinned_vertex_positions, (std::string("gltf:") + name + ":skinned_position").c_str());
+
+    uint64_t acceleration_structure_buffer_size = 0;
+    struct Acceleration_Structure_Info
+    {
+        rhi::Acceleration_Structure_Build_Sizes build_sizes;
+        Submesh_Instance* submesh_instance;
+        uint64_t buffer_offset;
+        rhi::Acceleration_Structure_Geometry_Data geometry;
+    };
+    std::vector<Acceleration_Structure_Info> blas_infos = {};
+    blas_infos.reserve(skinned_submesh_instances.size());
+    for (auto* submesh_instance : skinned_submesh_instances)
+    {
+        const auto& submesh = *submesh_instance->submesh;
+        auto& blas_info = blas_infos.emplace_back();
+        blas_info.geometry = {
+            .type = rhi::Acceleration_Structure_Geometry_Type::Triangles,
+            .flags = submesh.material->alpha_mode == Material_Alpha_Mode::Opaque
+                ? rhi::Acceleration_Structure_Geometry_Flags::Opaque
+                : rhi::Acceleration_Structure_Geometry_Flags::None,
+            .geometry = {
+                .triangles = {
+                    .transform_gpu_address = 0ull,
+                    .vertex_gpu_address = model_instance.skinned_vertex_positions->gpu_address + sizeof(glm::vec3) * submesh.first_vertex,
+                    .index_gpu_address = m_global_index_buffer->gpu_address + sizeof(uint32_t) * (submesh.first_index + model.index_buffer_allocation.offset),
+                    .vertex_format = rhi::Image_Format::R32G32B32_SFLOAT,
+                    .vertex_count = submesh.vertex_count,
+                    .vertex_stride = 12,
+                    .index_count = submesh.index_count,
+                    .index_type = rhi::Index_Type::U32
+                }
+            }
+        };
+        rhi::Acceleration_Structure_Build_Geometry_Info blas_build_geometry_info = {
+            .type = rhi::Acceleration_Structure_Type::Bottom_Level,
+            .flags = rhi::Acceleration_Structure_Flags::Fast_Build,
+            .geometry_or_instance_count = 1,
+            .src = nullptr,
+            .dst = nullptr,
+            .geometry = &blas_info.geometry
+        };
+        blas_info.build_sizes = m_graphics_device->get_acceleration_structure_build_sizes(blas_build_geometry_info);
+        blas_info.submesh_instance = submesh_instance;
+        blas_info.buffer_offset = acceleration_structure_buffer_size;
+
+        acceleration_structure_buffer_size += pow2_align(blas_info.build_sizes.acceleration_structure_size, 256);
+    }
+
+    rhi::Buffer_Create_Info blas_buffer_create_info = {
+        .size = acceleration_structure_buffer_size,
+        .heap = rhi::Memory_Heap_Type::GPU,
+        .acceleration_structure_memory = true
+    };
+    model_instance.skinned_blas_allocation = m_graphics_device->create_buffer(blas_buffer_create_info).value_or(nullptr);
+    track_buffer(model_instance.skinned_blas_allocation);
+    m_graphics_device->name_resource(model_instance.skinned_blas_allocation, (std::string("gltf:") + name + ":skinned_blas_allocation").c_str());
+
+    for (auto& blas_info : blas_infos)
+    {
+        rhi::Acceleration_Structure_Create_Info blas_create_info = {
+            .buffer = model_instance.skinned_blas_allocation,
+            .offset = blas_info.buffer_offset,
+            .size = blas_info.build_sizes.acceleration_structure_size,
+            .type = rhi::Acceleration_Structure_Type::Bottom_Level
+        };
+        auto blas = m_graphics_device->create_acceleration_structure(blas_create_info);
+        if (!blas.has_value())
+        {
+            m_logger->warn("Skinned BLAS creation error, falling back to the rest pose BLAS.");
+            continue;
+        }
+        blas_info.submesh_instance->blas = blas.value();
+        m_skinned_blas_build_requests.push_back( BLAS_Build_Request {
+            .acceleration_structure = blas.value(),
+            .build_sizes = blas_info.build_sizes,
+            .flags = rhi::Acceleration_Structure_Flags::Fast_Build,
+            .geometry_data = blas_info.geometry
+        });
+    }
 }
 
 void Static_Scene_Data::create_default_images()
@@ -593,13 +1441,15 @@ Static_Scene_Data::Static_Scene_Data(
     GPU_Transfer_Context& gpu_transfer_context,
     Asset_Repository& asset_repository,
     Render_Resource_Blackboard& render_resource_blackboard,
-    Acceleration_Structure_Builder& acceleration_structure_builder)
+    Acceleration_Structure_Builder& acceleration_structure_builder,
+    enki::TaskScheduler& task_scheduler)
     : m_graphics_device(graphics_device)
     , m_logger(std::move(logger))
     , m_gpu_transfer_context(gpu_transfer_context)
     , m_asset_repository(asset_repository)
     , m_render_resource_blackboard(render_resource_blackboard)
     , m_acceleration_structure_builder(acceleration_structure_builder)
+    , m_task_scheduler(task_scheduler)
     , m_index_buffer_allocator(MAX_INDICES)
 {
     m_instance_freelist.resize(MAX_INSTANCES);
@@ -617,21 +1467,27 @@ Static_Scene_Data::Static_Scene_Data(
         .heap = rhi::Memory_Heap_Type::GPU
     };
     m_global_index_buffer = graphics_device->create_buffer(buffer_create_info, REN_GLOBAL_INDEX_BUFFER).value_or(nullptr);
+    track_buffer(m_global_index_buffer);
     m_graphics_device->name_resource(m_global_index_buffer, "scene:global_index_buffer");
     buffer_create_info.size = INSTANCE_TRANSFORM_BUFFER_SIZE;
     m_transform_buffer = graphics_device->create_buffer(buffer_create_info, REN_GLOBAL_INSTANCE_TRANSFORM_BUFFER).value_or(nullptr);
+    track_buffer(m_transform_buffer);
     m_graphics_device->name_resource(m_transform_buffer, "scene:instance_transform_buffer");
     buffer_create_info.size = MATERIAL_INSTANCE_BUFFER_SIZE;
     m_material_buffer = graphics_device->create_buffer(buffer_create_info, REN_GLOBAL_MATERIAL_INSTANCE_BUFFER).value_or(nullptr);
+    track_buffer(m_material_buffer);
     m_graphics_device->name_resource(m_material_buffer, "scene:material_instance_buffer");
     buffer_create_info.size = INSTANCE_INDICES_BUFFER_SIZE;
     m_instance_buffer = graphics_device->create_buffer(buffer_create_info, REN_GLOBAL_INSTANCE_INDICES_BUFFER).value_or(nullptr);
+    track_buffer(m_instance_buffer);
     m_graphics_device->name_resource(m_instance_buffer, "scene:instance_indices_buffer");
     buffer_create_info.size = LIGHT_BUFFER_SIZE;
     m_light_buffer = graphics_device->create_buffer(buffer_create_info, REN_GLOBAL_LIGHT_LIST_BUFFER).value_or(nullptr);
+    track_buffer(m_light_buffer);
     m_graphics_device->name_resource(m_light_buffer, "scene:light_list_buffer");
     buffer_create_info.size = sizeof(Scene_Info);
     m_scene_info_buffer = graphics_device->create_buffer(buffer_create_info, REN_GLOBAL_SCENE_INFORMATION_BUFFER).value_or(nullptr);
+    track_buffer(m_scene_info_buffer);
     graphics_device->name_resource(m_scene_info_buffer, "scene:scene_info_buffer");
 
     create_default_images();
@@ -655,6 +1511,7 @@ Static_Scene_Data::Static_Scene_Data(
     buffer_create_info.acceleration_structure_memory = true;
     buffer_create_info.size = 1 << 22;
     m_tlas_buffer = m_graphics_device->create_buffer(buffer_create_info).value_or(nullptr);
+    track_buffer(m_tlas_buffer);
 
     rhi::Acceleration_Structure_Create_Info tlas_create_info = {
         .buffer = m_tlas_buffer,
@@ -672,10 +1529,25 @@ Static_Scene_Data::Static_Scene_Data(
     {
         tlas_instance_buffer = m_graphics_device->create_buffer(buffer_create_info).value_or(nullptr);
     }
+
+    buffer_create_info.size = JOINT_PALETTE_BUFFER_SIZE;
+    buffer_create_info.heap = rhi::Memory_Heap_Type::GPU;
+    m_joint_palette_buffer = m_graphics_device->create_buffer(buffer_create_info).value_or(nullptr);
+    track_buffer(m_joint_palette_buffer);
+    m_graphics_device->name_resource(m_joint_palette_buffer, "scene:joint_palette_buffer");
+    m_joint_palette.reserve(MAX_JOINT_PALETTE_MATRICES);
 }
 
 Static_Scene_Data::~Static_Scene_Data()
 {
+    for (const auto& load : m_model_loads)
+    {
+        m_task_scheduler.WaitforTask(load->task.get());
+    }
+    for (const auto& load : m_texture_loads)
+    {
+        m_task_scheduler.WaitforTask(load->task.get());
+    }
     m_graphics_device->wait_idle();
     m_graphics_device->destroy_acceleration_structure(m_tlas);
     m_graphics_device->destroy_buffer(m_global_index_buffer);
@@ -687,6 +1559,7 @@ Static_Scene_Data::~Static_Scene_Data()
     for (auto& buffer : m_tlas_instance_buffers)
         m_graphics_device->destroy_buffer(buffer);
     m_graphics_device->destroy_buffer(m_tlas_buffer);
+    m_graphics_device->destroy_buffer(m_joint_palette_buffer);
     m_graphics_device->destroy_image(m_default_albedo_tex);
     m_graphics_device->destroy_image(m_default_normal_tex);
     m_graphics_device->destroy_image(m_default_metallic_roughness_tex);
@@ -695,15 +1568,42 @@ Static_Scene_Data::~Static_Scene_Data()
     {
         m_graphics_device->destroy_buffer(model.vertex_positions);
         m_graphics_device->destroy_buffer(model.vertex_attributes);
+        if (model.vertex_skin_attributes)
+            m_graphics_device->destroy_buffer(model.vertex_skin_attributes);
         for (const auto& submesh : model.submeshes)
         {
             m_graphics_device->destroy_acceleration_structure(submesh.blas);
         }
-        m_graphics_device->destroy_buffer(model.blas_allocation);
+        if (model.blas_allocation)
+            m_graphics_device->destroy_buffer(model.blas_allocation);
+        if (model.animation_file)
+            m_asset_repository.unpin_file(model.animation_file);
+    }
+    for (const auto& model_instance : m_model_Instances)
+    {
+        if (!model_instance.skinned_vertex_positions)
+            continue;
+        for (const auto& mesh_instance : model_instance.mesh_instances)
+        {
+            for (const auto& submesh_instance : mesh_instance.submesh_instances)
+            {
+                if (submesh_instance.blas)
+                    m_graphics_device->destroy_acceleration_structure(submesh_instance.blas);
+            }
+        }
+        m_graphics_device->destroy_buffer(model_instance.skinned_vertex_positions);
+        m_graphics_device->destroy_buffer(model_instance.skinned_blas_allocation);
+    }
+    for (const auto& texture : m_textures | std::views::values)
+    {
+        if (texture.image)
+            m_graphics_device->destroy_image(texture.image);
+        if (texture.pending_image)
+            m_graphics_device->destroy_image(texture.pending_image);
     }
-    for (const auto image : m_images | std::views::values)
+    for (const auto& retired : m_retired_images)
     {
-        m_graphics_device->destroy_image(image);
+        m_graphics_device->destroy_image(retired.image);
     }
 }
 }
@@ -11,20 +11,32 @@
 
 #include "ankerl/unordered_dense.h"
 #include "glm/ext/matrix_transform.hpp"
+#include "renderer/acceleration_structure_builder.hpp"
 #include "renderer/logger.hpp"
+#include "renderer/memory_usage.hpp"
+#include "renderer/scene/animation.hpp"
 
 #include <array>
+#include <deque>
+#include <memory>
 
 namespace rhi
 {
 class Graphics_Device;
 }
 
+namespace enki
+{
+class TaskScheduler;
+}
+
 namespace ren
 {
 class Asset_Repository;
+struct Fly_Camera;
 class GPU_Transfer_Context;
-class Acceleration_Structure_Builder;
+enum class Upload_Priority;
+struct Mapped_File;
 
 enum class Material_Alpha_Mode
 {
@@ -66,8 +78,12 @@ struct Submesh
     uint32_t first_index;
     uint32_t index_count;
     uint32_t first_vertex;
+    uint32_t vertex_count;
+    uint32_t first_skin_attribute;
+    bool is_skinned;
     glm::vec3 aabb_min;
     glm::vec3 aabb_max;
+    float uv_density; // Texture coordinate distance per unit of surface distance, 0 if unknown
     Material* material;
     rhi::Acceleration_Structure* blas;
 };
@@ -77,6 +93,15 @@ struct Submesh_Instance
     Submesh* submesh;
     Material* material;
     uint32_t instance_index; // Points to both transform and material
+    rhi::Acceleration_Structure* blas; // Per instance BLAS over the skinned positions, nullptr if not skinned
+};
+
+struct Skeleton_Instance
+{
+    const Skeleton* skeleton;
+    const Animation_Clip* clip; // nullptr keeps the rest pose
+    float time;
+    uint32_t palette_offset; // First matrix of the instance in the joint palette buffer
 };
 
 struct Mesh
@@ -93,6 +118,7 @@ struct Mesh_Instance
     uint32_t transform_index;
     TRS trs;
     glm::mat4 mesh_to_world;
+    Skeleton_Instance* skeleton_instance; // nullptr if the mesh is not skinned
     std::vector<Submesh_Instance> submesh_instances;
 };
 
@@ -103,6 +129,10 @@ struct Model
     std::vector<Submesh> submeshes;
     rhi::Buffer* vertex_positions;
     rhi::Buffer* vertex_attributes;
+    rhi::Buffer* vertex_skin_attributes; // nullptr if the model is not skinned
+    std::vector<Skeleton> skeletons;
+    std::vector<Animation_Clip> animation_clips;
+    Mapped_File* animation_file; // Pinned while the clips point into it, nullptr without clips
     OffsetAllocator::Allocation index_buffer_allocation;
     rhi::Buffer* blas_allocation;
 };
@@ -113,6 +143,9 @@ struct Model_Instance
     TRS trs;
     glm::mat4 model_to_world;
     std::vector<Mesh_Instance> mesh_instances;
+    std::vector<Skeleton_Instance> skeleton_instances;
+    rhi::Buffer* skinned_vertex_positions; // Same layout as the model positions, nullptr if not skinned
+    rhi::Buffer* skinned_blas_allocation;
 };
 
 struct Model_Descriptor
@@ -121,6 +154,14 @@ struct Model_Descriptor
     std::vector<TRS> instances;
 };
 
+struct Scene_Load_Progress
+{
+    uint32_t pending_models;
+    uint32_t pending_textures;
+    std::size_t pending_bytes; // Size of the files that are not integrated yet
+    std::size_t texture_bytes; // Resident and requested texture mips
+};
+
 class Render_Resource_Blackboard;
 
 class Static_Scene_Data
@@ -132,11 +173,13 @@ public:
     constexpr static auto MAX_MATERIALS = 1 << 17; // 128k Materials
     constexpr static auto MAX_INSTANCES = 1 << 22; // ~4M instances
     constexpr static auto MAX_LIGHTS = 1 << 10; // 1024 lights
+    constexpr static auto MAX_JOINT_PALETTE_MATRICES = 1 << 17; // 128k joints
 
     constexpr static auto INSTANCE_TRANSFORM_BUFFER_SIZE = sizeof(GPU_Instance_Transform_Data) * MAX_TRANSFORMS;
     constexpr static auto MATERIAL_INSTANCE_BUFFER_SIZE = sizeof(GPU_Material) * MAX_MATERIALS;
     constexpr static auto INSTANCE_INDICES_BUFFER_SIZE = sizeof(GPU_Instance_Indices) * MAX_INSTANCES;
     constexpr static auto LIGHT_BUFFER_SIZE = sizeof(Punctual_Light) * MAX_LIGHTS;
+    constexpr static auto JOINT_PALETTE_BUFFER_SIZE = sizeof(glm::mat4) * MAX_JOINT_PALETTE_MATRICES;
 
     Static_Scene_Data(
         rhi::Graphics_Device* graphics_device,
@@ -144,7 +187,8 @@ public:
         GPU_Transfer_Context& gpu_transfer_context,
         Asset_Repository& asset_repository,
         Render_Resource_Blackboard& render_resource_blackboard,
-        Acceleration_Structure_Builder& acceleration_structure_builder);
+        Acceleration_Structure_Builder& acceleration_structure_builder,
+        enki::TaskScheduler& task_scheduler);
     ~Static_Scene_Data();
 
     Static_Scene_Data(const Static_Scene_Data&) = delete;
@@ -152,27 +196,83 @@ public:
     Static_Scene_Data(Static_Scene_Data&&) = delete;
     Static_Scene_Data& operator=(Static_Scene_Data&&) = delete;
 
+    // Models and their textures are read and validated on the task scheduler workers,
+    // `integrate_loads` creates the GPU resources for the finished ones. Materials use the default
+    // textures until their own textures are integrated.
     void add_model(const Model_Descriptor& model_descriptor);
+    void integrate_loads();
+    [[nodiscard]] Scene_Load_Progress get_load_progress() const noexcept;
 
     [[nodiscard]] auto& get_models() const noexcept { return m_models; }
     [[nodiscard]] auto& get_instances() const noexcept { return m_model_Instances; }
     [[nodiscard]] auto* get_index_buffer() const noexcept { return m_global_index_buffer; }
     [[nodiscard]] auto get_tlas() const noexcept { return m_tlas; }
+    [[nodiscard]] auto* get_joint_palette_buffer() const noexcept { return m_joint_palette_buffer; }
     [[nodiscard]] glm::vec3 get_sun_direction() const noexcept;
 
     void upload_scene_info();
     void update_tlas();
+    void update_animations(float dt, enki::TaskScheduler& task_scheduler);
+    // Streams texture mips in and out depending on how detailed the materials appear from `camera`.
+    void update_texture_streaming(const Fly_Camera& camera);
 
     void gui();
 
 private:
+    struct Model_Load;
+    struct Texture_Load;
+
+    struct Texture_Binding
+    {
+        Material* material;
+        rhi::Image* Material::* image;
+    };
+
+    // Only the mips from `resident_mip` to the end of the chain are in the image. A new image is
+    // pending while it is uploaded on the copy queue, `image` is used until the upload is complete.
+    // The file the pending image is uploaded from stays pinned until then.
+    struct Streamed_Texture
+    {
+        rhi::Image* image;
+        rhi::Image* pending_image;
+        uint64_t pending_upload;
+        Mapped_File* pending_file;
+        uint32_t size; // Largest dimension of mip 0
+        uint32_t tail_mip;
+        uint32_t resident_mip;
+        uint32_t requested_mip; // Less than `resident_mip` while more detailed mips are loaded
+        uint32_t demanded_mip; // From the last demand estimate
+        uint64_t last_demand_frame;
+        std::vector<std::size_t> mip_chain_sizes; // Per first mip
+        std::vector<Texture_Binding> bindings; // Materials that sample the texture
+    };
+
+    struct Retired_Image
+    {
+        rhi::Image* image;
+        uint64_t frame;
+    };
+
     uint32_t acquire_instance_index();
     uint32_t acquire_material_index();
     uint32_t acquire_transform_index();
 
-    rhi::Image* get_or_create_image(const std::string& uri, rhi::Image* replacement);
+    Model& upload_model_geometry(const Model_Descriptor& model_descriptor, const Mapped_File& model_file,
+        std::vector<uint64_t>& uploads);
+    void integrate_model(const Model_Descriptor& model_descriptor, const Mapped_File& model_file, Model& model);
+    void integrate_texture(const Texture_Load& load);
+    void request_texture(const std::string& uri, Mapped_File& texture_file, const Texture_Binding& binding);
+    void request_texture_mips(const std::string& uri, Streamed_Texture& texture, uint32_t mip);
+    bool evict_texture_mips(std::size_t size, const Streamed_Texture* requesting_texture);
+    bool set_resident_mip(Streamed_Texture& texture, Mapped_File& texture_file, uint32_t mip, Upload_Priority priority);
+    void apply_finished_texture_uploads();
+    rhi::Image* create_image(const Mapped_File& texture_file, uint32_t first_mip, uint64_t& upload,
+        Upload_Priority priority);
+    void track_buffer(const rhi::Buffer* buffer);
+    void upload_material(const Material& material);
 
     void create_default_images();
+    void create_skinned_instance_data(Model_Instance& model_instance, const std::string& name);
 
 private:
     rhi::Graphics_Device* m_graphics_device;
@@ -181,6 +281,7 @@ private:
     Asset_Repository& m_asset_repository;
     Render_Resource_Blackboard& m_render_resource_blackboard;
     Acceleration_Structure_Builder& m_acceleration_structure_builder;
+    enki::TaskScheduler& m_task_scheduler;
 
     OffsetAllocator::Allocator m_index_buffer_allocator;
 
@@ -194,7 +295,16 @@ private:
     plf::colony<Model_Instance> m_model_Instances = {};
     std::vector<Punctual_Light> m_punctual_lights = {};
 
-    ankerl::unordered_dense::map<std::string, rhi::Image*> m_images = {};
+    ankerl::unordered_dense::map<std::string, Streamed_Texture> m_textures = {};
+    std::vector<Retired_Image> m_retired_images = {};
+    std::deque<std::unique_ptr<Model_Load>> m_model_loads = {}; // Integrated in the order they were added
+    std::vector<std::unique_ptr<Texture_Load>> m_texture_loads = {};
+    ankerl::unordered_dense::map<std::string, std::vector<Texture_Binding>> m_texture_bindings = {}; // Per texture that is loaded for the first time
+    float m_load_budget_ms = 2.f; // Main thread time per frame for integrating finished loads
+    int32_t m_gpu_budget_mib = 4096; // Buffers are not evicted, textures stream within what they leave
+    Memory_Usage m_image_usage = {}; // Includes the mips that are still loading
+    Memory_Usage m_buffer_usage = {};
+    uint64_t m_streaming_frame = 0;
     rhi::Buffer* m_global_index_buffer = nullptr;
     rhi::Buffer* m_transform_buffer = nullptr;
     rhi::Buffer* m_material_buffer = nullptr;
@@ -203,6 +313,7 @@ private:
     rhi::Buffer* m_scene_info_buffer = nullptr;
     std::array<rhi::Buffer*, REN_MAX_FRAMES_IN_FLIGHT> m_tlas_instance_buffers = {};
     rhi::Buffer* m_tlas_buffer = nullptr;
+    rhi::Buffer* m_joint_palette_buffer = nullptr;
 
     rhi::Acceleration_Structure* m_tlas = nullptr;
 
@@ -214,5 +325,12 @@ private:
 
     glm::vec3 m_sun_direction = glm::normalize(glm::vec3(-0.456f, -0.334f, -0.825f));
     float m_sun_intensity = 125000.f; // in illuminance (lx)
+
+    std::vector<Skeleton_Instance*> m_skeleton_instances = {};
+    std::vector<glm::mat4> m_joint_palette = {};
+    std::vector<BLAS_Build_Request> m_skinned_blas_build_requests = {};
+    float m_animation_playback_speed = 1.f;
+    float m_animation_cpu_time_ms = 0.f;
+    bool m_animation_paused = false;
 };
 }
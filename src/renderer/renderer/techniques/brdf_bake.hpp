@@ -18,7 +18,7 @@ namespace techniques
 class BRDF_LUT
 {
 public:
-    constexpr static auto LUT_TEXTURE_NAME = "pbr:brdf_lut_texture";
+    constexpr static Name LUT_TEXTURE_NAME = "pbr:brdf_lut_texture";
 
     BRDF_LUT(Asset_Repository& asset_repository,
         Render_Resource_Blackboard& render_resource_blackboard);
@@ -18,7 +18,7 @@ namespace techniques
 class Exposure
 {
 public:
-    constexpr static auto LUMINANCE_HISTOGRAM_BUFFER_NAME = "exposure:luminance_histogram_buffer";
+    constexpr static Name LUMINANCE_HISTOGRAM_BUFFER_NAME = "exposure:luminance_histogram_buffer";
 
     Exposure(Asset_Repository& asset_repository,
         GPU_Transfer_Context& gpu_transfer_context,
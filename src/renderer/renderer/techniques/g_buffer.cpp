@@ -61,7 +61,7 @@ G_Buffer::~G_Buffer()
 void G_Buffer::render_scene_cpu(
     rhi::Command_List* cmd,
     Resource_State_Tracker& tracker,
-    const Buffer& camera,
+    uint32_t camera,
     const Static_Scene_Data& scene_data) const
 {
     cmd->begin_debug_region("g_buffer:render_scene_cpu", 1.f, .5f, 1.f);
@@ -164,8 +164,12 @@ void G_Buffer::render_scene_cpu(
                 if (submesh_instance.material->alpha_mode == Material_Alpha_Mode::Blend)
                     continue;
 
+                const auto* position_buffer = mesh_instance.skeleton_instance && submesh->is_skinned && model_instance.skinned_vertex_positions
+                    ? model_instance.skinned_vertex_positions
+                    : model->vertex_positions;
+
                 cmd->set_push_constants<Immediate_Draw_Push_Constants>({
-                    .position_buffer = model->vertex_positions->buffer_view->bindless_index,
+                    .position_buffer = position_buffer->buffer_view->bindless_index,
                     .attribute_buffer = model->vertex_attributes->buffer_view->bindless_index,
                     .camera_buffer = camera
                 }, rhi::Pipeline_Bind_Point::Graphics);
@@ -187,7 +191,7 @@ void G_Buffer::render_scene_cpu(
 void G_Buffer::resolve(
     rhi::Command_List* cmd,
     Resource_State_Tracker& tracker,
-    const Buffer& camera,
+    uint32_t camera,
     const Image& resolve_target)
 {
     cmd->begin_debug_region("g_buffer:resolve", 1.f, .5f, 1.f);
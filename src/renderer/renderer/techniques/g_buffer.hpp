@@ -18,11 +18,11 @@ namespace techniques
 class G_Buffer
 {
 public:
-    constexpr static auto G_BUFFER_0_RENDER_TARGET_NAME = "g_buffer:g_buffer_0_render_target";
-    constexpr static auto G_BUFFER_1_RENDER_TARGET_NAME = "g_buffer:g_buffer_1_render_target";
-    constexpr static auto G_BUFFER_2_RENDER_TARGET_NAME = "g_buffer:g_buffer_2_render_target";
-    constexpr static auto G_BUFFER_3_RENDER_TARGET_NAME = "g_buffer:g_buffer_3_render_target";
-    constexpr static auto G_BUFFER_DEPTH_BUFFER_NAME = "g_buffer:depth_buffer";
+    constexpr static Name G_BUFFER_0_RENDER_TARGET_NAME = "g_buffer:g_buffer_0_render_target";
+    constexpr static Name G_BUFFER_1_RENDER_TARGET_NAME = "g_buffer:g_buffer_1_render_target";
+    constexpr static Name G_BUFFER_2_RENDER_TARGET_NAME = "g_buffer:g_buffer_2_render_target";
+    constexpr static Name G_BUFFER_3_RENDER_TARGET_NAME = "g_buffer:g_buffer_3_render_target";
+    constexpr static Name G_BUFFER_DEPTH_BUFFER_NAME = "g_buffer:depth_buffer";
 
     G_Buffer(Asset_Repository& asset_repository, Render_Resource_Blackboard& render_resource_blackboard,
         uint32_t width, uint32_t height);
@@ -36,12 +36,12 @@ public:
     void render_scene_cpu(
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera,
+        uint32_t camera,
         const Static_Scene_Data& scene_data) const;
     void resolve(
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera,
+        uint32_t camera,
         const Image& resolve_target);
 
 private:
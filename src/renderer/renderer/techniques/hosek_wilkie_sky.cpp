@@ -79,10 +79,6 @@ Hosek_Wilkie_Sky::Hosek_Wilkie_Sky(
     , m_gpu_transfer_context(gpu_transfer_context)
     , m_render_resource_blackboard(render_resource_blackboard)
 {
-    m_parameters = m_render_resource_blackboard.create_buffer(PARAMETERS_BUFFER_NAME, {
-        .size = sizeof(Hosek_Wilkie_Parameters),
-        .heap = rhi::Memory_Heap_Type::GPU,
-        .acceleration_structure_memory = false});
     rhi::Image_Create_Info cube_create_info = {
         .format = rhi::Image_Format::B10G11R11_UFLOAT_PACK32,
         .width = 256,
@@ -135,7 +131,6 @@ Hosek_Wilkie_Sky::Hosek_Wilkie_Sky(
 
 Hosek_Wilkie_Sky::~Hosek_Wilkie_Sky()
 {
-    m_render_resource_blackboard.destroy_buffer(m_parameters);
     m_render_resource_blackboard.destroy_image(m_cubemap);
 }
 
@@ -146,7 +141,7 @@ void Hosek_Wilkie_Sky::update(const glm::vec3& sun_direction)
 
     auto parameters = bake_parameters(m_turbidity, m_albedo, theta, m_use_xyz);
 
-    m_gpu_transfer_context.enqueue_immediate_upload(m_parameters, parameters);
+    m_parameters = m_gpu_transfer_context.upload_transient(parameters);
 }
 
 void Hosek_Wilkie_Sky::generate_cubemap(
@@ -280,7 +275,7 @@ void Hosek_Wilkie_Sky::prefilter_specular_irradiance(rhi::Command_List* cmd, Res
 void Hosek_Wilkie_Sky::skybox_render(
     rhi::Command_List* cmd,
     Resource_State_Tracker& tracker,
-    const Buffer& camera,
+    uint32_t camera,
     const Image& shaded_geometry_render_target,
     const Image& geometry_depth_buffer) const
 {
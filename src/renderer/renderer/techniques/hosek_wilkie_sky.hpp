@@ -21,10 +21,9 @@ namespace techniques
 class Hosek_Wilkie_Sky
 {
 public:
-    constexpr static auto PARAMETERS_BUFFER_NAME = "hosek_wilkie:parameters_buffer";
-    constexpr static auto SKY_CUBEMAP_TEXTURE_NAME = "hosek_wilkie:sky_cubemap_texture";
-    constexpr static auto PREFILTERED_DIFFUSE_IRRADIANCE_CUBEMAP_TEXTURE_NAME = "hosek_wilkie:prefiltered_diffuse_irradiance_cubemap_texture";
-    constexpr static auto PREFILTERED_SPECULAR_IRRADIANCE_CUBEMAP_TEXTURE_NAME = "hosek_wilkie:prefiltered_specular_irradiance_cubemap_texture";
+    constexpr static Name SKY_CUBEMAP_TEXTURE_NAME = "hosek_wilkie:sky_cubemap_texture";
+    constexpr static Name PREFILTERED_DIFFUSE_IRRADIANCE_CUBEMAP_TEXTURE_NAME = "hosek_wilkie:prefiltered_diffuse_irradiance_cubemap_texture";
+    constexpr static Name PREFILTERED_SPECULAR_IRRADIANCE_CUBEMAP_TEXTURE_NAME = "hosek_wilkie:prefiltered_specular_irradiance_cubemap_texture";
 
     Hosek_Wilkie_Sky(
         Asset_Repository& asset_repository,
@@ -50,7 +49,7 @@ public:
     void skybox_render(
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera,
+        uint32_t camera,
         const Image& shaded_geometry_render_target,
         const Image& geometry_depth_buffer) const;
 
@@ -61,7 +60,7 @@ private:
     GPU_Transfer_Context& m_gpu_transfer_context;
     Render_Resource_Blackboard& m_render_resource_blackboard;
 
-    Buffer m_parameters;
+    uint32_t m_parameters = 0; // Transient, written every frame
     Image m_cubemap;
     Image m_prefiltered_diffuse_irradiance_cubemap = {};
     Image m_prefiltered_specular_irradiance_cubemap = {};
@@ -249,7 +249,7 @@ void Image_Based_Lighting::bake(rhi::Command_List* cmd, Resource_State_Tracker&
 void Image_Based_Lighting::skybox_render(
     rhi::Command_List* cmd,
     Resource_State_Tracker& tracker,
-    const Buffer& camera,
+    uint32_t camera,
     const Image& shaded_geometry_render_target,
     const Image& geometry_depth_buffer)
 {
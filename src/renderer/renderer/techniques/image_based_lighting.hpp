@@ -18,11 +18,11 @@ namespace techniques
 class Image_Based_Lighting
 {
 public:
-    constexpr static auto HDRI_TEXTURE_NAME = "image_based_lighting:hdri_texture";
-    constexpr static auto ENVIRONMENT_CUBEMAP_TEXTURE_NAME = "image_based_lighting:environment_cubemap_texture";
-    constexpr static auto PREFILTERED_DIFFUSE_IRRADIANCE_CUBEMAP_TEXTURE_NAME = "image_based_lighting:prefiltered_diffuse_irradiance_cubemap_texture";
-    constexpr static auto PREFILTERED_SPECULAR_IRRADIANCE_CUBEMAP_TEXTURE_NAME = "image_based_lighting:prefiltered_specular_irradiance_cubemap_texture";
-    constexpr static auto BRDF_LUT_TEXTURE_NAME = "image_based_lighting:brdf_lut_texture";
+    constexpr static Name HDRI_TEXTURE_NAME = "image_based_lighting:hdri_texture";
+    constexpr static Name ENVIRONMENT_CUBEMAP_TEXTURE_NAME = "image_based_lighting:environment_cubemap_texture";
+    constexpr static Name PREFILTERED_DIFFUSE_IRRADIANCE_CUBEMAP_TEXTURE_NAME = "image_based_lighting:prefiltered_diffuse_irradiance_cubemap_texture";
+    constexpr static Name PREFILTERED_SPECULAR_IRRADIANCE_CUBEMAP_TEXTURE_NAME = "image_based_lighting:prefiltered_specular_irradiance_cubemap_texture";
+    constexpr static Name BRDF_LUT_TEXTURE_NAME = "image_based_lighting:brdf_lut_texture";
 
     Image_Based_Lighting(Asset_Repository& asset_repository,
         GPU_Transfer_Context& gpu_transfer_context,
@@ -41,7 +41,7 @@ public:
     void skybox_render(
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera,
+        uint32_t camera,
         const Image& shaded_geometry_render_target,
         const Image& geometry_depth_buffer);
 
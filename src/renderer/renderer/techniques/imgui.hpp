@@ -18,9 +18,9 @@ namespace techniques
 class Imgui
 {
 public:
-    constexpr static auto VERTEX_BUFFER_NAME = "imgui::vertex_buffer";
-    constexpr static auto INDEX_BUFFER_NAME = "imgui::index_buffer";
-    constexpr static auto FONT_TEXTURE_NAME = "imgui::font_texture";
+    constexpr static Name VERTEX_BUFFER_NAME = "imgui::vertex_buffer";
+    constexpr static Name INDEX_BUFFER_NAME = "imgui::index_buffer";
+    constexpr static Name FONT_TEXTURE_NAME = "imgui::font_texture";
 
     Imgui(Asset_Repository& asset_repository,
         GPU_Transfer_Context& gpu_transfer_context,
@@ -12,6 +12,8 @@
 
 #include <imgui.h>
 
+#include <bit>
+
 namespace ren::techniques
 {
 constexpr static auto FIELD_SIZE = 2048;
@@ -21,18 +23,27 @@ constexpr static auto VERTEX_DIST = 0.25f;
 constexpr static auto TILE_SIZE = static_cast<float>(TILE_VERTEX_COUNT - 1) * VERTEX_DIST;
 constexpr static auto MAX_TILE_SIZE = static_cast<float>(FIELD_SIZE) * VERTEX_DIST;
 
+// Variants by texture size, starting at 64.
+constexpr static auto FFT_VARIANT_NAMES = std::to_array<Name>({
+    "fft_64_float4", "fft_128_float4", "fft_256_float4", "fft_512_float4", "fft_1024_float4" });
+constexpr static auto FFT_MINMAX_VARIANT_NAMES = std::to_array<Name>({
+    "fft_64_float4_minmax", "fft_128_float4_minmax", "fft_256_float4_minmax", "fft_512_float4_minmax", "fft_1024_float4_minmax" });
+constexpr static auto FFT_MIN_MAX_RESOLVE_VARIANT_NAMES = std::to_array<Name>({
+    "fft_min_max_resolve64", "fft_min_max_resolve128", "fft_min_max_resolve256", "fft_min_max_resolve512", "fft_min_max_resolve1024" });
+
+constexpr std::size_t get_fft_variant_index(const uint32_t texture_size)
+{
+    return std::countr_zero(texture_size) - std::countr_zero(64u);
+}
+
 Ocean::Ocean(Asset_Repository& asset_repository, GPU_Transfer_Context& gpu_transfer_context,
-    Render_Resource_Blackboard& render_resource_blackboard, uint32_t width, uint32_t height)
+    GPU_Readback_Context& gpu_readback_context, Render_Resource_Blackboard& render_resource_blackboard,
+    uint32_t width, uint32_t height)
     : m_asset_repository(asset_repository)
     , m_gpu_transfer_context(gpu_transfer_context)
+    , m_gpu_readback_context(gpu_readback_context)
     , m_render_resource_blackboard(render_resource_blackboard)
 {
-    m_spectrum_parameters_buffer = m_render_resource_blackboard.create_buffer(
-        SPECTRUM_PARAMETERS_BUFFER_NAME,
-        {
-            .size = sizeof(Ocean_Initial_Spectrum_Data),
-            .heap = rhi::Memory_Heap_Type::GPU
-        });
     m_spectrum_state_texture = m_render_resource_blackboard.create_image(
         SPECTRUM_STATE_TEXTURE_NAME, options.generate_create_info(rhi::Image_Format::R16G16B16A16_SFLOAT));
     m_spectrum_angular_frequency_texture = m_render_resource_blackboard.create_image(
@@ -96,12 +107,6 @@ Ocean::Ocean(Asset_Repository& asset_repository, GPU_Transfer_Context& gpu_trans
             .size = sizeof(glm::vec4) * 2 * 2 * 4,
             .heap = rhi::Memory_Heap_Type::GPU
         });
-    m_minmax_readback_buffer = m_render_resource_blackboard.create_buffer(
-        FFT_MINMAX_READBACK_BUFFER_NAME,
-        {
-            .size = REN_MAX_FRAMES_IN_FLIGHT * sizeof(Ocean_Min_Max_Values),
-            .heap = rhi::Memory_Heap_Type::CPU_Readback
-        });
     m_packed_displacement_texture = m_render_resource_blackboard.create_image(
         PACKED_DISPLACEMENT_TEXTURE_NAME, options.generate_create_info(rhi::Image_Format::A2R10G10B10_UNORM_PACK32));
     m_packed_derivatives_texture = m_render_resource_blackboard.create_image(
@@ -112,9 +117,7 @@ Ocean::Ocean(Asset_Repository& asset_repository, GPU_Transfer_Context& gpu_trans
 
 Ocean::~Ocean()
 {
-    m_render_resource_blackboard.destroy_buffer(m_spectrum_parameters_buffer);
     m_render_resource_blackboard.destroy_buffer(m_minmax_buffer);
-    m_render_resource_blackboard.destroy_buffer(m_minmax_readback_buffer);
     m_render_resource_blackboard.destroy_image(m_spectrum_state_texture);
     m_render_resource_blackboard.destroy_image(m_spectrum_angular_frequency_texture);
     m_render_resource_blackboard.destroy_image(m_displacement_x_y_z_xdx_texture);
@@ -130,24 +133,21 @@ void Ocean::update(float dt, const Fly_Camera& cull_camera)
 {
     if (!options.enabled) return;
 
-    static uint64_t frame = 0;
-
-    if (frame > REN_MAX_FRAMES_IN_FLIGHT)
+    while (!m_minmax_readbacks.empty() && m_gpu_readback_context.is_ready(m_minmax_readbacks.front()))
     {
-        const auto& index = frame % REN_MAX_FRAMES_IN_FLIGHT;
-        const auto& min_max_values = static_cast<Ocean_Min_Max_Values*>(static_cast<void*>(m_minmax_readback_buffer))[index];
-
-        m_min_displacement = {};
-        m_max_displacement = {};
-        for (uint32_t i = 0; i < options.cascade_count; ++i)
+        if (const auto* min_max_values = m_gpu_readback_context.get_data<Ocean_Min_Max_Values>(m_minmax_readbacks.front()))
         {
-            m_min_displacement += min_max_values.cascades[i].min_values.xyz();
-            m_max_displacement += min_max_values.cascades[i].max_values.xyz();
+            m_min_displacement = {};
+            m_max_displacement = {};
+            for (uint32_t i = 0; i < options.cascade_count; ++i)
+            {
+                m_min_displacement += min_max_values->cascades[i].min_values.xyz();
+                m_max_displacement += min_max_values->cascades[i].max_values.xyz();
+            }
         }
+        m_minmax_readbacks.pop_front();
     }
 
-    frame += 1;
-
     if (options.update_time)
         simulation_data.total_time += dt;
 
@@ -180,7 +180,7 @@ void Ocean::update(float dt, const Fly_Camera& cull_camera)
         .g = simulation_data.full_spectrum_parameters.gravity,
         .h = simulation_data.full_spectrum_parameters.depth
     };
-    m_gpu_transfer_context.enqueue_immediate_upload(m_spectrum_parameters_buffer, gpu_spectrum_data);
+    m_spectrum_parameters_buffer = m_gpu_transfer_context.upload_transient(gpu_spectrum_data);
 
     generate_drawable_cells(cull_camera);
 }
@@ -250,16 +250,8 @@ void Ocean::simulate(
         options.cascade_count);
     cmd->end_debug_region(); // ocean:simulation:time_dependent_spectrum
 
-    auto select_fft_variant = [&](bool minmax = false)
-    {
-        std::stringstream ss;
-        ss << "fft_";
-        ss << std::to_string(options.texture_size);
-        ss << "_float4";
-        if (minmax) ss << "_minmax";
-        return ss.str();
-    };
-    cmd->set_pipeline(m_asset_repository.get_compute_pipeline("fft").set_variant(select_fft_variant()));
+    const auto fft_variant_index = get_fft_variant_index(options.texture_size);
+    cmd->set_pipeline(m_asset_repository.get_compute_pipeline("fft").set_variant(FFT_VARIANT_NAMES[fft_variant_index]));
     cmd->begin_debug_region("ocean:simulation:inverse_fft:vertical", 0.25f, 0.25f, 1.0f);
     tracker.use_resource(
         m_displacement_x_y_z_xdx_texture,
@@ -297,7 +289,7 @@ void Ocean::simulate(
     cmd->end_debug_region(); // ocean:simulation:inverse_fft:vertical
 
     cmd->begin_debug_region("ocean:simulation:inverse_fft:horizontal", 0.25f, 0.375f, 1.0f);
-    cmd->set_pipeline(m_asset_repository.get_compute_pipeline("fft").set_variant(select_fft_variant(true)));
+    cmd->set_pipeline(m_asset_repository.get_compute_pipeline("fft").set_variant(FFT_MINMAX_VARIANT_NAMES[fft_variant_index]));
     tracker.use_resource(
         m_displacement_x_y_z_xdx_texture,
         rhi::Barrier_Pipeline_Stage::Compute_Shader,
@@ -352,14 +344,8 @@ void Ocean::simulate(
         rhi::Barrier_Pipeline_Stage::Compute_Shader,
         rhi::Barrier_Access::Unordered_Access_Write);
     tracker.flush_barriers(cmd);
-    auto select_fft_min_max_resolve_variant = [&]()
-        {
-            std::stringstream ss;
-            ss << "fft_min_max_resolve";
-            ss << std::to_string(options.texture_size);
-            return ss.str();
-        };
-    cmd->set_pipeline(m_asset_repository.get_compute_pipeline("fft_min_max_resolve").set_variant(select_fft_min_max_resolve_variant()));
+    cmd->set_pipeline(m_asset_repository.get_compute_pipeline("fft_min_max_resolve")
+        .set_variant(FFT_MIN_MAX_RESOLVE_VARIANT_NAMES[fft_variant_index]));
     cmd->set_push_constants<FFT_Min_Max_Resolve_Push_Constants>({
         .min_max_tex = m_minmax_texture,
         .min_max_tex_load_offset = 0,
@@ -426,33 +412,18 @@ void Ocean::simulate(
     // min/max copy
     {
         cmd->add_debug_marker("ocean:simulation:readback_min_max_values", 0.25f, 0.75f, 1.0f);
-    
-        static uint64_t frame = 0;
 
-        if (frame > 0)
-            tracker.set_resource_state(m_minmax_readback_buffer, rhi::Barrier_Pipeline_Stage::Copy, rhi::Barrier_Access::Transfer_Write);
-    
         tracker.use_resource(m_minmax_buffer, rhi::Barrier_Pipeline_Stage::Copy, rhi::Barrier_Access::Transfer_Read);
-        tracker.use_resource(m_minmax_readback_buffer, rhi::Barrier_Pipeline_Stage::Copy, rhi::Barrier_Access::Transfer_Write);
         tracker.flush_barriers(cmd);
-    
-        const auto& index = frame % REN_MAX_FRAMES_IN_FLIGHT;
-
-        cmd->copy_buffer(
-            m_minmax_buffer,
-            0,
-            m_minmax_readback_buffer,
-            index * sizeof(Ocean_Min_Max_Values),
-            sizeof(Ocean_Min_Max_Values)
-        );
-    
-        frame += 1;
+
+        m_minmax_readbacks.push_back(m_gpu_readback_context.enqueue_readback(
+            cmd, m_minmax_buffer, 0, sizeof(Ocean_Min_Max_Values)));
     }
 
     cmd->end_debug_region(); // ocean:simulation
 }
 
-void Ocean::depth_pre_pass(rhi::Command_List* cmd, Resource_State_Tracker& tracker, const Buffer& camera,
+void Ocean::depth_pre_pass(rhi::Command_List* cmd, Resource_State_Tracker& tracker, uint32_t camera,
     const Image& shaded_scene_depth_render_target)
 {
     if (!options.enabled) return;
@@ -536,7 +507,7 @@ void Ocean::depth_pre_pass(rhi::Command_List* cmd, Resource_State_Tracker& track
 void Ocean::opaque_forward_pass(
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera,
+        uint32_t camera,
         const Image& shaded_scene_render_target,
         const Image& shaded_scene_depth_render_target)
 {
@@ -712,7 +683,7 @@ void Ocean::generate_drawable_cells(const Fly_Camera& cull_camera)
     }
 }
 
-void Ocean::draw_all_tiles(rhi::Command_List* cmd, const Buffer& camera)
+void Ocean::draw_all_tiles(rhi::Command_List* cmd, uint32_t camera)
 {
     cmd->set_index_buffer(m_tile_index_buffer, rhi::Index_Type::U16);
     for (const auto& tile : m_drawable_tiles)
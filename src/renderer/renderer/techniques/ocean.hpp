@@ -1,8 +1,11 @@
 #pragma once
 
+#include "renderer/gpu_readback.hpp"
 #include "renderer/render_resource_blackboard.hpp"
 #include <glm/glm.hpp>
 
+#include <deque>
+
 namespace rhi
 {
 class Command_List;
@@ -20,23 +23,22 @@ namespace techniques
 class Ocean
 {
 public:
-    constexpr static auto SPECTRUM_PARAMETERS_BUFFER_NAME = "ocean:spectrum_parameters_buffer";
-    constexpr static auto SPECTRUM_STATE_TEXTURE_NAME = "ocean:spectrum_initial_state_texture";
-    constexpr static auto SPECTRUM_ANGULAR_FREQUENCY_TEXTURE_NAME = "ocean:spectrum_angular_frequency_texture";
-    constexpr static auto DISPLACEMENT_X_Y_Z_XDX_TEXTURE_NAME = "ocean:displacement_x_y_z_xdx";
-    constexpr static auto DISPLACEMENT_YDX_ZDX_YDY_ZDY_TEXTURE_NAME = "ocean:displacement_ydx_zdx_ydy_zdy_texture";
-    constexpr static auto FORWARD_PASS_DEPTH_RENDER_TARGET_NAME = "ocean:forward_pass_depth_render_target";
-    constexpr static auto TILE_INDEX_BUFFER_NAME = "ocean:tile_index_buffer";
-
-    constexpr static auto FFT_MIN_MAX_TEXTURE_NAME = "ocean:fft_min_max_texture";
-    constexpr static auto FFT_MINMAX_BUFFER_NAME = "ocean:fft_minmax_buffer";
-    constexpr static auto FFT_MINMAX_READBACK_BUFFER_NAME = "ocean:fft_minmax_readback_buffer";
-    constexpr static auto PACKED_DISPLACEMENT_TEXTURE_NAME = "ocean:packed_displacement_texture";
-    constexpr static auto FOAM_WEIGHT_TEXTURE_NAME = "ocean:foam_weight_texture";
-    constexpr static auto PACKED_DERIVATIVES_TEXTURE_NAME = "ocean:packed_derivatives_texture";
+    constexpr static Name SPECTRUM_STATE_TEXTURE_NAME = "ocean:spectrum_initial_state_texture";
+    constexpr static Name SPECTRUM_ANGULAR_FREQUENCY_TEXTURE_NAME = "ocean:spectrum_angular_frequency_texture";
+    constexpr static Name DISPLACEMENT_X_Y_Z_XDX_TEXTURE_NAME = "ocean:displacement_x_y_z_xdx";
+    constexpr static Name DISPLACEMENT_YDX_ZDX_YDY_ZDY_TEXTURE_NAME = "ocean:displacement_ydx_zdx_ydy_zdy_texture";
+    constexpr static Name FORWARD_PASS_DEPTH_RENDER_TARGET_NAME = "ocean:forward_pass_depth_render_target";
+    constexpr static Name TILE_INDEX_BUFFER_NAME = "ocean:tile_index_buffer";
+
+    constexpr static Name FFT_MIN_MAX_TEXTURE_NAME = "ocean:fft_min_max_texture";
+    constexpr static Name FFT_MINMAX_BUFFER_NAME = "ocean:fft_minmax_buffer";
+    constexpr static Name PACKED_DISPLACEMENT_TEXTURE_NAME = "ocean:packed_displacement_texture";
+    constexpr static Name FOAM_WEIGHT_TEXTURE_NAME = "ocean:foam_weight_texture";
+    constexpr static Name PACKED_DERIVATIVES_TEXTURE_NAME = "ocean:packed_derivatives_texture";
 
     Ocean(Asset_Repository& asset_repository,
         GPU_Transfer_Context& gpu_transfer_context,
+        GPU_Readback_Context& gpu_readback_context,
         Render_Resource_Blackboard& render_resource_blackboard,
         uint32_t width, uint32_t height);
     ~Ocean();
@@ -55,14 +57,14 @@ public:
     void depth_pre_pass(
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera,
+        uint32_t camera,
         const Image& shaded_scene_depth_render_target);
 
     // TODO: add proper translucent pass instead.
     void opaque_forward_pass(
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera,
+        uint32_t camera,
         const Image& shaded_scene_render_target,
         const Image& shaded_scene_depth_render_target);
 
@@ -71,9 +73,10 @@ public:
 private:
     Asset_Repository& m_asset_repository;
     GPU_Transfer_Context& m_gpu_transfer_context;
+    GPU_Readback_Context& m_gpu_readback_context;
     Render_Resource_Blackboard& m_render_resource_blackboard;
 
-    Buffer m_spectrum_parameters_buffer;
+    uint32_t m_spectrum_parameters_buffer = 0; // Transient, written every frame
     Image m_spectrum_state_texture;
     Image m_spectrum_angular_frequency_texture;
     Image m_displacement_x_y_z_xdx_texture;
@@ -83,7 +86,7 @@ private:
 
     Image m_minmax_texture;
     Buffer m_minmax_buffer;
-    Buffer m_minmax_readback_buffer;
+    std::deque<GPU_Readback> m_minmax_readbacks; // Oldest first
     Image m_packed_displacement_texture;
     Image m_packed_derivatives_texture;
     Image m_packed_xdx_texture;
@@ -165,7 +168,7 @@ public:
 private:
 
     void generate_drawable_cells(const Fly_Camera& cull_camera);
-    void draw_all_tiles(rhi::Command_List* cmd, const Buffer& camera);
+    void draw_all_tiles(rhi::Command_List* cmd, uint32_t camera);
 
     void process_gui_options();
     void process_gui_simulation_settings();
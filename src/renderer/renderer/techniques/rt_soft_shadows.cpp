@@ -37,7 +37,7 @@ RT_Soft_Shadows::~RT_Soft_Shadows()
 void RT_Soft_Shadows::trace_shadow_rays(
     rhi::Command_List* cmd,
     Resource_State_Tracker& tracker,
-    const Buffer& camera_buffer,
+    uint32_t camera_buffer,
     const Image& g_buffer_1_render_target,
     const Image& depth_render_target)
 {
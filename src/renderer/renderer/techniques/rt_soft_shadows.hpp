@@ -8,7 +8,7 @@ namespace ren::techniques
 class RT_Soft_Shadows final : public Technique_Base
 {
 public:
-    constexpr static auto SUN_VISIBILITY_TEXTURE_NAME = "rt_soft_shadows:sun_visibility_texture";
+    constexpr static Name SUN_VISIBILITY_TEXTURE_NAME = "rt_soft_shadows:sun_visibility_texture";
 
     RT_Soft_Shadows(Asset_Repository& asset_repository,
         GPU_Transfer_Context& gpu_transfer_context,
@@ -18,7 +18,7 @@ public:
 
     void trace_shadow_rays(rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera_buffer,
+        uint32_t camera_buffer,
         const Image& g_buffer_1_render_target,
         const Image& depth_render_target);
 
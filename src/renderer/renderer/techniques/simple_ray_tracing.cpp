@@ -42,7 +42,7 @@ Simple_Ray_Tracing::~Simple_Ray_Tracing()
 void Simple_Ray_Tracing::trace_rays(
     rhi::Command_List* cmd,
     Resource_State_Tracker& tracker,
-    const Buffer& camera_buffer,
+    uint32_t camera_buffer,
     const Image& render_target,
     uint32_t tlas_index)
 {
@@ -23,7 +23,7 @@ public:
     void trace_rays(
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
-        const Buffer& camera_buffer,
+        uint32_t camera_buffer,
         const Image& render_target,
         uint32_t tlas_index);
 
@@ -0,0 +1,107 @@
+#include "renderer/techniques/skinning.hpp"
+
+#include "renderer/asset/asset_repository.hpp"
+#include "renderer/scene/scene.hpp"
+
+#include <rhi/command_list.hpp>
+#include <shared/skinning_shared_types.h>
+
+#include <array>
+
+namespace ren::techniques
+{
+Skinning::Skinning(Asset_Repository& asset_repository)
+    : m_asset_repository(asset_repository)
+{}
+
+void Skinning::skin_instances(
+    rhi::Command_List* cmd,
+    const Static_Scene_Data& scene_data) const
+{
+    cmd->begin_debug_region("skinning:skin_instances", 0.5f, 1.f, 0.5f);
+
+    const auto pipeline = m_asset_repository.get_compute_pipeline("skinning");
+    cmd->set_pipeline(pipeline);
+
+    auto dispatched = false;
+    for (const auto& model_instance : scene_data.get_instances())
+    {
+        if (!model_instance.skinned_vertex_positions)
+            continue;
+
+        const auto* model = model_instance.model;
+        for (const auto& mesh_instance : model_instance.mesh_instances)
+        {
+            if (!mesh_instance.skeleton_instance)
+                continue;
+
+            for (const auto& submesh_instance : mesh_instance.submesh_instances)
+            {
+                const auto* submesh = submesh_instance.submesh;
+                if (!submesh->is_skinned)
+                    continue;
+
+                if (!dispatched)
+                {
+                    // The previous frame may still be drawing from or building over the skinned vertices.
+                    auto memory_barrier_infos = std::to_array<rhi::Memory_Barrier_Info>({
+                        {
+                            .stage_before = rhi::Barrier_Pipeline_Stage::Vertex_Shader,
+                            .stage_after = rhi::Barrier_Pipeline_Stage::Compute_Shader,
+                            .access_before = rhi::Barrier_Access::Shader_Read,
+                            .access_after = rhi::Barrier_Access::Unordered_Access_Write,
+                        },
+                        {
+                            .stage_before = rhi::Barrier_Pipeline_Stage::Acceleration_Structure_Build,
+                            .stage_after = rhi::Barrier_Pipeline_Stage::Compute_Shader,
+                            .access_before = rhi::Barrier_Access::Shader_Read,
+                            .access_after = rhi::Barrier_Access::Unordered_Access_Write,
+                        }
+                    });
+                    rhi::Barrier_Info barrier_info = {
+                        .memory_barriers = memory_barrier_infos
+                    };
+                    cmd->barrier(barrier_info);
+                }
+
+                cmd->set_push_constants<Skinning_Push_Constants>({
+                    .src_position_buffer = model->vertex_positions->buffer_view->bindless_index,
+                    .skin_attribute_buffer = model->vertex_skin_attributes->buffer_view->bindless_index,
+                    .joint_palette_buffer = scene_data.get_joint_palette_buffer()->buffer_view->bindless_index,
+                    .dst_position_buffer = model_instance.skinned_vertex_positions->buffer_view->bindless_index,
+                    .first_vertex = submesh->first_vertex,
+                    .first_skin_attribute = submesh->first_skin_attribute,
+                    .vertex_count = submesh->vertex_count,
+                    .palette_offset = mesh_instance.skeleton_instance->palette_offset
+                }, rhi::Pipeline_Bind_Point::Compute);
+                cmd->dispatch((submesh->vertex_count + pipeline.get_group_size_x() - 1) / pipeline.get_group_size_x(), 1, 1);
+                dispatched = true;
+            }
+        }
+    }
+
+    if (dispatched)
+    {
+        auto memory_barrier_infos = std::to_array<rhi::Memory_Barrier_Info>({
+            {
+                .stage_before = rhi::Barrier_Pipeline_Stage::Compute_Shader,
+                .stage_after = rhi::Barrier_Pipeline_Stage::Acceleration_Structure_Build,
+                .access_before = rhi::Barrier_Access::Unordered_Access_Write,
+                .access_after = rhi::Barrier_Access::Shader_Read,
+            },
+            {
+                .stage_before = rhi::Barrier_Pipeline_Stage::Compute_Shader,
+                .stage_after = rhi::Barrier_Pipeline_Stage::Vertex_Shader,
+                .access_before = rhi::Barrier_Access::Unordered_Access_Write,
+                .access_after = rhi::Barrier_Access::Shader_Read,
+            }
+        });
+        rhi::Barrier_Info barrier_info = {
+            .memory_barriers = memory_barrier_infos
+        };
+        cmd->barrier(barrier_info);
+    }
+
+    cmd->end_debug_region(); // skinning:skin_instances
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace rhi
+{
+class Command_List;
+}
+
+namespace ren
+{
+class Asset_Repository;
+class Static_Scene_Data;
+
+namespace techniques
+{
+class Skinning
+{
+public:
+    Skinning(Asset_Repository& asset_repository);
+    ~Skinning() = default;
+
+    Skinning(const Skinning&) = delete;
+    Skinning& operator=(const Skinning&) = delete;
+    Skinning(Skinning&&) = delete;
+    Skinning& operator=(Skinning&&) = delete;
+
+    // Writes the skinned positions of every animated instance.
+    // Must be recorded after the joint palette upload and before the acceleration structure builds.
+    void skin_instances(
+        rhi::Command_List* cmd,
+        const Static_Scene_Data& scene_data) const;
+
+private:
+    Asset_Repository& m_asset_repository;
+};
+}
+}
@@ -108,7 +108,7 @@ void Tone_Map::blit_apply(
 void Tone_Map::render_debug(rhi::Command_List* cmd,
     Resource_State_Tracker& tracker,
     const Image& render_target,
-    const Buffer& camera)
+    uint32_t camera)
 {
     if (!m_render_debug)
         return;
@@ -18,7 +18,7 @@ namespace techniques
 class Tone_Map
 {
 public:
-    constexpr static auto TONE_MAP_PARAMETERS_BUFFER_NAME = "tone_map:parameters_buffer";
+    constexpr static Name TONE_MAP_PARAMETERS_BUFFER_NAME = "tone_map:parameters_buffer";
 
     constexpr static auto SDR_DEFAULT_PAPER_WHITE = 250.0f; // in nits
     constexpr static auto IMAGE_REFERENCE_LUMINANCE = 100.0f; // value of 1.0 in nits
@@ -39,7 +39,7 @@ public:
         rhi::Command_List* cmd,
         Resource_State_Tracker& tracker,
         const Image& render_target,
-        const Buffer& camera);
+        uint32_t camera);
 
     void set_hdr_state(bool hdr, float display_peak_luminance_nits);
 
@@ -0,0 +1,84 @@
+#include "renderer/upload_copy.hpp"
+
+#include <TaskScheduler.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define REN_UPLOAD_COPY_SSE2 1
+#endif
+
+namespace ren
+{
+constexpr static std::size_t STREAM_ALIGNMENT = 16;
+// Copies below this size are not worth waking up the workers.
+constexpr static std::size_t MIN_PARALLEL_COPY_SIZE = 1ull << 22; // 4 MiB
+constexpr static std::size_t MIN_PARALLEL_COPY_CHUNK_SIZE = 1ull << 20; // 1 MiB
+
+void copy_to_upload_memory(void* dst, const void* src, std::size_t size) noexcept
+{
+#ifdef REN_UPLOAD_COPY_SSE2
+    auto* dst_bytes = static_cast<char*>(dst);
+    const auto* src_bytes = static_cast<const char*>(src);
+
+    // The unaligned head is stored normally, the rest is streamed in full cache lines where possible.
+    const auto head_size = std::min(size,
+        (STREAM_ALIGNMENT - reinterpret_cast<uintptr_t>(dst_bytes) % STREAM_ALIGNMENT) % STREAM_ALIGNMENT);
+    memcpy(dst_bytes, src_bytes, head_size);
+    dst_bytes += head_size;
+    src_bytes += head_size;
+    size -= head_size;
+
+    auto* dst_vectors = reinterpret_cast<__m128i*>(dst_bytes);
+    const auto* src_vectors = reinterpret_cast<const __m128i*>(src_bytes);
+    const auto vector_count = size / sizeof(__m128i);
+    std::size_t i = 0;
+    for (; i + 4 <= vector_count; i += 4)
+    {
+        const auto a = _mm_loadu_si128(src_vectors + i + 0);
+        const auto b = _mm_loadu_si128(src_vectors + i + 1);
+        const auto c = _mm_loadu_si128(src_vectors + i + 2);
+        const auto d = _mm_loadu_si128(src_vectors + i + 3);
+        _mm_stream_si128(dst_vectors + i + 0, a);
+        _mm_stream_si128(dst_vectors + i + 1, b);
+        _mm_stream_si128(dst_vectors + i + 2, c);
+        _mm_stream_si128(dst_vectors + i + 3, d);
+    }
+    for (; i < vector_count; ++i)
+    {
+        _mm_stream_si128(dst_vectors + i, _mm_loadu_si128(src_vectors + i));
+    }
+    const auto streamed_size = vector_count * sizeof(__m128i);
+    memcpy(dst_bytes + streamed_size, src_bytes + streamed_size, size - streamed_size);
+    // Streaming stores are weakly ordered, they must be visible before the copy is submitted.
+    _mm_sfence();
+#else
+    memcpy(dst, src, size);
+#endif
+}
+
+void copy_to_upload_memory(void* dst, const void* src, const std::size_t size, enki::TaskScheduler& task_scheduler)
+{
+    if (size < MIN_PARALLEL_COPY_SIZE)
+    {
+        copy_to_upload_memory(dst, src, size);
+        return;
+    }
+
+    const auto chunk_count = static_cast<uint32_t>((size + MIN_PARALLEL_COPY_CHUNK_SIZE - 1) / MIN_PARALLEL_COPY_CHUNK_SIZE);
+    enki::TaskSet task(chunk_count,
+        [dst, src, size](enki::TaskSetPartition range, uint32_t thread_idx)
+        {
+            const auto begin = range.start * MIN_PARALLEL_COPY_CHUNK_SIZE;
+            const auto end = std::min(std::size_t(range.end) * MIN_PARALLEL_COPY_CHUNK_SIZE, size);
+            copy_to_upload_memory(static_cast<char*>(dst) + begin, static_cast<const char*>(src) + begin, end - begin);
+        });
+    // The frame waits on the copy. It must neither queue behind background tasks nor run them while waiting.
+    task.m_Priority = enki::TASK_PRIORITY_HIGH;
+    task_scheduler.AddTaskSetToPipe(&task);
+    task_scheduler.WaitforTask(&task, enki::TASK_PRIORITY_HIGH);
+}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+namespace enki
+{
+class TaskScheduler;
+}
+
+namespace ren
+{
+// Copies into write-combined upload memory with non-temporal stores. The destination is never read
+// into the cache, and the source, usually a mapped asset file, isn't evicted by it.
+void copy_to_upload_memory(void* dst, const void* src, std::size_t size) noexcept;
+
+// Large copies are split across the workers of the task scheduler, one stream per core saturates
+// the memory bandwidth much better. Blocks until the copy is done.
+void copy_to_upload_memory(void* dst, const void* src, std::size_t size, enki::TaskScheduler& task_scheduler);
+}
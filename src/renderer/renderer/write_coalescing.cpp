@@ -0,0 +1,83 @@
+#include "renderer/write_coalescing.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
+
+namespace ren
+{
+void coalesce_buffer_writes(std::span<const Buffer_Write> writes, std::span<const std::byte> data,
+    std::vector<Buffer_Write>& runs, std::vector<std::byte>& run_data)
+{
+    runs.clear();
+    run_data.clear();
+
+    std::vector<uint32_t> order(writes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, [writes](const uint32_t a, const uint32_t b)
+    {
+        const auto& write_a = writes[a];
+        const auto& write_b = writes[b];
+        if (write_a.dst != write_b.dst)
+        {
+            return std::less()(write_a.dst, write_b.dst);
+        }
+        return write_a.dst_offset < write_b.dst_offset;
+    });
+
+    std::vector<uint32_t> write_run_indices(writes.size());
+    std::size_t run_data_size = 0;
+    for (const auto i : order)
+    {
+        const auto& write = writes[i];
+        auto* run = runs.empty() ? nullptr : &runs.back();
+        if (run && run->dst == write.dst && write.dst_offset <= run->dst_offset + run->size)
+        {
+            const auto run_end = std::max(run->dst_offset + run->size, write.dst_offset + write.size);
+            run_data_size += run_end - (run->dst_offset + run->size);
+            run->size = run_end - run->dst_offset;
+        }
+        else
+        {
+            runs.push_back({
+                .dst = write.dst,
+                .dst_offset = write.dst_offset,
+                .size = write.size,
+                .data_offset = run_data_size });
+            run_data_size += write.size;
+        }
+        write_run_indices[i] = static_cast<uint32_t>(runs.size() - 1);
+    }
+
+    // The writes are applied in their original order, so the last of overlapping writes wins.
+    run_data.resize(run_data_size);
+    for (auto i = 0ull; i < writes.size(); ++i)
+    {
+        const auto& write = writes[i];
+        const auto& run = runs[write_run_indices[i]];
+        memcpy(&run_data[run.data_offset + write.dst_offset - run.dst_offset], &data[write.data_offset], write.size);
+    }
+}
+
+bool is_scattered_write_run(const Buffer_Write& run, const bool can_scatter) noexcept
+{
+    return can_scatter
+        && run.size < MIN_COPY_SIZE
+        && run.dst_offset % sizeof(uint32_t) == 0
+        && run.size % sizeof(uint32_t) == 0;
+}
+
+std::byte* encode_scatter_writes(const Buffer_Write& run, std::span<const std::byte> run_data,
+    std::byte* scatter_writes) noexcept
+{
+    for (auto word = 0ull; word < run.size / sizeof(uint32_t); ++word)
+    {
+        const auto dst_word = static_cast<uint32_t>(run.dst_offset / sizeof(uint32_t) + word);
+        memcpy(scatter_writes, &dst_word, sizeof(uint32_t));
+        memcpy(scatter_writes + sizeof(uint32_t), &run_data[run.data_offset + word * sizeof(uint32_t)], sizeof(uint32_t));
+        scatter_writes += SCATTER_WRITE_SIZE;
+    }
+    return scatter_writes;
+}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rhi
+{
+struct Buffer;
+}
+
+namespace ren
+{
+// Merged writes smaller than this are scattered, a copy command costs more than writing them from a shader.
+constexpr static std::size_t MIN_COPY_SIZE = 256;
+// The index of the destination word followed by the word.
+constexpr static std::size_t SCATTER_WRITE_SIZE = 2 * sizeof(uint32_t);
+
+struct Buffer_Write
+{
+    rhi::Buffer* dst;
+    std::size_t dst_offset;
+    std::size_t size;
+    std::size_t data_offset; // Into the data the write was passed with
+};
+
+// Sorts the writes by destination and merges adjacent and overlapping writes to the same buffer into runs.
+// Overlapping bytes hold the data of the write that comes last in `writes`. The data of the runs is
+// packed into `run_data`, both outputs are cleared first.
+void coalesce_buffer_writes(std::span<const Buffer_Write> writes, std::span<const std::byte> data,
+    std::vector<Buffer_Write>& runs, std::vector<std::byte>& run_data);
+
+// Runs that are too small to be worth a copy are scattered, if they consist of whole words.
+[[nodiscard]] bool is_scattered_write_run(const Buffer_Write& run, bool can_scatter) noexcept;
+
+// Writes one scatter write per word of the run. Returns the end of the written scatter writes.
+std::byte* encode_scatter_writes(const Buffer_Write& run, std::span<const std::byte> run_data,
+    std::byte* scatter_writes) noexcept;
+}
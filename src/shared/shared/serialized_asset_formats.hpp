@@ -31,6 +31,10 @@ constexpr static auto TEXTURE_MAX_MIP_LEVELS = 14;
 
 constexpr static auto MODEL_FILE_EXTENSION = ".renmdl"; // renderer model container
 constexpr static auto TEXTURE_FILE_EXTENSION = ".rentex"; // renderer texture container
+constexpr static auto ANIMATION_FILE_EXTENSION = ".renanm"; // renderer animation container
+
+constexpr static auto ANIMATION_SAMPLE_RATE = 30.f; // Samples per second of baked animation clips
+constexpr static uint32_t JOINT_PARENT_INDEX_NO_PARENT = ~0u;
 
 struct Image_Mip_Data
 {
@@ -321,6 +325,157 @@ struct Model_Header_00
         return size;
     }
 };
+
+struct Skeleton_00
+{
+    char name[NAME_FIELD_SIZE];
+    uint32_t joint_range_start;
+    uint32_t joint_range_end;
+    uint32_t skin_binding_range_start;  // Mesh instances of the model deformed by this skeleton
+    uint32_t skin_binding_range_end;
+    float root_transform[16];           // Column major, transform of the joint hierarchy root
+};
+
+struct Joint_00
+{
+    uint32_t parent_index;              // Relative to the skeleton joint range
+    float inverse_bind_matrix[16];      // Column major
+    float rest_translation[3];
+    float rest_rotation[4];             // w, x, y, z
+    float rest_scale[3];
+};
+
+struct Skin_Binding_00
+{
+    uint32_t instance_index;            // Indexes Mesh_Instance_00 of the model with the same name
+};
+
+struct Animation_Clip_00
+{
+    char name[NAME_FIELD_SIZE];
+    uint32_t skeleton_index;
+    float sample_rate;
+    float duration;
+    uint32_t sample_count;
+    uint32_t track_range_start;         // One track per joint of the skeleton
+    uint32_t track_range_end;
+};
+
+// Translation and scale keys are quantized to 16 bit relative to the range of the track.
+struct Joint_Track_00
+{
+    float translation_min[3];
+    float translation_extent[3];
+    float scale_min[3];
+    float scale_extent[3];
+    uint32_t key_range_start;           // `sample_count` keys of the owning clip
+};
+
+struct Joint_Key_00
+{
+    uint16_t translation[3];            // unorm16 in track range
+    int16_t rotation[4];                // snorm16, x, y, z, w
+    uint16_t scale[3];                  // unorm16 in track range
+};
+
+struct Animation_Header
+{
+    constexpr static uint32_t MAGIC = 0x4D4E4152u; // RANM
+
+    // can't directly set value, otherwise no longer trivial type
+    uint32_t magic;
+    uint32_t version;
+
+    bool validate()
+    {
+        return magic == MAGIC && version == 1;
+    }
+};
+
+struct Animation_Header_00
+{
+    Animation_Header header;
+    char name[NAME_FIELD_SIZE];
+    uint32_t skeleton_count;            // Skeleton_00
+    uint32_t joint_count;               // Joint_00
+    uint32_t skin_binding_count;        // Skin_Binding_00
+    uint32_t clip_count;                // Animation_Clip_00
+    uint32_t track_count;               // Joint_Track_00
+    uint32_t key_count;                 // Joint_Key_00
+
+    // Data is ordered in the way it was declared.
+
+    static std::size_t get_skeletons_offset()
+    {
+        return sizeof(Animation_Header_00);
+    }
+
+    Skeleton_00* get_skeletons()
+    {
+        return reinterpret_cast<Skeleton_00*>(reinterpret_cast<char*>(this) + get_skeletons_offset());
+    }
+
+    std::size_t get_joints_offset() const
+    {
+        return get_skeletons_offset()
+            + skeleton_count * sizeof(Skeleton_00);
+    }
+
+    Joint_00* get_joints()
+    {
+        return reinterpret_cast<Joint_00*>(reinterpret_cast<char*>(this) + get_joints_offset());
+    }
+
+    std::size_t get_skin_bindings_offset() const
+    {
+        return get_joints_offset()
+            + joint_count * sizeof(Joint_00);
+    }
+
+    Skin_Binding_00* get_skin_bindings()
+    {
+        return reinterpret_cast<Skin_Binding_00*>(reinterpret_cast<char*>(this) + get_skin_bindings_offset());
+    }
+
+    std::size_t get_clips_offset() const
+    {
+        return get_skin_bindings_offset()
+            + skin_binding_count * sizeof(Skin_Binding_00);
+    }
+
+    Animation_Clip_00* get_clips()
+    {
+        return reinterpret_cast<Animation_Clip_00*>(reinterpret_cast<char*>(this) + get_clips_offset());
+    }
+
+    std::size_t get_tracks_offset() const
+    {
+        return get_clips_offset()
+            + clip_count * sizeof(Animation_Clip_00);
+    }
+
+    Joint_Track_00* get_tracks()
+    {
+        return reinterpret_cast<Joint_Track_00*>(reinterpret_cast<char*>(this) + get_tracks_offset());
+    }
+
+    std::size_t get_keys_offset() const
+    {
+        return get_tracks_offset()
+            + track_count * sizeof(Joint_Track_00);
+    }
+
+    Joint_Key_00* get_keys()
+    {
+        return reinterpret_cast<Joint_Key_00*>(reinterpret_cast<char*>(this) + get_keys_offset());
+    }
+
+    std::size_t get_size() const
+    {
+        return get_keys_offset()
+            + key_count * sizeof(Joint_Key_00);
+    }
+};
 }
 
 #endif
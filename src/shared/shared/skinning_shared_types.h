@@ -0,0 +1,23 @@
+#ifndef SKINNING_SHARED_TYPES
+#define SKINNING_SHARED_TYPES
+#include "shared/shared_types.h"
+
+struct GPU_Vertex_Skin_Attributes
+{
+    uint4 joints;
+    float4 weights;
+};
+
+struct Skinning_Push_Constants
+{
+    SHADER_HANDLE_TYPE src_position_buffer;
+    SHADER_HANDLE_TYPE skin_attribute_buffer;
+    SHADER_HANDLE_TYPE joint_palette_buffer;
+    SHADER_HANDLE_TYPE dst_position_buffer;
+    uint first_vertex;
+    uint first_skin_attribute;
+    uint vertex_count;
+    uint palette_offset;
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef UPLOAD_SHARED_TYPES
+#define UPLOAD_SHARED_TYPES
+#include "shared/shared_types.h"
+
+// Each write is a pair of the destination word index and the word.
+struct Upload_Scatter_Push_Constants
+{
+    SHADER_HANDLE_TYPE src_buffer;
+    SHADER_HANDLE_TYPE dst_buffer;
+    uint first_write;
+    uint write_count;
+};
+
+#endif